@@ -5,18 +5,20 @@
 // HarmonyEngine defines a chord progression as Chord objects (root pitch
 // class + ChordType). A small helper expands each ChordType into its interval
 // pattern to derive four chord-tone MIDI notes. Core 1 steps the progression
-// and triggers four rpdsp::TriggeredSynthVoice instances; Core 0 mixes all
-// four voices into the stereo I2S buffer. Slow ADSR gives a sustained
-// string-pad feel.
+// and queues note events for four rpdsp::TriggeredSynthVoice instances; Core 0
+// applies them at their sample offsets and mixes all four voices into the
+// stereo I2S buffer. Slow ADSR gives a sustained string-pad feel.
 //
 // The integration seam is:
 //     HarmonyEngine::Chord (ChordType)  ->  interval pattern -> MIDI notes
+//         -> rpdsp::EventQueue (Core 1 -> Core 0, sample-stamped)
 //         -> rpdsp::TriggeredSynthVoice::noteOn(midi)
 //             -> voice::process()  (subtracted saw + ADSR + filter)
 //
 // Dual-core contract (see Docs/realtime_rules.md):
 //   Core 0 = real-time audio fill (never blocks, no allocation).
 //   Core 1 = HarmonyEngine sequencing (blocking delay() is fine here).
+//   Only Core 0 touches the voices; Core 1 reaches them through g_events.
 //
 
 // Library discovery triggers — arduino-cli detects libraries via root-level
@@ -27,6 +29,8 @@
 
 #include <pico_audio_i2s/audio.h>
 #include <pico_audio_i2s/audio_i2s.h>
+#include <rpdsp/dynamics.h>
+#include <rpdsp/event_queue.h>
 #include <rpdsp/voice.h>
 #include <HarmonyEngine/MusicTheory.h>
 
@@ -44,6 +48,7 @@ static const int      NUM_AUDIO_BUFFERS  = 3;
 static const int      SAMPLES_PER_BUFFER = 256;
 
 static audio_buffer_pool_t *producer_pool = nullptr;
+AUDIO_BUFFER_POOL_STORAGE(producer_storage, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER, 8);
 
 // ---------------------------------------------------------------------------
 // DSP objects — four subtractive synth voices (SATB-ish ensemble)
@@ -52,6 +57,19 @@ using Voice = rpdsp::TriggeredSynthVoice<3>;  // 3 saw oscillators each
 static const int NUM_VOICES = 4;
 static Voice g_voices[NUM_VOICES];
 
+// Master limiter: 1 ms lookahead brickwall at -0.3 dBFS, fused with the
+// 24-in-32 packing so the output stage is a single pass over the buffer.
+static rpdsp::LookaheadLimiter<> g_limiter;
+static float g_mix[SAMPLES_PER_BUFFER];
+
+// Core 1 -> Core 0 note events; the channel field carries the voice index.
+// One chord change is at most eight events, so sixteen slots never fill.
+static rpdsp::EventQueue<16> g_events;
+
+// Events are stamped one buffer ahead of the audio clock, so they are never
+// late and all four notes of a chord start on the same sample.
+static const uint32_t EVENT_LATENCY_FRAMES = SAMPLES_PER_BUFFER;
+
 // ---------------------------------------------------------------------------
 // HarmonyEngine — chord progression
 // ---------------------------------------------------------------------------
@@ -101,6 +119,8 @@ static int chordIntervals(HarmonyEngine::ChordType type, int out[MAX_CHORD_TONES
 // ---------------------------------------------------------------------------
 static void triggerChord(const HarmonyEngine::Chord& chord)
 {
+    const uint32_t when = g_events.now() + EVENT_LATENCY_FRAMES;
+
     int intervals[MAX_CHORD_TONES];
     int toneCount = chordIntervals(chord.type, intervals);
     if (toneCount > NUM_VOICES) toneCount = NUM_VOICES;
@@ -117,7 +137,47 @@ static void triggerChord(const HarmonyEngine::Chord& chord)
         if (midi < 24)  midi = 24;
         if (midi > 96)  midi = 96;
 
-        g_voices[v].noteOn(midi, 0.8f, 0);
+        g_events.push(rpdsp::Event::noteOn(when, midi, 0.8f, v));
+    }
+}
+
+// Release every voice (Core 1).
+static void releaseChord()
+{
+    const uint32_t when = g_events.now() + EVENT_LATENCY_FRAMES;
+    for (int v = 0; v < NUM_VOICES; ++v)
+    {
+        g_events.push(rpdsp::Event::noteOff(when, -1, v));
+    }
+}
+
+// Apply one queued event to its voice (Core 0, between render spans).
+static void applyEvent(const rpdsp::Event& event)
+{
+    Voice& voice = g_voices[event.channel % NUM_VOICES];
+    if (event.type == rpdsp::Event::Type::kNoteOn)
+    {
+        voice.noteOn(event.note(), event.value, 0);
+    }
+    else if (event.type == rpdsp::Event::Type::kNoteOff)
+    {
+        voice.noteOff();
+    }
+}
+
+// Mix all four voices into g_mix[offset, offset + count).
+static void renderVoices(size_t offset, size_t count)
+{
+    for (size_t i = offset; i < offset + count; ++i)
+    {
+        // Sum the four voices. process() returns 0 when a voice is idle, so
+        // releasing voices naturally drop out of the mix.
+        float mixed = 0.0f;
+        for (int v = 0; v < NUM_VOICES; ++v)
+        {
+            mixed += g_voices[v].process();
+        }
+        g_mix[i] = mixed;
     }
 }
 
@@ -134,13 +194,14 @@ static void initVoices()
     preset.ampEnvelope.attackSeconds  = 0.45f;
     preset.ampEnvelope.releaseSeconds = 0.60f;
     preset.ampEnvelope.sustain        = 0.7f;
-    preset.gain = 0.18f;  // leave headroom when 4 voices sum
+    preset.gain = 0.28f;  // the master limiter catches the peaks when 4 voices sum
 
     for (int v = 0; v < NUM_VOICES; ++v)
     {
         g_voices[v].prepare(SAMPLE_RATE);
         g_voices[v].applyPreset(preset);
     }
+    g_limiter.prepare(SAMPLE_RATE);
 }
 
 // ---------------------------------------------------------------------------
@@ -151,20 +212,11 @@ static void fill_audio_buffer(audio_buffer_t *buffer)
     const int    N   = static_cast<int>(buffer->max_sample_count);
     int32_t     *out = reinterpret_cast<int32_t *>(buffer->buffer->bytes);
 
-    for (int i = 0; i < N; ++i)
-    {
-        // Sum the four voices. process() returns 0 when a voice is idle, so
-        // releasing voices naturally drop out of the mix.
-        float mixed = 0.0f;
-        for (int v = 0; v < NUM_VOICES; ++v)
-        {
-            mixed += g_voices[v].process();
-        }
+    // Drain Core 1's events, splitting the mix at each one's sample offset.
+    g_events.process(static_cast<size_t>(N), applyEvent, renderVoices);
 
-        int32_t s = rpdsp::toInt24x32(mixed);
-        out[2 * i + 0] = s; // Left
-        out[2 * i + 1] = s; // Right
-    }
+    // Mono mix to both channels: limit and pack in one pass.
+    g_limiter.processToInt24x32(g_mix, g_mix, out, static_cast<size_t>(N));
 
     buffer->sample_count = N;
 }
@@ -207,7 +259,7 @@ void setup()
         .sample_stride = 8           // 2 channels x 4 bytes/sample (24-in-32)
     };
 
-    producer_pool = audio_new_producer_pool(&bufFmt, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER);
+    producer_pool = audio_init_producer_pool(&producer_storage, &bufFmt, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER);
 
     audio_i2s_config_t i2sCfg = {
         .data_pin       = PICO_AUDIO_I2S_DATA_PIN,
@@ -249,10 +301,7 @@ void loop1()
     for (int i = 0; i < PROGRESSION_LENGTH; ++i)
     {
         // Release any sustaining voices first so the chord change breathes.
-        for (int v = 0; v < NUM_VOICES; ++v)
-        {
-            g_voices[v].noteOff();
-        }
+        releaseChord();
 
         // Small gap lets the release tail fade before the next attack.
         delay(120);
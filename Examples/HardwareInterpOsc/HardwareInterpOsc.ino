@@ -30,6 +30,7 @@
 #include <pico_audio_i2s/audio_i2s.h>
 #include <rpdsp/oscillator.h>      
 #include <rpdsp/hardware_interpolator.h>
+#include <rpdsp/realtime.h>
 
 // ---------------------------------------------------------------------------
 // Pin + engine constants
@@ -58,10 +59,13 @@ static const std::int16_t kTriangleTable[kTableSize] = {
 };
 
 // ---------------------------------------------------------------------------
-// Cross-core state (Core 0 writes, Core 1 reads; plain volatile)
+// Cross-core state (Core 0 publishes once per block, Core 1 reads)
 // ---------------------------------------------------------------------------
-volatile float g_freqHz1 = 330.0f;
-volatile float g_freqHz2 = 220.0f;
+struct OscMonitor {
+    float freqHz1 = 330.0f;
+    float freqHz2 = 220.0f;
+};
+static rpdsp::ParameterSnapshot<OscMonitor> g_monitor;
 
 // ---------------------------------------------------------------------------
 // DSP objects (owned by Core 0; used only inside the fill callback)
@@ -72,6 +76,7 @@ static rpdsp::SineOscillator lfo;        // Bipolar LFO, ~6 s cycle
 static rpdsp::SineOscillator lfo2;       // Unipolar LFO, ~19 s cycle
 
 static audio_buffer_pool_t *producer_pool = nullptr;
+AUDIO_BUFFER_POOL_STORAGE(producer_storage, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER, 8);
 
 // ---------------------------------------------------------------------------
 // Initialise DSP objects (called once from Core 0 setup)
@@ -107,6 +112,7 @@ static void fill_audio_buffer(audio_buffer_t *buffer)
 {
     const int    N   = static_cast<int>(buffer->max_sample_count);
     int32_t     *dst = reinterpret_cast<int32_t *>(buffer->buffer->bytes);
+    OscMonitor   monitor;
 
     for (int i = 0; i < N; ++i)
     {
@@ -120,8 +126,8 @@ static void fill_audio_buffer(audio_buffer_t *buffer)
         // Osc 2 base ~220 Hz with stronger LFO2 sway (±440 Hz) and tighter LFO1 coupling
         const float freqHz2 = 220.0f + lfo2Val * 440.0f + lfoVal * 110.0f;
 
-        g_freqHz1 = freqHz1;
-        g_freqHz2 = freqHz2;
+        monitor.freqHz1 = freqHz1;
+        monitor.freqHz2 = freqHz2;
 
         // Recompute tuning words every sample for continuous LFO-driven pitch modulation
         std::uint32_t tuningWord = 0;
@@ -158,6 +164,9 @@ static void fill_audio_buffer(audio_buffer_t *buffer)
         dst[2 * i + 1] = rpdsp::toInt24x32(finalRight);  // right
     }
 
+    // Both frequencies from the same sample, published once per block.
+    g_monitor.publish(monitor);
+
     buffer->sample_count = N;
 }
 
@@ -199,7 +208,7 @@ void setup()
         .sample_stride = 8            // 2 channels x 4 bytes/sample (24-in-32)
     };
 
-    producer_pool = audio_new_producer_pool(&bufFmt, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER);
+    producer_pool = audio_init_producer_pool(&producer_storage, &bufFmt, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER);
 
     audio_i2s_config_t i2sCfg = {
         .data_pin       = PICO_AUDIO_I2S_DATA_PIN,
@@ -241,10 +250,12 @@ void loop1()
     if (now - last_print_ms >= 1000)
     {
         last_print_ms = now;
+        g_monitor.update();
+        const OscMonitor monitor = g_monitor.current();
         Serial.print("[CORE1] Osc1: ");
-        Serial.print(g_freqHz1, 1);
+        Serial.print(monitor.freqHz1, 1);
         Serial.print(" Hz, Osc2: ");
-        Serial.print(g_freqHz2, 1);
+        Serial.print(monitor.freqHz2, 1);
         Serial.println(" Hz");
     }
 }
@@ -55,6 +55,7 @@ static const std::int16_t kSineTable[kTableSize] = {
 // ---------------------------------------------------------------------------
 static rpdsp::HardwareOscillator osc;
 static audio_buffer_pool_t *producer_pool = nullptr;
+AUDIO_BUFFER_POOL_STORAGE(producer_storage, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER, 8);
 
 // ---------------------------------------------------------------------------
 // Initialise DSP objects (called once from Core 0 setup)
@@ -140,7 +141,7 @@ void setup()
         .sample_stride = 8            // 2 channels x 4 bytes/sample (24-in-32)
     };
 
-    producer_pool = audio_new_producer_pool(&bufFmt, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER);
+    producer_pool = audio_init_producer_pool(&producer_storage, &bufFmt, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER);
 
     audio_i2s_config_t i2sCfg = {
         .data_pin       = PICO_AUDIO_I2S_DATA_PIN,
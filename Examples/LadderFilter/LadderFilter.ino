@@ -4,7 +4,8 @@
 //
 // Three detuned band-limited sawtooth oscillators feed a 4-pole Huovilainen
 // ladder filter (LP24). A short ADSR shapes each note, and a 16th-note
-// sequencer (A-minor blues) drives pitch from Core 1. The filter cutoff sweeps
+// sequencer (A-minor blues) on Core 1 queues sample-stamped note events that
+// Core 0 applies at their exact offset within the block. The filter cutoff sweeps
 // 65 Hz -> 1000 Hz across each bar; after each completed sweep the resonance
 // advances to the next value in a small cycling list. A momentary button A/Bs
 // the envelope so the filtering is audible both with and without amplitude
@@ -37,7 +38,9 @@
 #include <rpdsp/oscillator.h>          // SecondOrderBSplineSawOscillator (anti-aliased)
 #include <rpdsp/ladder.h>              // LadderFilter
 #include <rpdsp/envelope.h>            // ADSR
+#include <rpdsp/event_queue.h>         // EventQueue (Core 1 -> Core 0 notes)
 #include <rpdsp/parameter_smoother.h>  // LinearSmoother (rpdsp's canonical smoother)
+#include <rpdsp/realtime.h>            // ParameterSnapshot (Core 1 -> Core 0 controls)
 
 // ---------------------------------------------------------------------------
 // Pin + engine constants
@@ -64,9 +67,15 @@ static const int PATTERN[PATTERN_LEN] = {
 };
 static const unsigned long BPM     = 95;
 static const unsigned long STEP_US = (60000000UL / BPM) / 4UL;   // 16th step (~157.9 ms)
-static const unsigned long GATE_US = (STEP_US * 80UL) / 100UL;   // 80% gate, remainder = release
 static const unsigned long BAR_US  = STEP_US * PATTERN_LEN;       // one full sequence
 
+// Notes are timed on the audio clock: one 16th is 7579 frames at 48 kHz,
+// gated at 80%. Steps are queued two buffers ahead of the audio core so they
+// are never late.
+static const uint32_t STEP_FRAMES     = static_cast<uint32_t>(SAMPLE_RATE * 15.0f / BPM + 0.5f);
+static const uint32_t GATE_FRAMES     = (STEP_FRAMES * 80u) / 100u;
+static const uint32_t LOOKAHEAD_FRAMES = 2u * SAMPLES_PER_BUFFER;
+
 // Cutoff sweeps once per bar; resonance advances to the next entry each bar.
 static const float CUTOFF_LOW  = 65.0f;
 static const float CUTOFF_HIGH = 1000.0f;
@@ -82,14 +91,18 @@ static const float OUT_MAKEUP    = 2.0f;
 static const float OUT_HEADROOM  = 0.75f;
 
 // ---------------------------------------------------------------------------
-// Cross-core state (Core 1 writes, Core 0 reads; plain volatile, no locks)
+// Cross-core state (Core 1 writes, Core 0 reads)
 // ---------------------------------------------------------------------------
-volatile int   g_note           = -1;          // current MIDI note (-1 = rest)
-volatile bool  g_noteOnPending  = false;       // edge: trigger noteOn in audio core
-volatile bool  g_noteOffPending = false;       // edge: trigger noteOff in audio core
-volatile float g_cutoffTarget   = CUTOFF_LOW;  // per-bar sweep target (Hz)
-volatile float g_resTarget      = RES_VALUES[0];
-volatile bool  g_envEnabled     = true;        // button toggles; false = bypass ADSR
+static rpdsp::EventQueue<16> g_events;         // note on/off, stamped in frames
+
+// Control targets travel as one struct, so the audio core never sees a cutoff
+// from one pass of loop1() with the resonance from another.
+struct LadderControls {
+    float cutoffHz   = CUTOFF_LOW;      // per-bar sweep target (Hz)
+    float resonance  = RES_VALUES[0];
+    bool  envEnabled = true;            // button toggles; false = bypass ADSR
+};
+static rpdsp::ParameterSnapshot<LadderControls> g_controls;
 
 // ---------------------------------------------------------------------------
 // DSP objects (owned by Core 0; used only inside the fill callback)
@@ -101,6 +114,7 @@ static rpdsp::LinearSmoother cutoffSmoother;   // click-free cutoff ramp
 static rpdsp::LinearSmoother resSmoother;      // click-free resonance ramp
 
 static audio_buffer_pool_t *producer_pool = nullptr;
+AUDIO_BUFFER_POOL_STORAGE(producer_storage, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER, 8);
 
 // ---------------------------------------------------------------------------
 // Helpers
@@ -109,7 +123,7 @@ static inline float centsToRatio(float cents) {
     return powf(2.0f, cents / 1200.0f);
 }
 
-// Point all three detuned oscillators at a MIDI note (called on noteOn edges).
+// Point all three detuned oscillators at a MIDI note (called on note-on events).
 static void setNote(int midiNote) {
     const float base = rpdsp::midiNoteToHz(static_cast<float>(midiNote));
     for (int i = 0; i < 3; ++i) {
@@ -126,50 +140,47 @@ static void fill_audio_buffer(audio_buffer_t *buffer)
     const int    N   = static_cast<int>(buffer->max_sample_count);
     int32_t     *dst = reinterpret_cast<int32_t *>(buffer->buffer->bytes);
 
-    // Consume cross-core note edges once per block. Steps are ~158 ms and blocks
-    // are ~5 ms, so per-block consumption sits well inside the gate timing.
-    // SPSC ordering: Core 1 writes g_note before setting its flag; read note first.
-    if (g_noteOnPending) {
-        const int n = g_note;
-        if (n >= 0) {
-            setNote(n);
+    // Take the newest control targets once per block; the smoothers ramp per sample.
+    g_controls.update();
+    const LadderControls controls = g_controls.current();
+    cutoffSmoother.setTarget(controls.cutoffHz);
+    resSmoother.setTarget(controls.resonance);
+    const bool envEnabled = controls.envEnabled;
+
+    // Note events land on their exact frame: the block is rendered in spans
+    // between them. Steps are ~30 blocks apart, so a split is rare and cheap.
+    const auto applyEvent = [](const rpdsp::Event& event) {
+        if (event.type == rpdsp::Event::Type::kNoteOn) {
+            setNote(event.note());
             adsr.noteOn();
-        } else {
-            adsr.noteOff();   // defensive: a rest arrived as a note-on edge
+        } else if (event.type == rpdsp::Event::Type::kNoteOff) {
+            adsr.noteOff();
         }
-        g_noteOnPending = false;
-    }
-    if (g_noteOffPending) {
-        adsr.noteOff();
-        g_noteOffPending = false;
-    }
-
-    // Publish new control targets once per block; the smoothers ramp per sample.
-    cutoffSmoother.setTarget(g_cutoffTarget);
-    resSmoother.setTarget(g_resTarget);
-    const bool envEnabled = g_envEnabled;   // snapshot once per block
-
-    for (int i = 0; i < N; ++i)
-    {
-        // 1) Three detuned band-limited saws, gain-staged by /3.
-        const float s = (osc[0].process() + osc[1].process() + osc[2].process())
-                        * (1.0f / 3.0f);
-
-        // 2) Smoothed cutoff + resonance into the ladder (LP24, default mode).
-        ladder.setFreq(cutoffSmoother.next());
-        ladder.setRes(resSmoother.next());
-        const float filt = ladder.process(s);
-
-        // 3) ADSR amplitude. When bypassed, notes play at full level (A/B).
-        const float amp = envEnabled ? adsr.process() : 1.0f;
-
-        // 4) Makeup + soft-clip so resonant peaks never clip the DAC.
-        const float outf = rpdsp::softClip(filt * amp * OUT_MAKEUP) * OUT_HEADROOM;
-
-        const int32_t sample = rpdsp::toInt24x32(outf);
-        dst[2 * i + 0] = sample;   // left
-        dst[2 * i + 1] = sample;   // right (mono -> stereo)
-    }
+    };
+    const auto renderSpan = [&](size_t offset, size_t count) {
+        for (size_t i = offset; i < offset + count; ++i)
+        {
+            // 1) Three detuned band-limited saws, gain-staged by /3.
+            const float s = (osc[0].process() + osc[1].process() + osc[2].process())
+                            * (1.0f / 3.0f);
+
+            // 2) Smoothed cutoff + resonance into the ladder (LP24, default mode).
+            ladder.setFreq(cutoffSmoother.next());
+            ladder.setRes(resSmoother.next());
+            const float filt = ladder.process(s);
+
+            // 3) ADSR amplitude. When bypassed, notes play at full level (A/B).
+            const float amp = envEnabled ? adsr.process() : 1.0f;
+
+            // 4) Makeup + soft-clip so resonant peaks never clip the DAC.
+            const float outf = rpdsp::softClip(filt * amp * OUT_MAKEUP) * OUT_HEADROOM;
+
+            const int32_t sample = rpdsp::toInt24x32(outf);
+            dst[2 * i + 0] = sample;   // left
+            dst[2 * i + 1] = sample;   // right (mono -> stereo)
+        }
+    };
+    g_events.process(static_cast<size_t>(N), applyEvent, renderSpan);
 
     buffer->sample_count = N;
 }
@@ -219,7 +230,7 @@ void setup()
         .sample_stride = 8            // 2 channels x 4 bytes/sample (24-in-32)
     };
 
-    producer_pool = audio_new_producer_pool(&bufFmt, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER);
+    producer_pool = audio_init_producer_pool(&producer_storage, &bufFmt, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER);
 
     audio_i2s_config_t i2sCfg = {
         .data_pin       = PICO_AUDIO_I2S_DATA_PIN,
@@ -263,12 +274,11 @@ void setup1()
 void loop1()
 {
     static bool          started          = false;
-    static unsigned long nextStepUs       = 0;
-    static unsigned long nextNoteOffUs    = 0;
+    static uint32_t      nextStepFrame    = 0;
     static unsigned long barStartUs       = 0;
     static int           stepIndex        = 0;
     static int           resIndex         = 0;
-    static bool          noteOffScheduled = false;
+    static LadderControls controls;     // Core 1's copy; published whole each pass
 
     // button debounce state
     static int           lastButtonState  = HIGH;
@@ -276,55 +286,48 @@ void loop1()
     static unsigned long lastDebounceMs   = 0;
 
     const unsigned long now = micros();
+    const uint32_t horizon = g_events.now() + LOOKAHEAD_FRAMES;
 
     if (!started) {
-        started     = true;
-        nextStepUs  = now;          // fire step 0 immediately
-        barStartUs  = now;
-        g_resTarget = RES_VALUES[0];
+        started       = true;
+        nextStepFrame = horizon;    // fire step 0 as soon as possible
+        barStartUs    = now;
     }
 
-    // ---- Step boundary: publish note-on (or rest) -------------------------
-    if (now >= nextStepUs) {
-        nextStepUs += STEP_US;
+    // ---- Step boundary: queue note-on + gated note-off (or rest) ----------
+    // Wrap-safe: the step is due once it falls inside the lookahead window.
+    if (static_cast<int32_t>(horizon - nextStepFrame) >= 0) {
+        const uint32_t stepFrame = nextStepFrame;
+        nextStepFrame += STEP_FRAMES;
         const int note = PATTERN[stepIndex];
         if (note >= 0) {
-            g_note           = note;    // write note first...
-            g_noteOnPending  = true;    // ...then the flag (SPSC handoff)
-            nextNoteOffUs    = now + GATE_US;   // release at ~80% of the step
-            noteOffScheduled = true;
+            g_events.push(rpdsp::Event::noteOn(stepFrame, note, 1.0f));
+            g_events.push(rpdsp::Event::noteOff(stepFrame + GATE_FRAMES, note));
             if (Serial) {
                 Serial.print("[CORE1] noteOn  MIDI ");
                 Serial.println(note);
             }
         } else {
-            g_noteOffPending = true;    // rest: release any ringing note
-            noteOffScheduled = false;
+            g_events.push(rpdsp::Event::noteOff(stepFrame));   // rest: release any ringing note
         }
 
         stepIndex = (stepIndex + 1) % PATTERN_LEN;
         if (stepIndex == 0) {           // full sequence complete -> new sweep + next res
             barStartUs  = now;
             resIndex    = (resIndex + 1) % RES_COUNT;
-            g_resTarget = RES_VALUES[resIndex];
+            controls.resonance = RES_VALUES[resIndex];
             if (Serial) {
                 Serial.print("[CORE1] bar complete -> resonance ");
-                Serial.println(g_resTarget, 2);
+                Serial.println(controls.resonance, 2);
             }
         }
     }
 
-    // ---- Note-off at ~80% of the gate -------------------------------------
-    if (noteOffScheduled && now >= nextNoteOffUs) {
-        g_noteOffPending = true;
-        noteOffScheduled = false;
-    }
-
     // ---- Cutoff sweep: 65 -> 1000 Hz over one bar (one full sequence) -----
     const unsigned long elapsed = now - barStartUs;
     float progress = static_cast<float>(elapsed) / static_cast<float>(BAR_US);
     if (progress > 1.0f) progress = 1.0f;
-    g_cutoffTarget = CUTOFF_LOW + (CUTOFF_HIGH - CUTOFF_LOW) * progress;
+    controls.cutoffHz = CUTOFF_LOW + (CUTOFF_HIGH - CUTOFF_LOW) * progress;
 
     // ---- Button debounce: toggle envelope A/B -----------------------------
     const int reading = digitalRead(BUTTON_PIN);
@@ -335,13 +338,16 @@ void loop1()
         if (reading != buttonState) {
             buttonState = reading;
             if (buttonState == LOW) {     // pressed (active-low)
-                g_envEnabled = !g_envEnabled;
+                controls.envEnabled = !controls.envEnabled;
                 if (Serial) {
                     Serial.print("[CORE1] envelope ");
-                    Serial.println(g_envEnabled ? "ENABLED" : "BYPASSED");
+                    Serial.println(controls.envEnabled ? "ENABLED" : "BYPASSED");
                 }
             }
         }
     }
     lastButtonState = reading;
+
+    // One copy and one atomic exchange; Core 0 picks up the latest at its next block.
+    g_controls.publish(controls);
 }
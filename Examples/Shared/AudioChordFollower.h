@@ -0,0 +1,114 @@
+#pragma once
+
+// Live audio -> HarmonyEngine::Chord. The audio core decimates its input and pushes it into
+// an STFT ring; the control core turns finished frames into a chromagram, matches chord
+// templates on fixed arrays, and only builds a HarmonyEngine::Chord (which owns vectors)
+// when the followed chord actually changes.
+
+#include "HarmonyExampleUtils.h"
+
+#include <rpdsp/chroma.h>
+#include <rpdsp/decimator.h>
+#include <rpdsp/spectrum.h>
+
+#include <HarmonyEngine/MusicTheory.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace harmony_examples {
+
+inline HarmonyEngine::ChordType toChordType(rpdsp::ChordShape shape) {
+  switch (shape) {
+    case rpdsp::ChordShape::Major: return HarmonyEngine::ChordType::Major;
+    case rpdsp::ChordShape::Minor: return HarmonyEngine::ChordType::Minor;
+    case rpdsp::ChordShape::Diminished: return HarmonyEngine::ChordType::Diminished;
+    case rpdsp::ChordShape::Augmented: return HarmonyEngine::ChordType::Augmented;
+    case rpdsp::ChordShape::Sus2: return HarmonyEngine::ChordType::Sus2;
+    case rpdsp::ChordShape::Sus4: return HarmonyEngine::ChordType::Sus4;
+    case rpdsp::ChordShape::Major7: return HarmonyEngine::ChordType::Major7;
+    case rpdsp::ChordShape::Minor7: return HarmonyEngine::ChordType::Minor7;
+    case rpdsp::ChordShape::Dominant7: return HarmonyEngine::ChordType::Dominant7;
+    case rpdsp::ChordShape::HalfDiminished7: return HarmonyEngine::ChordType::HalfDiminished7;
+    case rpdsp::ChordShape::Diminished7: return HarmonyEngine::ChordType::Diminished7;
+  }
+  return HarmonyEngine::ChordType::Major;
+}
+
+// Root-position chord with notes voiced from baseMidi, ready for the harmony engines.
+inline HarmonyEngine::Chord toHarmonyChord(const rpdsp::ChordMatch& match, int baseMidi = 48) {
+  return materializeChord(HarmonyEngine::Chord(toChordType(match.shape), match.root), baseMidi);
+}
+
+// Defaults: 4x decimation to 12 kHz and 2048-point frames (5.9 Hz bins, 85 ms hop at 50%).
+template <std::size_t FrameSize = 2048, std::size_t DecimationFactor = 4>
+class AudioChordFollower {
+ public:
+  using FrameBuilder = rpdsp::StftFrameBuilder<FrameSize>;
+
+  // Control side, before audio starts.
+  void prepare(float sampleRate) {
+    decimator_.prepare(sampleRate);
+    frames_.reset();
+    chromagram_.prepare(decimator_.outputSampleRate());
+    matcher_.reset();
+  }
+
+  // Below this chromagram energy the input counts as silence and no chord is followed.
+  void setSilenceThreshold(float energy) { silenceThreshold_ = energy > 0.0f ? energy : 0.0f; }
+
+  rpdsp::Chromagram<FrameSize>& chromagram() { return chromagram_; }
+  rpdsp::ChordTemplateMatcher& matcher() { return matcher_; }
+
+  // Audio side, once per block: decimates into a small stack buffer and pushes it.
+  void push(const float* input, std::size_t frames) {
+    float decimated[rpdsp::kDefaultBlockSize];
+    std::size_t offset = 0;
+    while (offset < frames) {
+      const std::size_t chunk = frames - offset < rpdsp::kDefaultBlockSize ? frames - offset : rpdsp::kDefaultBlockSize;
+      const std::size_t written = decimator_.process(input + offset, chunk, decimated);
+      frames_.push(decimated, written);
+      offset += chunk;
+    }
+  }
+
+  // Control side: consumes every pending frame. Returns true when the followed chord changed;
+  // the new chord (valid or not) is then available from chord().
+  bool update() {
+    bool changed = false;
+    while (frames_.nextFrame(frame_)) {
+      chromagram_.process(frame_);
+      const rpdsp::ChordMatch previous = matcher_.current();
+      const rpdsp::ChordMatch& next = chromagram_.energy() >= silenceThreshold_
+                                          ? matcher_.process(chromagram_.chroma())
+                                          : silence();
+      if (next.valid != previous.valid ||
+          (next.valid && (next.root != previous.root || next.shape != previous.shape))) {
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  [[nodiscard]] const rpdsp::ChordMatch& match() const { return matcher_.current(); }
+
+  // Builds the HarmonyEngine chord; allocates, so call it on a change, not per frame.
+  [[nodiscard]] HarmonyEngine::Chord chord(int baseMidi = 48) const { return toHarmonyChord(match(), baseMidi); }
+
+  [[nodiscard]] std::uint32_t droppedFrames() const { return frames_.droppedFrames(); }
+
+ private:
+  const rpdsp::ChordMatch& silence() {
+    matcher_.reset();
+    return matcher_.current();
+  }
+
+  rpdsp::Decimator<DecimationFactor> decimator_;
+  FrameBuilder frames_;
+  rpdsp::Chromagram<FrameSize> chromagram_;
+  rpdsp::ChordTemplateMatcher matcher_;
+  float frame_[FrameSize] = {};
+  float silenceThreshold_ = 1.0e-3f;
+};
+
+}  // namespace harmony_examples
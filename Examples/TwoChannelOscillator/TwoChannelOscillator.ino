@@ -29,6 +29,7 @@ const int   NUM_AUDIO_BUFFERS  = 3;
 const int   SAMPLES_PER_BUFFER = 32;
 
 audio_buffer_pool_t *producer_pool = nullptr;
+AUDIO_BUFFER_POOL_STORAGE(producer_storage, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER, 8);
 
 // ─── Oscillators ──────────────────────────────────────────────────────────────
 rpdsp::SineOscillator osc_left;
@@ -112,7 +113,7 @@ void setup() {
         .format        = &fmt,
         .sample_stride = 8
     };
-    producer_pool = audio_new_producer_pool(&bfmt, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER);
+    producer_pool = audio_init_producer_pool(&producer_storage, &bfmt, NUM_AUDIO_BUFFERS, SAMPLES_PER_BUFFER);
 
     audio_i2s_config_t i2sCfg = {
         .data_pin       = PICO_AUDIO_I2S_DATA_PIN,
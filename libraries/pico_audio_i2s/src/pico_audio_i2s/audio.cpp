@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <cmath>
 #include <cstring>
 #include "audio.h"
 #include "sample_conversion.h"
@@ -75,6 +76,69 @@ inline static void list_append_with_tail(audio_buffer_t **phead, audio_buffer_t
     }
 }
 
+#if PICO_AUDIO_LOCK_FREE_QUEUES
+
+// The slot is written before the tail that publishes it, and read before the head that
+// hands it back; the fences order those against the other core.
+static inline void queue_push(audio_buffer_queue_t *queue, audio_buffer_t *ab) {
+    uint32_t tail = queue->tail;
+    // Capacity is checked against the pool size up front, so this cannot fill.
+    audio_assert(tail - queue->head < PICO_AUDIO_QUEUE_CAPACITY);
+    queue->slots[tail & (PICO_AUDIO_QUEUE_CAPACITY - 1)] = ab;
+    __mem_fence_release();
+    queue->tail = tail + 1;
+}
+
+static inline audio_buffer_t *queue_pop(audio_buffer_queue_t *queue) {
+    uint32_t head = queue->head;
+    if (head == queue->tail) return NULL;
+    __mem_fence_acquire();
+    audio_buffer_t *ab = queue->slots[head & (PICO_AUDIO_QUEUE_CAPACITY - 1)];
+    __mem_fence_release();
+    queue->head = head + 1;
+    return ab;
+}
+
+audio_buffer_t *get_free_audio_buffer(audio_buffer_pool_t *context, bool block) {
+    audio_buffer_t *ab;
+
+    do {
+        ab = queue_pop(&context->free_queue);
+        if (ab || !block) break;
+        __wfe();
+    } while (true);
+    return ab;
+}
+
+void queue_free_audio_buffer(audio_buffer_pool_t *context, audio_buffer_t *ab) {
+    assert(!ab->next);
+    queue_push(&context->free_queue, ab);
+    __sev();
+}
+
+audio_buffer_t *get_full_audio_buffer(audio_buffer_pool_t *context, bool block) {
+    audio_buffer_t *ab;
+
+    do {
+        ab = queue_pop(&context->prepared_queue);
+        if (ab || !block) break;
+        __wfe();
+    } while (true);
+    return ab;
+}
+
+void queue_full_audio_buffer(audio_buffer_pool_t *context, audio_buffer_t *ab) {
+    assert(!ab->next);
+    queue_push(&context->prepared_queue, ab);
+    __sev();
+}
+
+uint32_t audio_buffer_pool_prepared_depth(audio_buffer_pool_t *context) {
+    return context->prepared_queue.tail - context->prepared_queue.head;
+}
+
+#else
+
 audio_buffer_t *get_free_audio_buffer(audio_buffer_pool_t *context, bool block) {
     audio_buffer_t *ab;
 
@@ -117,6 +181,18 @@ void queue_full_audio_buffer(audio_buffer_pool_t *context, audio_buffer_t *ab) {
     __sev();
 }
 
+uint32_t audio_buffer_pool_prepared_depth(audio_buffer_pool_t *context) {
+    uint32_t depth = 0;
+    uint32_t save = spin_lock_blocking(context->prepared_list_spin_lock);
+    for (audio_buffer_t *ab = context->prepared_list; ab; ab = ab->next) {
+        depth++;
+    }
+    spin_unlock(context->prepared_list_spin_lock, save);
+    return depth;
+}
+
+#endif
+
 void producer_pool_give_buffer_default(audio_connection_t *connection, audio_buffer_t *buffer) {
     queue_full_audio_buffer(connection->producer_pool, buffer);
 }
@@ -153,23 +229,73 @@ void audio_init_buffer(audio_buffer_t *audio_buffer, audio_buffer_format_t *form
     audio_buffer->sample_count = 0;
 }
 
-audio_buffer_pool_t *
-audio_new_buffer_pool(audio_buffer_format_t *format, int buffer_count, int buffer_sample_count) {
-    audio_buffer_pool_t *ac = (audio_buffer_pool_t *) calloc(1, sizeof(audio_buffer_pool_t));
-    audio_buffer_t *audio_buffers = buffer_count ? (audio_buffer_t *) calloc(buffer_count,
-                                                                                       sizeof(audio_buffer_t)) : 0;
+// Queue (or list) up a pool's buffers, already initialised, as free.
+static void audio_buffer_pool_link(audio_buffer_pool_t *ac, audio_buffer_format_t *format,
+                                   audio_buffer_t *audio_buffers, int buffer_count) {
     ac->format = format->format;
+#if PICO_AUDIO_LOCK_FREE_QUEUES
+    // Pass-thru connections move buffers between pools, so the whole system's buffers must
+    // fit one queue; a pool's own count is the check we can make here.
+    if (buffer_count > PICO_AUDIO_QUEUE_CAPACITY) {
+        panic("audio pool of %d buffers exceeds PICO_AUDIO_QUEUE_CAPACITY", buffer_count);
+    }
+    for (int i = 0; i < buffer_count; i++) {
+        audio_buffers[i].next = NULL;
+        ac->free_queue.slots[i] = audio_buffers + i;
+    }
+    ac->free_queue.head = 0;
+    ac->free_queue.tail = buffer_count;
+    ac->prepared_queue.head = 0;
+    ac->prepared_queue.tail = 0;
+#else
     for (int i = 0; i < buffer_count; i++) {
-        audio_init_buffer(audio_buffers + i, format, buffer_sample_count);
         audio_buffers[i].next = i != buffer_count - 1 ? &audio_buffers[i + 1] : NULL;
     }
     // todo one per channel?
     ac->free_list_spin_lock = spin_lock_init(SPINLOCK_ID_AUDIO_FREE_LIST_LOCK);
-    ac->free_list = audio_buffers;
+    ac->free_list = buffer_count ? audio_buffers : NULL;
     ac->prepared_list_spin_lock = spin_lock_init(SPINLOCK_ID_AUDIO_PREPARED_LISTS_LOCK);
     ac->prepared_list = NULL;
     ac->prepared_list_tail = NULL;
+#endif
     ac->connection = &connection_default;
+}
+
+audio_buffer_pool_t *
+audio_new_buffer_pool(audio_buffer_format_t *format, int buffer_count, int buffer_sample_count) {
+    audio_buffer_pool_t *ac = (audio_buffer_pool_t *) calloc(1, sizeof(audio_buffer_pool_t));
+    audio_buffer_t *audio_buffers = buffer_count ? (audio_buffer_t *) calloc(buffer_count,
+                                                                                       sizeof(audio_buffer_t)) : 0;
+    for (int i = 0; i < buffer_count; i++) {
+        audio_init_buffer(audio_buffers + i, format, buffer_sample_count);
+    }
+    audio_buffer_pool_link(ac, format, audio_buffers, buffer_count);
+    return ac;
+}
+
+static audio_buffer_pool_t *audio_init_buffer_pool(const audio_buffer_pool_storage_t *storage,
+                                                   audio_buffer_format_t *format, int buffer_count,
+                                                   int buffer_sample_count) {
+    if (buffer_count < 0 || (uint32_t) buffer_count > storage->buffer_count
+        || (buffer_count && ((uint32_t) buffer_sample_count > storage->buffer_sample_count
+                             || format->sample_stride > storage->sample_stride))) {
+        panic("audio pool of %d x %d frames does not fit its static storage", buffer_count, buffer_sample_count);
+    }
+    audio_buffer_pool_t *ac = storage->pool;
+    memset(ac, 0, sizeof(*ac));
+    // Zeroed like calloc'd buffers, so a pool started before the first render plays silence.
+    memset(storage->bytes, 0, (size_t) buffer_count * storage->buffer_bytes);
+    for (int i = 0; i < buffer_count; i++) {
+        audio_buffer_t *audio_buffer = storage->buffers + i;
+        pico_buffer_wrap_in_place(storage->mem + i, storage->bytes + i * storage->buffer_bytes,
+                                  storage->buffer_bytes);
+        audio_buffer->buffer = storage->mem + i;
+        audio_buffer->format = format;
+        audio_buffer->max_sample_count = buffer_sample_count;
+        audio_buffer->sample_count = 0;
+        audio_buffer->user_data = 0;
+    }
+    audio_buffer_pool_link(ac, format, storage->buffers, buffer_count);
     return ac;
 }
 
@@ -200,6 +326,20 @@ audio_new_consumer_pool(audio_buffer_format_t *format, int buffer_count, int buf
     return ac;
 }
 
+audio_buffer_pool_t *audio_init_producer_pool(const audio_buffer_pool_storage_t *storage, audio_buffer_format_t *format,
+                                              int buffer_count, int buffer_sample_count) {
+    audio_buffer_pool_t *ac = audio_init_buffer_pool(storage, format, buffer_count, buffer_sample_count);
+    ac->type = audio_buffer_pool::ac_producer;
+    return ac;
+}
+
+audio_buffer_pool_t *audio_init_consumer_pool(const audio_buffer_pool_storage_t *storage, audio_buffer_format_t *format,
+                                              int buffer_count, int buffer_sample_count) {
+    audio_buffer_pool_t *ac = audio_init_buffer_pool(storage, format, buffer_count, buffer_sample_count);
+    ac->type = audio_buffer_pool::ac_consumer;
+    return ac;
+}
+
 void audio_complete_connection(audio_connection_t *connection, audio_buffer_pool_t *producer_pool,
                                audio_buffer_pool_t *consumer_pool) {
     assert(producer_pool->type == audio_buffer_pool::ac_producer);
@@ -263,4 +403,186 @@ void stereo_to_stereo_producer_give_s32(audio_connection_t *connection, audio_bu
     return producer_pool_blocking_give<Stereo<FmtS32>, Stereo<FmtS32>>(connection, buffer);
 }
 
+// ======================
+// == RESAMPLING ========
+
+static_assert(PICO_AUDIO_RESAMPLER_TAPS >= 8 && PICO_AUDIO_RESAMPLER_TAPS % 2 == 0,
+              "PICO_AUDIO_RESAMPLER_TAPS must be even and at least 8");
+static_assert(PICO_AUDIO_RESAMPLER_PHASES >= 2 && (PICO_AUDIO_RESAMPLER_PHASES & (PICO_AUDIO_RESAMPLER_PHASES - 1)) == 0,
+              "PICO_AUDIO_RESAMPLER_PHASES must be a power of two");
+
+static const uint resampler_taps = PICO_AUDIO_RESAMPLER_TAPS;
+static const uint resampler_phase_bits = __builtin_ctz(PICO_AUDIO_RESAMPLER_PHASES);
+
+// Float <-> sample conversion for the filter; S32 is 24-in-32, so full scale is 2^31.
+template<typename Fmt>
+struct resampler_sample;
+
+template<>
+struct resampler_sample<FmtS16> {
+    static float to_float(int16_t sample) {
+        return (float) sample * (1.0f / 32768.0f);
+    }
+
+    static int16_t from_float(float value) {
+        int32_t v = (int32_t) (value * 32768.0f + (value < 0.0f ? -0.5f : 0.5f));
+        return (int16_t) std::max<int32_t>(-32768, std::min<int32_t>(v, 32767));
+    }
+};
+
+template<>
+struct resampler_sample<FmtS32> {
+    static float to_float(int32_t sample) {
+        return (float) sample * (1.0f / 2147483648.0f);
+    }
+
+    static int32_t from_float(float value) {
+        // The top of the range is the largest float below 1 with a 24-bit mantissa, so the
+        // product fits and the low byte stays zero.
+        value = std::max(-1.0f, std::min(value, 0.99999994f));
+        return (int32_t) (value * 2147483648.0f) & ~0xff;
+    }
+};
+
+static double resampler_bessel_i0(double x) {
+    double sum = 1.0, term = 1.0, quarter_square = 0.25 * x * x;
+    for (int k = 1; k < 32 && term > 1.0e-12 * sum; k++) {
+        term *= quarter_square / ((double) k * (double) k);
+        sum += term;
+    }
+    return sum;
+}
+
+// Kaiser (beta 8) windowed sinc with its transition band just below the lower rate's Nyquist.
+// Row p is the kernel at a sub-sample offset of p / PHASES, each row normalized for unity DC
+// gain; the extra last row lets the interpolation between rows never wrap.
+static void resampler_design(audio_resampling_connection_t *rc, double ratio) {
+    const double beta = 8.0, half = 0.5 * resampler_taps, pi = 3.14159265358979323846;
+    const double nyquist = 0.5 * std::min(1.0, 1.0 / ratio);
+    const double cutoff = std::max(nyquist - 3.2 / resampler_taps, 0.25 * nyquist);
+    const double window = resampler_bessel_i0(beta);
+    for (uint p = 0; p <= PICO_AUDIO_RESAMPLER_PHASES; p++) {
+        float *row = rc->table + p * resampler_taps;
+        double sum = 0.0;
+        for (uint k = 0; k < resampler_taps; k++) {
+            double t = (double) k - half + (double) p / PICO_AUDIO_RESAMPLER_PHASES;
+            double x = 2.0 * cutoff * t;
+            double sinc = std::fabs(x) < 1.0e-12 ? 1.0 : std::sin(pi * x) / (pi * x);
+            double r = t / half;
+            double w = r * r < 1.0 ? resampler_bessel_i0(beta * std::sqrt(1.0 - r * r)) / window : 0.0;
+            row[k] = (float) (sinc * w);
+            sum += sinc * w;
+        }
+        for (uint k = 0; k < resampler_taps; k++) {
+            row[k] = (float) (row[k] / sum);
+        }
+    }
+}
+
+static inline void resampler_push(audio_resampling_connection_t *rc, float left, float right) {
+    // Written twice so the taps read one contiguous span, newest first.
+    rc->index = rc->index ? rc->index - 1 : resampler_taps - 1;
+    rc->history[0][rc->index] = rc->history[0][rc->index + resampler_taps] = left;
+    rc->history[1][rc->index] = rc->history[1][rc->index + resampler_taps] = right;
+}
+
+static inline void resampler_render(const audio_resampling_connection_t *rc, float *left, float *right) {
+    const float *a = rc->table + (rc->frac >> (32u - resampler_phase_bits)) * resampler_taps;
+    const float *b = a + resampler_taps;
+    const float blend = (float) (uint32_t) (rc->frac << resampler_phase_bits) * (1.0f / 4294967296.0f);
+    const float *l = rc->history[0] + rc->index;
+    const float *r = rc->history[1] + rc->index;
+    float sum_l = 0.0f, sum_r = 0.0f;
+    for (uint k = 0; k < resampler_taps; k++) {
+        float c = a[k] + blend * (b[k] - a[k]);
+        sum_l += c * l[k];
+        sum_r += c * r[k];
+    }
+    *left = sum_l;
+    *right = sum_r;
+}
+
+// Same producer-buffer walk as consumer_pool_take, but the producer position advances by the
+// conversion ratio instead of one frame per frame.
+template<typename Fmt>
+static audio_buffer_t *resampling_consumer_take(audio_connection_t *connection, bool block) {
+    audio_resampling_connection_t *rc = (audio_resampling_connection_t *) connection;
+    struct buffer_copying_on_consumer_take_connection *cc = &rc->copy;
+    typedef typename Fmt::sample_t sample_t;
+    audio_buffer_t *buffer = get_free_audio_buffer(cc->core.consumer_pool, block);
+    if (!buffer) return NULL;
+    assert(buffer->format->sample_stride == Stereo<Fmt>::frame_stride);
+
+    int32_t ppm = rc->correction_ppm;
+    uint64_t step = rc->nominal_step + (uint64_t) (((int64_t) rc->nominal_step * ppm) / 1000000);
+    sample_t *out = (sample_t *) buffer->buffer->bytes;
+    uint32_t pos = 0;
+    while (pos < buffer->max_sample_count) {
+        while (rc->need) {
+            if (!cc->current_producer_buffer) {
+                cc->current_producer_buffer = get_full_audio_buffer(cc->core.producer_pool, block);
+                if (!cc->current_producer_buffer) {
+                    assert(!block);
+                    if (!pos) {
+                        queue_free_audio_buffer(cc->core.consumer_pool, buffer);
+                        return NULL;
+                    }
+                    buffer->sample_count = pos;
+                    return buffer;
+                }
+                assert(cc->current_producer_buffer->format->format->channel_count == 2);
+                assert(cc->current_producer_buffer->format->sample_stride == Stereo<Fmt>::frame_stride);
+                cc->current_producer_buffer_pos = 0;
+            }
+            const sample_t *in = ((const sample_t *) cc->current_producer_buffer->buffer->bytes) +
+                                 cc->current_producer_buffer_pos * 2;
+            resampler_push(rc, resampler_sample<Fmt>::to_float(in[0]), resampler_sample<Fmt>::to_float(in[1]));
+            rc->need--;
+            if (++cc->current_producer_buffer_pos == cc->current_producer_buffer->sample_count) {
+                queue_free_audio_buffer(cc->core.producer_pool, cc->current_producer_buffer);
+                cc->current_producer_buffer = NULL;
+            }
+        }
+        float left, right;
+        resampler_render(rc, &left, &right);
+        out[pos * 2] = resampler_sample<Fmt>::from_float(left);
+        out[pos * 2 + 1] = resampler_sample<Fmt>::from_float(right);
+        pos++;
+        uint64_t next = (uint64_t) rc->frac + step;
+        rc->need = (uint32_t) (next >> 32u);
+        rc->frac = (uint32_t) next;
+    }
+    buffer->sample_count = pos;
+    return buffer;
+}
+
+static audio_buffer_t *resampling_consumer_take_any(audio_connection_t *connection, bool block) {
+    if (connection->producer_pool->format->format == AUDIO_BUFFER_FORMAT_PCM_S32)
+        return resampling_consumer_take<FmtS32>(connection, block);
+    assert(connection->producer_pool->format->format == AUDIO_BUFFER_FORMAT_PCM_S16);
+    return resampling_consumer_take<FmtS16>(connection, block);
+}
+
+void audio_resampling_connection_init(audio_resampling_connection_t *connection, uint32_t input_freq,
+                                      uint32_t output_freq) {
+    assert(input_freq && output_freq);
+    memset(connection, 0, sizeof(*connection));
+    connection->copy.core.consumer_pool_take = resampling_consumer_take_any;
+    connection->copy.core.consumer_pool_give = consumer_pool_give_buffer_default;
+    connection->copy.core.producer_pool_take = producer_pool_take_buffer_default;
+    connection->copy.core.producer_pool_give = producer_pool_give_buffer_default;
+    connection->input_freq = input_freq;
+    connection->output_freq = output_freq;
+    // Up to 8:1 either way; past that the taps cannot hold the transition band.
+    double ratio = std::max(0.125, std::min((double) input_freq / output_freq, 8.0));
+    connection->nominal_step = (uint64_t) (ratio * 4294967296.0 + 0.5);
+    connection->need = 1;
+    resampler_design(connection, ratio);
+}
+
+void audio_resampling_connection_set_correction_ppm(audio_resampling_connection_t *connection, int32_t ppm) {
+    connection->correction_ppm = std::max<int32_t>(-PICO_AUDIO_RESAMPLER_MAX_PPM,
+                                                   std::min<int32_t>(ppm, PICO_AUDIO_RESAMPLER_MAX_PPM));
+}
+
 #endif
\ No newline at end of file
@@ -33,6 +33,29 @@ extern "C" {
 #define SPINLOCK_ID_AUDIO_PREPARED_LISTS_LOCK 7
 #endif
 
+// PICO_CONFIG: PICO_AUDIO_LOCK_FREE_QUEUES, Use single-producer/single-consumer index rings for the free and prepared queues instead of spin-locked lists, type=bool, default=1, group=audio
+#ifndef PICO_AUDIO_LOCK_FREE_QUEUES
+#define PICO_AUDIO_LOCK_FREE_QUEUES 1
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_QUEUE_CAPACITY, Slots in each lock-free queue; a power of two at least the number of buffers that can be queued at once, min=2, default=8, group=audio
+#ifndef PICO_AUDIO_QUEUE_CAPACITY
+#define PICO_AUDIO_QUEUE_CAPACITY 8
+#endif
+
+#if PICO_AUDIO_QUEUE_CAPACITY & (PICO_AUDIO_QUEUE_CAPACITY - 1)
+#error PICO_AUDIO_QUEUE_CAPACITY must be a power of two
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_BUFFER_ALIGNMENT, Byte alignment of each statically allocated audio buffer; a power of two, at least 4 for 32-bit DMA, default=4, group=audio
+#ifndef PICO_AUDIO_BUFFER_ALIGNMENT
+#define PICO_AUDIO_BUFFER_ALIGNMENT 4
+#endif
+
+#if PICO_AUDIO_BUFFER_ALIGNMENT < 4 || (PICO_AUDIO_BUFFER_ALIGNMENT & (PICO_AUDIO_BUFFER_ALIGNMENT - 1))
+#error PICO_AUDIO_BUFFER_ALIGNMENT must be a power of two of at least 4
+#endif
+
 // PICO_CONFIG: PICO_AUDIO_NOOP, Enable/disable audio by forcing NOOPS, type=bool, default=0, group=audio
 #ifndef PICO_AUDIO_NOOP
 #define PICO_AUDIO_NOOP 0
@@ -74,6 +97,19 @@ typedef struct audio_buffer {
 
 typedef struct audio_connection audio_connection_t;
 
+/** \brief Lock-free queue of buffers for exactly one producer and one consumer
+ *
+ * head and tail are free-running counters; each is written by one side only, so neither side
+ * needs a lock or has to mask interrupts. The shipped connections keep every queue
+ * single-producer/single-consumer: one side is the DMA IRQ, the other the producer core (or
+ * the IRQ itself).
+ */
+typedef struct audio_buffer_queue {
+    audio_buffer_t *slots[PICO_AUDIO_QUEUE_CAPACITY];
+    volatile uint32_t head; // next slot to read; written by the consumer only
+    volatile uint32_t tail; // next slot to write; written by the producer only
+} audio_buffer_queue_t;
+
 typedef struct audio_buffer_pool {
     enum {
         ac_producer, ac_consumer
@@ -81,12 +117,17 @@ typedef struct audio_buffer_pool {
     const audio_format_t *format;
     // private
     audio_connection_t *connection;
+#if PICO_AUDIO_LOCK_FREE_QUEUES
+    audio_buffer_queue_t free_queue;
+    audio_buffer_queue_t prepared_queue;
+#else
     spin_lock_t *free_list_spin_lock;
     // ----- begin protected by free_list_spin_lock -----
     audio_buffer_t *free_list;
     spin_lock_t *prepared_list_spin_lock;
     audio_buffer_t *prepared_list;
     audio_buffer_t *prepared_list_tail;
+#endif
 } audio_buffer_pool_t;
 
 typedef struct audio_connection audio_connection_t;
@@ -126,6 +167,73 @@ audio_buffer_pool_t *audio_new_producer_pool(audio_buffer_format_t *format, int
 audio_buffer_pool_t *audio_new_consumer_pool(audio_buffer_format_t *format, int buffer_count,
                                                          int buffer_sample_count);
 
+/** \brief Static storage for one buffer pool, declared with AUDIO_BUFFER_POOL_STORAGE
+ *
+ * Everything a pool needs (the pool, its buffers and their sample memory) sized at compile
+ * time, so it shows up in the link map and setting the pool up never touches the heap.
+ */
+typedef struct audio_buffer_pool_storage {
+    audio_buffer_pool_t *pool;
+    audio_buffer_t *buffers;
+    mem_buffer_t *mem;
+    uint8_t *bytes;
+    uint32_t buffer_count;
+    uint32_t buffer_sample_count;
+    uint32_t sample_stride;
+    uint32_t buffer_bytes;      ///< Per buffer, rounded up to PICO_AUDIO_BUFFER_ALIGNMENT
+} audio_buffer_pool_storage_t;
+
+/** \brief Bytes reserved per static buffer: sample data rounded up to PICO_AUDIO_BUFFER_ALIGNMENT */
+#define AUDIO_BUFFER_BYTES(buffer_sample_count, sample_stride) \
+    ((((buffer_sample_count) * (sample_stride)) + (PICO_AUDIO_BUFFER_ALIGNMENT - 1)) \
+        & ~(PICO_AUDIO_BUFFER_ALIGNMENT - 1))
+
+/** \brief Declare static storage for a pool, with its sample memory in a chosen section
+ *  \ingroup pico_audio
+ *
+ * placement is a section attribute such as __scratch_x("audio") or __scratch_y("audio") to
+ * keep the DMA's reads in an SRAM bank of their own, or empty for ordinary .bss. Every buffer
+ * starts on a PICO_AUDIO_BUFFER_ALIGNMENT boundary.
+ */
+#define AUDIO_BUFFER_POOL_STORAGE_IN(name, buffer_count, buffer_sample_count, sample_stride, placement) \
+    static uint8_t placement name##_bytes[(buffer_count)][AUDIO_BUFFER_BYTES(buffer_sample_count, sample_stride)] \
+        __attribute__((aligned(PICO_AUDIO_BUFFER_ALIGNMENT))); \
+    static mem_buffer_t name##_mem[(buffer_count)]; \
+    static audio_buffer_t name##_buffers[(buffer_count)]; \
+    static audio_buffer_pool_t name##_pool; \
+    static const audio_buffer_pool_storage_t name = { \
+        &name##_pool, name##_buffers, name##_mem, &name##_bytes[0][0], (buffer_count), (buffer_sample_count), \
+        (sample_stride), AUDIO_BUFFER_BYTES(buffer_sample_count, sample_stride)}
+
+/** \brief Declare static storage for a pool in ordinary .bss
+ *  \ingroup pico_audio
+ */
+#define AUDIO_BUFFER_POOL_STORAGE(name, buffer_count, buffer_sample_count, sample_stride) \
+    AUDIO_BUFFER_POOL_STORAGE_IN(name, buffer_count, buffer_sample_count, sample_stride, )
+
+/*! \brief Initialise a producer pool in static storage, without allocating
+ *  \ingroup pico_audio
+ *
+ * Panics if buffer_count, buffer_sample_count or the format's sample_stride exceed what the
+ * storage was declared with. Calling it again resets the pool.
+ *
+ * \param storage Declared with AUDIO_BUFFER_POOL_STORAGE or AUDIO_BUFFER_POOL_STORAGE_IN
+ * \param format Format of the audio buffer
+ * \param buffer_count Buffers to put in the pool
+ * \param buffer_sample_count Frames per buffer
+ * \return The pool inside storage
+ */
+audio_buffer_pool_t *audio_init_producer_pool(const audio_buffer_pool_storage_t *storage, audio_buffer_format_t *format,
+                                              int buffer_count, int buffer_sample_count);
+
+/*! \brief Initialise a consumer pool in static storage, without allocating
+ *  \ingroup pico_audio
+ *
+ * As audio_init_producer_pool().
+ */
+audio_buffer_pool_t *audio_init_consumer_pool(const audio_buffer_pool_storage_t *storage, audio_buffer_format_t *format,
+                                              int buffer_count, int buffer_sample_count);
+
 /*! \brief Allocate and initialise an audio wrapping buffer
  *  \ingroup pico_audio
  *
@@ -225,6 +333,14 @@ audio_buffer_t *get_full_audio_buffer(audio_buffer_pool_t *context, bool block);
  */
 void queue_full_audio_buffer(audio_buffer_pool_t *context, audio_buffer_t *ab);
 
+/*! \brief Number of buffers in a pool's prepared queue
+ *  \ingroup pico_audio
+ *
+ * Exact from the queue's consumer side; from elsewhere it may be one out while the other
+ * side is mid-operation.
+ */
+uint32_t audio_buffer_pool_prepared_depth(audio_buffer_pool_t *context);
+
 /*! \brief \todo
  *  \ingroup pico_audio
  *
@@ -306,6 +422,63 @@ audio_buffer_t *stereo_to_stereo_consumer_take_s32(audio_connection_t *connectio
  */
 void stereo_to_stereo_producer_give_s32(audio_connection_t *connection, audio_buffer_t *buffer);
 
+// PICO_CONFIG: PICO_AUDIO_RESAMPLER_TAPS, Taps per output sample in audio_resampling_connection_t; must be even, default=32, group=audio
+#ifndef PICO_AUDIO_RESAMPLER_TAPS
+#define PICO_AUDIO_RESAMPLER_TAPS 32
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_RESAMPLER_PHASES, Tabulated sub-sample offsets in audio_resampling_connection_t; must be a power of two, default=32, group=audio
+#ifndef PICO_AUDIO_RESAMPLER_PHASES
+#define PICO_AUDIO_RESAMPLER_PHASES 32
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_RESAMPLER_MAX_PPM, Largest drift correction audio_resampling_connection_set_correction_ppm() applies, default=10000, group=audio
+#ifndef PICO_AUDIO_RESAMPLER_MAX_PPM
+#define PICO_AUDIO_RESAMPLER_MAX_PPM 10000
+#endif
+
+/** \brief Consumer-take connection that converts the producer's sample rate to the consumer's
+ *  \ingroup pico_audio
+ *
+ * Stereo S16 or S32 in, the same format out. A Kaiser-windowed sinc, tabulated at
+ * PICO_AUDIO_RESAMPLER_PHASES sub-sample offsets and interpolated between them, so any pair
+ * of rates works and the ratio can be trimmed at runtime to follow an external clock. The
+ * filter follows the lower of the two rates with its whole transition band below that rate's
+ * Nyquist. Filtering runs in float, so it is cheap on RP2350 and slow (soft float) on RP2040.
+ *
+ * Fill in with audio_resampling_connection_init(), then connect it like any other connection,
+ * e.g. with audio_i2s_connect_resampled().
+ */
+typedef struct audio_resampling_connection {
+    struct buffer_copying_on_consumer_take_connection copy;
+    uint64_t nominal_step;            // producer frames per consumer frame, 32.32 fixed point
+    volatile int32_t correction_ppm;  // written by any core, read once per consumer buffer
+    uint32_t input_freq;
+    uint32_t output_freq;
+    uint32_t frac;                    // next output's offset past the centre tap, 0.32
+    uint32_t need;                    // producer frames to read before the next output
+    uint32_t index;
+    float history[2][2 * PICO_AUDIO_RESAMPLER_TAPS];
+    float table[(PICO_AUDIO_RESAMPLER_PHASES + 1) * PICO_AUDIO_RESAMPLER_TAPS];
+} audio_resampling_connection_t;
+
+/*! \brief Set up a resampling connection from input_freq to output_freq
+ *  \ingroup pico_audio
+ *
+ * Designs the filter table (a few thousand sin/exp calls), so call it before audio starts.
+ */
+void audio_resampling_connection_init(audio_resampling_connection_t *connection, uint32_t input_freq,
+                                      uint32_t output_freq);
+
+/*! \brief Trim the conversion ratio to follow a drifting producer clock
+ *  \ingroup pico_audio
+ *
+ * Positive values consume producer frames faster, e.g. +200 when the producer's clock runs
+ * 200 ppm fast. Clamped to +-PICO_AUDIO_RESAMPLER_MAX_PPM; applied from the next consumer
+ * buffer. Safe to call from either core while audio runs.
+ */
+void audio_resampling_connection_set_correction_ppm(audio_resampling_connection_t *connection, int32_t ppm);
+
 // not worth a separate header for now
 typedef struct __packed pio_audio_channel_config {
     uint8_t base_pin;
@@ -6,6 +6,7 @@
 
 #if (defined ARDUINO_ARCH_RP2040) || (defined ARDUINO_ARCH_RP2350)
 #include <stdio.h>
+#include <string.h>
 
 #include "audio_i2s.h"
 #include "audio_i2s.pio.h"
@@ -14,6 +15,10 @@
 #include "hardware/dma.h"
 #include "hardware/irq.h"
 #include "hardware/clocks.h"
+#include "hardware/timer.h"
+#if PICO_AUDIO_I2S_IRQ_TIMING
+#include "hardware/structs/systick.h"
+#endif
 
 
 CU_REGISTER_DEBUG_PINS(audio_timing)
@@ -31,12 +36,22 @@ CU_REGISTER_DEBUG_PINS(audio_timing)
 #define audio_pio __CONCAT(pio, PICO_AUDIO_I2S_PIO)
 #define GPIO_FUNC_PIOx __CONCAT(GPIO_FUNC_PIO, PICO_AUDIO_I2S_PIO)
 #define DREQ_PIOx_TX0 __CONCAT(__CONCAT(DREQ_PIO, PICO_AUDIO_I2S_PIO), _TX0)
+#define DREQ_PIOx_RX0 __CONCAT(__CONCAT(DREQ_PIO, PICO_AUDIO_I2S_PIO), _RX0)
 
 struct {
     audio_buffer_t *playing_buffer;
     uint32_t freq;
+    uint32_t producer_freq;            // last producer rate followed by the copying connections
+    volatile uint32_t pending_freq;    // audio_i2s_set_sample_freq() -> IRQ
+    volatile uint32_t pending_divider; // 0 when no change is pending
+    uint16_t cycles_per_frame; // PIO cycles per frame of the loaded program
+    uint8_t channels;          // 2, or the TDM slot count
+    uint8_t words_per_frame;   // 32-bit DMA words per frame
     uint8_t pio_sm;
     uint8_t dma_channel;
+    uint8_t entry_pc;
+    bool s32_program;
+    bool duplex;
 } shared_state;
 
 audio_format_t pio_i2s_consumer_format;
@@ -46,15 +61,117 @@ audio_buffer_format_t pio_i2s_consumer_buffer_format = {
 
 static void __isr __time_critical_func(audio_i2s_dma_irq_handler)();
 
-const audio_format_t *audio_i2s_setup(const audio_format_t *intended_audio_format,
-                                               const audio_i2s_config_t *config) {
+#if PICO_AUDIO_I2S_IRQ_TIMING
+// SysTick free-runs as a 24-bit down-counter at the processor clock; the handler is far
+// shorter than one wrap, so a masked difference is its length in cycles.
+static volatile uint32_t irq_cycles_max;
+
+static void irq_timing_init(void) {
+    systick_hw->csr = 0;
+    systick_hw->rvr = 0x00ffffffu;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5u; // enable, processor clock, no exception
+}
+#endif
+
+uint32_t audio_i2s_irq_cycles_max(void) {
+#if PICO_AUDIO_I2S_IRQ_TIMING
+    return irq_cycles_max;
+#else
+    return 0;
+#endif
+}
+
+void audio_i2s_irq_cycles_reset(void) {
+#if PICO_AUDIO_I2S_IRQ_TIMING
+    irq_cycles_max = 0;
+#endif
+}
+
+#if PICO_AUDIO_I2S_STATS
+// Written by the DMA IRQ only. sequence is odd while an update is in progress, so a reader on
+// the other core retries instead of seeing half an update.
+static struct {
+    volatile uint32_t sequence;
+    volatile bool reset_requested;
+    audio_i2s_stats_t values;
+} stats = {
+        .values = {.min_prepared_depth = UINT32_MAX},
+};
+
+static void __time_critical_func(stats_record_start)(bool silent, uint32_t waiting) {
+    uint32_t now = time_us_32();
+    audio_i2s_stats_t *v = &stats.values;
+    stats.sequence = stats.sequence + 1;
+    __mem_fence_release();
+    if (stats.reset_requested) {
+        // A loop, not memset, so the handler stays out of flash.
+        uint32_t *words = (uint32_t *) v;
+        for (uint i = 0; i < sizeof(*v) / sizeof(uint32_t); ++i) {
+            words[i] = 0;
+        }
+        v->min_prepared_depth = UINT32_MAX;
+        stats.reset_requested = false;
+    } else if (v->transfers) {
+        uint32_t interval = now - v->last_start_us;
+        if (interval > v->max_start_interval_us) {
+            v->max_start_interval_us = interval;
+        }
+    }
+    v->transfers++;
+    if (silent) {
+        v->silence_insertions++;
+    }
+    if (waiting < v->min_prepared_depth) {
+        v->min_prepared_depth = waiting;
+    }
+    v->depth_histogram[waiting < PICO_AUDIO_I2S_STATS_DEPTH_BINS - 1 ? waiting : PICO_AUDIO_I2S_STATS_DEPTH_BINS - 1]++;
+    v->last_start_us = now;
+    __mem_fence_release();
+    stats.sequence = stats.sequence + 1;
+}
+#endif
+
+void audio_i2s_get_stats(audio_i2s_stats_t *out) {
+#if PICO_AUDIO_I2S_STATS
+    uint32_t sequence;
+    do {
+        sequence = stats.sequence;
+        __mem_fence_acquire();
+        *out = stats.values;
+        __mem_fence_acquire();
+    } while ((sequence & 1u) || sequence != stats.sequence);
+#else
+    memset(out, 0, sizeof(*out));
+#endif
+}
+
+void audio_i2s_reset_stats(void) {
+#if PICO_AUDIO_I2S_STATS
+    stats.reset_requested = true;
+#endif
+}
+
+static const audio_format_t *audio_i2s_setup_internal(const audio_format_t *intended_audio_format,
+                                                      const audio_i2s_config_t *config, int data_in_pin) {
+    bool is_s32 = (intended_audio_format->format == AUDIO_BUFFER_FORMAT_PCM_S32);
+    bool duplex = data_in_pin >= 0;
+    uint channels = intended_audio_format->channel_count;
+    bool tdm = channels > 2;
+    if (tdm && ((channels != 4 && channels != 8) || !is_s32 || duplex || channels > PICO_AUDIO_I2S_MAX_CHANNELS)) {
+        panic("TDM output needs S32, 4 or 8 channels, no duplex and PICO_AUDIO_I2S_MAX_CHANNELS >= channels");
+    }
+
     uint func = GPIO_FUNC_PIOx;
     gpio_set_function(config->data_pin, func);
     gpio_set_function(config->clock_pin_base, func);
     gpio_set_function(config->clock_pin_base + 1, func);
+    if (data_in_pin >= 0) {
+        gpio_set_function((uint) data_in_pin, func);
+    }
 
 #if PICO_PIO_USE_GPIO_BASE
-    if(config->data_pin >= 32 || config->clock_pin_base + 1 >= 32) {
+    if(config->data_pin >= 32 || config->clock_pin_base + 1 >= 32 || data_in_pin >= 32) {
         assert(config->data_pin >= 16 && config->clock_pin_base >= 16);
         pio_set_gpio_base(audio_pio, 16);
     }
@@ -66,20 +183,51 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *intended_audio_forma
     // 24-in-32 left-justified output uses a sibling PIO program that clocks 32
     // bits per channel slot instead of 16; everything else (autopull threshold,
     // DMA width) is shared with the S16 program.
-    bool is_s32 = (intended_audio_format->format == AUDIO_BUFFER_FORMAT_PCM_S32);
+    shared_state.s32_program = is_s32;
+    shared_state.duplex = duplex;
+    shared_state.channels = (uint8_t) (tdm ? channels : 2u);
+#if PICO_AUDIO_I2S_MONO_OUTPUT
+    shared_state.words_per_frame = 1u;
+#else
+    // S16 packs L|R into one word; S32 and TDM send one word per channel.
+    shared_state.words_per_frame = (uint8_t) (is_s32 ? shared_state.channels : 1u);
+#endif
+    // Output-only programs spend 2 cycles per bit, duplex ones 4 (see audio_i2s.pio).
+    if (tdm)
+        shared_state.cycles_per_frame = (uint16_t) (64u * channels);
+    else
+        shared_state.cycles_per_frame = (uint16_t) ((is_s32 ? 64u : 32u) * (duplex ? 4u : 2u));
 
     const struct pio_program *program;
 #if PICO_AUDIO_I2S_CLOCK_PINS_SWAPPED
-    program = is_s32 ? &audio_i2s_32_swapped_program : &audio_i2s_swapped_program;
+    if (tdm)
+        program = &audio_tdm_swapped_program;
+    else if (duplex)
+        program = is_s32 ? &audio_i2s_32_duplex_swapped_program : &audio_i2s_duplex_swapped_program;
+    else
+        program = is_s32 ? &audio_i2s_32_swapped_program : &audio_i2s_swapped_program;
 #else
-    program = is_s32 ? &audio_i2s_32_program : &audio_i2s_program;
+    if (tdm)
+        program = &audio_tdm_program;
+    else if (duplex)
+        program = is_s32 ? &audio_i2s_32_duplex_program : &audio_i2s_duplex_program;
+    else
+        program = is_s32 ? &audio_i2s_32_program : &audio_i2s_program;
 #endif
     uint offset = pio_add_program(audio_pio, program);
 
-    if (is_s32) {
+    if (tdm) {
+        audio_tdm_program_init(audio_pio, sm, offset, config->data_pin, config->clock_pin_base, channels);
+        shared_state.entry_pc = (uint8_t) (offset + audio_tdm_offset_entry_point);
+    } else if (duplex) {
+        audio_i2s_duplex_program_init(audio_pio, sm, offset, config->data_pin, (uint) data_in_pin, config->clock_pin_base);
+        shared_state.entry_pc = (uint8_t) (offset + audio_i2s_duplex_offset_entry_point);
+    } else if (is_s32) {
         audio_i2s_32_program_init(audio_pio, sm, offset, config->data_pin, config->clock_pin_base);
+        shared_state.entry_pc = (uint8_t) (offset + audio_i2s_32_offset_entry_point);
     } else {
         audio_i2s_program_init(audio_pio, sm, offset, config->data_pin, config->clock_pin_base);
+        shared_state.entry_pc = (uint8_t) (offset + audio_i2s_offset_entry_point);
     }
 
     __mem_fence_release();
@@ -102,27 +250,88 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *intended_audio_forma
                           false // trigger
     );
 
+#if PICO_AUDIO_I2S_IRQ_TIMING
+    irq_timing_init();
+#endif
     irq_add_shared_handler(DMA_IRQ_0 + PICO_AUDIO_I2S_DMA_IRQ, audio_i2s_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
     dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, dma_channel, 1);
     return intended_audio_format;
 }
 
+const audio_format_t *audio_i2s_setup(const audio_format_t *intended_audio_format,
+                                               const audio_i2s_config_t *config) {
+    return audio_i2s_setup_internal(intended_audio_format, config, -1);
+}
+
+const audio_format_t *audio_i2s_setup_duplex(const audio_format_t *intended_audio_format,
+                                             const audio_i2s_config_t *config, uint data_in_pin) {
+    return audio_i2s_setup_internal(intended_audio_format, config, (int) data_in_pin);
+}
+
 static audio_buffer_pool_t *audio_i2s_consumer;
 
-static void update_pio_frequency(uint32_t sample_freq) {
+// Stereo S32 is the widest frame the copying connections produce; TDM passes buffers thru.
+AUDIO_BUFFER_POOL_STORAGE_IN(consumer_storage, PICO_AUDIO_I2S_CONSUMER_BUFFERS, PICO_AUDIO_I2S_CONSUMER_BUFFER_FRAMES, 8,
+                             PICO_AUDIO_I2S_BUFFER_PLACEMENT);
+
+static audio_buffer_pool_t *audio_i2s_new_consumer_pool(uint buffer_count, uint samples_per_buffer) {
+    if (buffer_count == 0
+        || (buffer_count <= PICO_AUDIO_I2S_CONSUMER_BUFFERS && samples_per_buffer <= PICO_AUDIO_I2S_CONSUMER_BUFFER_FRAMES
+            && pio_i2s_consumer_buffer_format.sample_stride <= 8)) {
+        return audio_init_consumer_pool(&consumer_storage, &pio_i2s_consumer_buffer_format, (int) buffer_count,
+                                        (int) samples_per_buffer);
+    }
+    printf("I2S consumer pool exceeds its static storage; allocating\n");
+    return audio_new_consumer_pool(&pio_i2s_consumer_buffer_format, (int) buffer_count, (int) samples_per_buffer);
+}
+
+// 16.8 fixed point: one PIO cycle per (sys_clk / (sample_freq * cycles_per_frame)); 0 if the
+// rate is out of the divider's range.
+static uint32_t pio_divider(uint32_t sample_freq) {
+    if (!sample_freq || !shared_state.cycles_per_frame) {
+        return 0;
+    }
     uint32_t system_clock_frequency = clock_get_hz(clk_sys);
-    assert(system_clock_frequency < 0x40000000);
-    uint32_t divider = system_clock_frequency * 4 / sample_freq; // avoid arithmetic overflow
-    assert(divider < 0x1000000);
-    pio_sm_set_clkdiv_int_frac(audio_pio, shared_state.pio_sm, divider >> 8u, divider & 0xffu);
+    uint64_t divider = ((uint64_t) system_clock_frequency << 8u) / ((uint64_t) sample_freq * shared_state.cycles_per_frame);
+    return (divider >= 0x100 && divider < 0x1000000) ? (uint32_t) divider : 0;
+}
+
+static void __time_critical_func(apply_pio_divider)(uint32_t divider, uint32_t sample_freq) {
+    pio_sm_set_clkdiv_int_frac(audio_pio, shared_state.pio_sm, (uint16_t) (divider >> 8u), (uint8_t) (divider & 0xffu));
     shared_state.freq = sample_freq;
+    pio_i2s_consumer_format.sample_freq = sample_freq;
 }
 
-static audio_buffer_t *wrap_consumer_take(audio_connection_t *connection, bool block) {
-    // support dynamic frequency shifting
-    if (connection->producer_pool->format->sample_freq != shared_state.freq) {
-        update_pio_frequency(connection->producer_pool->format->sample_freq);
+static void update_pio_frequency(uint32_t sample_freq) {
+    uint32_t divider = pio_divider(sample_freq);
+    assert(divider);
+    apply_pio_divider(divider, sample_freq);
+}
+
+// Called from the DMA IRQ before the next transfer starts, so a change requested with
+// audio_i2s_set_sample_freq() lands on a buffer boundary rather than inside one.
+static inline void apply_pending_frequency(void) {
+    uint32_t divider = shared_state.pending_divider;
+    if (divider) {
+        __mem_fence_acquire();
+        apply_pio_divider(divider, shared_state.pending_freq);
+        shared_state.pending_divider = 0;
+    }
+}
+
+// support dynamic frequency shifting: retune when the producer's format changes. Comparing
+// against the last producer rate rather than the PIO rate keeps an explicit
+// audio_i2s_set_sample_freq() from being undone on the next buffer.
+static inline void follow_producer_frequency(audio_connection_t *connection) {
+    uint32_t producer_freq = connection->producer_pool->format->sample_freq;
+    if (producer_freq != shared_state.producer_freq) {
+        shared_state.producer_freq = producer_freq;
+        update_pio_frequency(producer_freq);
     }
+}
+
+static audio_buffer_t *wrap_consumer_take(audio_connection_t *connection, bool block) {
+    follow_producer_frequency(connection);
 #if PICO_AUDIO_I2S_MONO_INPUT
 #if PICO_AUDIO_I2S_MONO_OUTPUT
     return mono_to_mono_consumer_take(connection, block);
@@ -141,10 +350,7 @@ static audio_buffer_t *wrap_consumer_take(audio_connection_t *connection, bool b
 }
 
 static void wrap_producer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
-    // support dynamic frequency shifting
-    if (connection->producer_pool->format->sample_freq != shared_state.freq) {
-        update_pio_frequency(connection->producer_pool->format->sample_freq);
-    }
+    follow_producer_frequency(connection);
 #if PICO_AUDIO_I2S_MONO_INPUT
 #if PICO_AUDIO_I2S_MONO_OUTPUT
     assert(false);
@@ -225,20 +431,34 @@ bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give,
     pio_i2s_consumer_format.channel_count = 1;
     pio_i2s_consumer_buffer_format.sample_stride = 2;
 #else
-    pio_i2s_consumer_format.channel_count = 2;
+    pio_i2s_consumer_format.channel_count = shared_state.channels;
     pio_i2s_consumer_buffer_format.sample_stride =
-        (producer->format->format == AUDIO_BUFFER_FORMAT_PCM_S32) ? 8 : 4;
+        (producer->format->format == AUDIO_BUFFER_FORMAT_PCM_S32) ? 4u * shared_state.channels : 4u;
+    if (shared_state.channels > 2) {
+        if (producer->format->channel_count != shared_state.channels
+            || producer->format->format != AUDIO_BUFFER_FORMAT_PCM_S32) {
+            panic("TDM producer must match the format passed to audio_i2s_setup");
+        }
+        // The copying connections are stereo-only; TDM buffers go to the DMA as rendered.
+        if (!connection) {
+            buffer_count = 0;
+        }
+    }
 #endif
 
-    audio_i2s_consumer = audio_new_consumer_pool(&pio_i2s_consumer_buffer_format, buffer_count, samples_per_buffer);
+    audio_i2s_consumer = audio_i2s_new_consumer_pool(buffer_count, samples_per_buffer);
 
     update_pio_frequency(producer->format->sample_freq);
+    shared_state.producer_freq = producer->format->sample_freq;
 
     // todo cleanup threading
     __mem_fence_release();
 
     if (!connection) {
-        if (producer->format->channel_count == 2) {
+        if (producer->format->channel_count > 2) {
+            printf("Passing %d-channel TDM thru at %d Hz\n", (int) producer->format->channel_count,
+                   (int) producer->format->sample_freq);
+        } else if (producer->format->channel_count == 2) {
 #if PICO_AUDIO_I2S_MONO_INPUT
             panic("need to merge channels down\n");
 #else
@@ -264,6 +484,19 @@ bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give,
     return true;
 }
 
+bool audio_i2s_connect_resampled(audio_buffer_pool_t *producer, audio_resampling_connection_t *connection) {
+    if (PICO_AUDIO_I2S_MONO_OUTPUT || PICO_AUDIO_I2S_MONO_INPUT
+        || producer->format->channel_count != 2 || shared_state.channels != 2) {
+        panic("resampling connection is stereo only");
+    }
+    assert(producer->format->sample_freq == connection->input_freq);
+    audio_i2s_connect_extra(producer, false, 2, 256, &connection->copy.core);
+    printf("Resampling %d Hz to %d Hz\n", (int) connection->input_freq, (int) connection->output_freq);
+    // connect_extra clocked the PIO for the producer; the consumer side runs at the output rate.
+    update_pio_frequency(connection->output_freq);
+    return true;
+}
+
 static struct buffer_copying_on_consumer_take_connection m2s_audio_i2s_connection_s8 = {
         .core = {
 #if PICO_AUDIO_I2S_MONO_OUTPUT
@@ -297,7 +530,7 @@ bool audio_i2s_connect_s8(audio_buffer_pool_t *producer) {
     // we do this on take so should do it quickly...
     uint samples_per_buffer = 256;
     // todo with take we really only need 1 buffer
-    audio_i2s_consumer = audio_new_consumer_pool(&pio_i2s_consumer_buffer_format, 2, samples_per_buffer);
+    audio_i2s_consumer = audio_i2s_new_consumer_pool(2, samples_per_buffer);
 
     // todo we need a method to calculate this in clocks
     uint32_t system_clock_frequency = clock_get_hz(clk_sys);
@@ -328,9 +561,28 @@ bool audio_i2s_connect_s8(audio_buffer_pool_t *producer) {
     return true;
 }
 
+#if PICO_AUDIO_I2S_STATS
+// Rendered buffers waiting to be played: the producer pool's prepared queue for copying
+// connections, the consumer pool's for pass-thru and copy-on-give.
+static inline uint32_t audio_prepared_depth(void) {
+    uint32_t depth = audio_buffer_pool_prepared_depth(audio_i2s_consumer);
+    audio_buffer_pool_t *producer = audio_i2s_consumer->connection->producer_pool;
+    if (producer) {
+        depth += audio_buffer_pool_prepared_depth(producer);
+    }
+    return depth;
+}
+#endif
+
 static inline void audio_start_dma_transfer() {
     assert(!shared_state.playing_buffer);
+#if PICO_AUDIO_I2S_STATS
+    uint32_t depth = audio_prepared_depth();
+#endif
     audio_buffer_t *ab = take_audio_buffer(audio_i2s_consumer, false);
+#if PICO_AUDIO_I2S_STATS
+    stats_record_start(!ab, ab && depth ? depth - 1 : 0);
+#endif
 
     shared_state.playing_buffer = ab;
     if (!ab) {
@@ -343,7 +595,10 @@ static inline void audio_start_dma_transfer() {
         dma_channel_config c = dma_get_channel_config(shared_state.dma_channel);
         channel_config_set_read_increment(&c, false);
         dma_channel_set_config(shared_state.dma_channel, &c, false);
-        dma_channel_transfer_from_buffer_now(shared_state.dma_channel, &zero, PICO_AUDIO_I2S_SILENCE_BUFFER_SAMPLE_LENGTH);
+        // Whole frames only, or the TDM slots would drift off the frame sync.
+        uint32_t silence_words = PICO_AUDIO_I2S_SILENCE_BUFFER_SAMPLE_LENGTH
+                - PICO_AUDIO_I2S_SILENCE_BUFFER_SAMPLE_LENGTH % shared_state.words_per_frame;
+        dma_channel_transfer_from_buffer_now(shared_state.dma_channel, &zero, silence_words);
         return;
     }
     assert(ab->sample_count);
@@ -356,13 +611,13 @@ static inline void audio_start_dma_transfer() {
     assert(ab->format->sample_stride == 2);
     uint32_t words_per_frame = 1u;
 #else
-    assert(ab->format->format->channel_count == 2);
-    assert(ab->format->sample_stride == 4 || ab->format->sample_stride == 8);
-    // S16 packs L|R into a single 32-bit DMA word per frame; S32 sends L and R as
-    // two separate 32-bit words, so the transfer count doubles. The DMA transfer
-    // *width* stays DMA_SIZE_32 in both cases (configured in audio_i2s_setup).
-    uint32_t words_per_frame =
-        (ab->format->format->format == AUDIO_BUFFER_FORMAT_PCM_S32) ? 2u : 1u;
+    assert(ab->format->format->channel_count == shared_state.channels);
+    // S16 packs L|R into a single 32-bit DMA word per frame; S32 sends each channel
+    // as its own 32-bit word (2 for stereo, 4 or 8 for TDM), so the transfer count
+    // scales with it. The DMA transfer *width* stays DMA_SIZE_32 in every case
+    // (configured in audio_i2s_setup).
+    uint32_t words_per_frame = shared_state.words_per_frame;
+    assert(ab->format->sample_stride == 4 * words_per_frame);
 #endif
     dma_channel_config c = dma_get_channel_config(shared_state.dma_channel);
     channel_config_set_read_increment(&c, true);
@@ -370,11 +625,289 @@ static inline void audio_start_dma_transfer() {
     dma_channel_transfer_from_buffer_now(shared_state.dma_channel, ab->buffer->bytes, ab->sample_count * words_per_frame);
 }
 
-// irq handler for DMA
-void __isr __time_critical_func(audio_i2s_dma_irq_handler)() {
-#if PICO_AUDIO_I2S_NOOP
-    assert(false);
+// ---- ring playback ----
+//
+// Each of the PICO_AUDIO_I2S_RING_SEGMENTS channels owns one segment and chains to the next,
+// so the DMA walks the ring on its own and there is no gap while an IRQ restarts a transfer.
+// A chain trigger reloads the transfer count, and the read ring wrap (segments are power-of-
+// two sized and aligned) brings each channel's read address back to the start of its
+// segment. Segments are numbered by a running sequence: sequence n lives in segment
+// n % SEGMENTS. consumed counts segments that finished playing, filled counts segments the
+// producer released; sequence n is valid to play once filled > n.
+//
+// With the duplex program a second chain of channels writes the RX FIFO into an input ring of
+// the same shape. RX word n is clocked in with TX word n, so input sequence n is exactly the
+// frames captured while output sequence n played. Input completes a few FIFO words after the
+// output, so in duplex mode the input channels drive consumed; the output segment handed out
+// for sequence n pairs with input sequence n - SEGMENTS, which lives at the same index.
+
+#define RING_SEGMENTS PICO_AUDIO_I2S_RING_SEGMENTS
+
+static struct {
+    uint8_t channels[RING_SEGMENTS];
+#if PICO_AUDIO_I2S_RING_INPUT
+    uint8_t input_channels[RING_SEGMENTS];
+#endif
+    uint32_t segment_words;
+    uint16_t frames;
+    bool active;
+    bool claimed;
+    volatile uint32_t consumed;  // written by the IRQ only
+    volatile uint32_t filled;    // written by the producer only
+    volatile uint32_t underruns; // written by the IRQ only
+} ring_state;
+
+// Sized and aligned for the widest frame allowed, one word per channel.
+#define RING_SEGMENT_BYTES (PICO_AUDIO_I2S_RING_MAX_FRAMES * PICO_AUDIO_I2S_MAX_CHANNELS * 4)
+
+static uint32_t PICO_AUDIO_I2S_BUFFER_PLACEMENT ring_storage[RING_SEGMENTS * RING_SEGMENT_BYTES / 4]
+        __attribute__((aligned(RING_SEGMENT_BYTES)));
+
+static inline uint32_t *ring_segment(uint index) {
+    return ring_storage + index * ring_state.segment_words;
+}
+
+#if PICO_AUDIO_I2S_RING_INPUT
+// Duplex is stereo only.
+static uint32_t PICO_AUDIO_I2S_BUFFER_PLACEMENT ring_input_storage[RING_SEGMENTS * PICO_AUDIO_I2S_RING_MAX_FRAMES * 2]
+        __attribute__((aligned(PICO_AUDIO_I2S_RING_MAX_FRAMES * 8)));
+
+static inline uint32_t *ring_input_segment(uint index) {
+    return ring_input_storage + index * ring_state.segment_words;
+}
+#endif
+
+static inline bool ring_duplex(void) {
+#if PICO_AUDIO_I2S_RING_INPUT
+    return shared_state.duplex;
 #else
+    return false;
+#endif
+}
+
+// The channels whose completion advances consumed.
+static inline const uint8_t *ring_irq_channels(void) {
+#if PICO_AUDIO_I2S_RING_INPUT
+    if (shared_state.duplex) {
+        return ring_state.input_channels;
+    }
+#endif
+    return ring_state.channels;
+}
+
+static void ring_reset(void) {
+    // The first SEGMENTS sequences are the zeroed ring itself, so playback opens with silence
+    // and the producer starts one full ring ahead.
+    memset(ring_storage, 0, sizeof(ring_storage));
+#if PICO_AUDIO_I2S_RING_INPUT
+    memset(ring_input_storage, 0, sizeof(ring_input_storage));
+#endif
+    ring_state.consumed = 0;
+    ring_state.filled = RING_SEGMENTS;
+}
+
+static void ring_configure_channels(void) {
+    uint ring_bits = 0;
+    while ((1u << ring_bits) < ring_state.segment_words * 4u) {
+        ++ring_bits;
+    }
+    for (uint i = 0; i < RING_SEGMENTS; ++i) {
+        uint channel = ring_state.channels[i];
+        dma_channel_config c = dma_channel_get_default_config(channel);
+        channel_config_set_dreq(&c, DREQ_PIOx_TX0 + shared_state.pio_sm);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_ring(&c, false, ring_bits);
+        channel_config_set_chain_to(&c, ring_state.channels[(i + 1) % RING_SEGMENTS]);
+        dma_channel_configure(channel, &c, &audio_pio->txf[shared_state.pio_sm], ring_segment(i),
+                              ring_state.segment_words, false);
+        dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, channel, !ring_duplex());
+    }
+#if PICO_AUDIO_I2S_RING_INPUT
+    if (!shared_state.duplex) {
+        return;
+    }
+    for (uint i = 0; i < RING_SEGMENTS; ++i) {
+        uint channel = ring_state.input_channels[i];
+        dma_channel_config c = dma_channel_get_default_config(channel);
+        channel_config_set_dreq(&c, DREQ_PIOx_RX0 + shared_state.pio_sm);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_ring(&c, true, ring_bits);
+        channel_config_set_chain_to(&c, ring_state.input_channels[(i + 1) % RING_SEGMENTS]);
+        dma_channel_configure(channel, &c, ring_input_segment(i), &audio_pio->rxf[shared_state.pio_sm],
+                              ring_state.segment_words, false);
+        dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, channel, true);
+    }
+#endif
+}
+
+static void ring_stop_chain(const uint8_t *channels) {
+    // Break the chain first so an abort cannot let one channel re-trigger another, then abort
+    // with the IRQs masked and clear whatever completion the abort raised (RP2040-E13).
+    for (uint i = 0; i < RING_SEGMENTS; ++i) {
+        uint channel = channels[i];
+        dma_channel_config c = dma_get_channel_config(channel);
+        channel_config_set_chain_to(&c, channel);
+        dma_channel_set_config(channel, &c, false);
+        dma_irqn_set_channel_enabled(PICO_AUDIO_I2S_DMA_IRQ, channel, false);
+    }
+    for (uint i = 0; i < RING_SEGMENTS; ++i) {
+        dma_channel_abort(channels[i]);
+        dma_irqn_acknowledge_channel(PICO_AUDIO_I2S_DMA_IRQ, channels[i]);
+    }
+}
+
+static void ring_stop_channels(void) {
+    ring_stop_chain(ring_state.channels);
+#if PICO_AUDIO_I2S_RING_INPUT
+    if (shared_state.duplex) {
+        ring_stop_chain(ring_state.input_channels);
+    }
+#endif
+}
+
+static void ring_start_channels(void) {
+    uint32_t mask = 1u << ring_state.channels[0];
+#if PICO_AUDIO_I2S_RING_INPUT
+    if (shared_state.duplex) {
+        // Restart the state machine at its entry point with empty FIFOs so TX and RX word
+        // counts line up from the first frame.
+        pio_sm_clear_fifos(audio_pio, shared_state.pio_sm);
+        pio_sm_restart(audio_pio, shared_state.pio_sm);
+        pio_sm_exec(audio_pio, shared_state.pio_sm, pio_encode_jmp(shared_state.entry_pc));
+        mask |= 1u << ring_state.input_channels[0];
+    }
+#endif
+    dma_start_channel_mask(mask);
+}
+
+bool audio_i2s_ring_connect(const audio_format_t *format, uint frames_per_segment) {
+#if PICO_AUDIO_I2S_MONO_OUTPUT
+    panic("ring playback is stereo only");
+#endif
+    if (format->channel_count != shared_state.channels
+        || (format->format != AUDIO_BUFFER_FORMAT_PCM_S16 && format->format != AUDIO_BUFFER_FORMAT_PCM_S32)
+        || (format->format == AUDIO_BUFFER_FORMAT_PCM_S32) != shared_state.s32_program
+        || frames_per_segment == 0 || frames_per_segment > PICO_AUDIO_I2S_RING_MAX_FRAMES
+        || (frames_per_segment & (frames_per_segment - 1u))) {
+        return false;
+    }
+#if !PICO_AUDIO_I2S_RING_INPUT
+    if (shared_state.duplex) {
+        panic("duplex I2S needs PICO_AUDIO_I2S_RING_INPUT");
+    }
+#endif
+    printf("Connecting PIO I2S audio ring (%d x %d frames%s)\n", (int) RING_SEGMENTS, (int) frames_per_segment,
+           shared_state.duplex ? ", duplex" : "");
+
+    if (!ring_state.claimed) {
+        // audio_i2s_setup claimed the configured channel; it becomes segment 0.
+        ring_state.channels[0] = shared_state.dma_channel;
+        for (uint i = 1; i < RING_SEGMENTS; ++i) {
+            ring_state.channels[i] = (uint8_t) dma_claim_unused_channel(true);
+        }
+#if PICO_AUDIO_I2S_RING_INPUT
+        if (shared_state.duplex) {
+            for (uint i = 0; i < RING_SEGMENTS; ++i) {
+                ring_state.input_channels[i] = (uint8_t) dma_claim_unused_channel(true);
+            }
+        }
+#endif
+        ring_state.claimed = true;
+    }
+    ring_state.frames = (uint16_t) frames_per_segment;
+    ring_state.segment_words = frames_per_segment * shared_state.words_per_frame;
+    ring_state.underruns = 0;
+    ring_reset();
+
+    update_pio_frequency(format->sample_freq);
+    ring_configure_channels();
+    __mem_fence_release();
+    ring_state.active = true;
+    return true;
+}
+
+void *audio_i2s_ring_acquire(bool block) {
+    for (;;) {
+        uint32_t consumed = ring_state.consumed;
+        uint32_t filled = ring_state.filled;
+        if (filled <= consumed) {
+            // Too late for everything up to the playing segment; it is going out as silence.
+            filled = consumed + 1;
+            ring_state.filled = filled;
+        }
+        if (filled - consumed < RING_SEGMENTS) {
+            __mem_fence_acquire();
+            return ring_segment(filled % RING_SEGMENTS);
+        }
+        if (!block) {
+            return NULL;
+        }
+        __wfe();
+    }
+}
+
+const void *audio_i2s_ring_input(void) {
+#if PICO_AUDIO_I2S_RING_INPUT
+    if (shared_state.duplex && ring_state.active) {
+        return ring_input_segment(ring_state.filled % RING_SEGMENTS);
+    }
+#endif
+    return NULL;
+}
+
+void audio_i2s_ring_release(void) {
+    __mem_fence_release();
+    ring_state.filled = ring_state.filled + 1;
+}
+
+uint audio_i2s_ring_frames(void) {
+    return ring_state.active ? ring_state.frames : 0;
+}
+
+uint32_t audio_i2s_ring_underruns(void) {
+    return ring_state.underruns;
+}
+
+static void __time_critical_func(audio_i2s_ring_irq)(void) {
+    const uint8_t *channels = ring_irq_channels();
+    for (uint i = 0; i < RING_SEGMENTS; ++i) {
+        uint channel = channels[i];
+        if (!dma_irqn_get_channel_status(PICO_AUDIO_I2S_DMA_IRQ, channel)) {
+            continue;
+        }
+        dma_irqn_acknowledge_channel(PICO_AUDIO_I2S_DMA_IRQ, channel);
+        DEBUG_PINS_SET(audio_timing, 4);
+        // The chained channel has already started the next segment; retuning now moves the
+        // change at most one IRQ latency past the boundary.
+        apply_pending_frequency();
+        // The producer cannot be handed this segment again until consumed moves on, so it is
+        // safe to clear: if the producer is late the segment replays as silence, not stale audio.
+        // A plain loop keeps the handler in RAM (memset lives in flash).
+        uint32_t *segment = ring_segment(i);
+        for (uint32_t w = 0; w < ring_state.segment_words; ++w) {
+            segment[w] = 0;
+        }
+        uint32_t consumed = ring_state.consumed + 1;
+        uint32_t filled = ring_state.filled;
+        if (filled <= consumed) {
+            ring_state.underruns = ring_state.underruns + 1;
+        }
+#if PICO_AUDIO_I2S_STATS
+        // The chained channel started the next segment when this one finished.
+        stats_record_start(filled <= consumed, filled > consumed ? filled - consumed - 1 : 0);
+#endif
+        __mem_fence_release();
+        ring_state.consumed = consumed;
+        __sev();
+        DEBUG_PINS_CLR(audio_timing, 4);
+    }
+}
+
+static void __time_critical_func(audio_i2s_buffer_irq)(void) {
     uint dma_channel = shared_state.dma_channel;
     if (dma_irqn_get_channel_status(PICO_AUDIO_I2S_DMA_IRQ, dma_channel)) {
         dma_irqn_acknowledge_channel(PICO_AUDIO_I2S_DMA_IRQ, dma_channel);
@@ -386,9 +919,31 @@ void __isr __time_critical_func(audio_i2s_dma_irq_handler)() {
             shared_state.playing_buffer = NULL;
 #endif
         }
+        apply_pending_frequency();
         audio_start_dma_transfer();
         DEBUG_PINS_CLR(audio_timing, 4);
     }
+}
+
+// irq handler for DMA
+void __isr __time_critical_func(audio_i2s_dma_irq_handler)() {
+#if PICO_AUDIO_I2S_NOOP
+    assert(false);
+#else
+#if PICO_AUDIO_I2S_IRQ_TIMING
+    uint32_t start = systick_hw->cvr;
+#endif
+    if (ring_state.active) {
+        audio_i2s_ring_irq();
+    } else {
+        audio_i2s_buffer_irq();
+    }
+#if PICO_AUDIO_I2S_IRQ_TIMING
+    uint32_t cycles = (start - systick_hw->cvr) & 0x00ffffffu;
+    if (cycles > irq_cycles_max) {
+        irq_cycles_max = cycles;
+    }
+#endif
 #endif
 }
 
@@ -405,7 +960,19 @@ void audio_i2s_set_enabled(bool enabled) {
 #endif
         irq_set_enabled(DMA_IRQ_0 + PICO_AUDIO_I2S_DMA_IRQ, enabled);
 
-        if (enabled) {
+        if (shared_state.duplex && !ring_state.active) {
+            // Nothing would drain the RX FIFO and the state machine would stall on autopush.
+            panic("duplex I2S needs audio_i2s_ring_connect");
+        }
+        if (ring_state.active) {
+            if (enabled) {
+                ring_reset();
+                ring_configure_channels();
+                ring_start_channels();
+            } else {
+                ring_stop_channels();
+            }
+        } else if (enabled) {
             audio_start_dma_transfer();
         } else {
             // if there was a buffer in flight, it will not be freed by DMA IRQ, let's do it manually
@@ -420,4 +987,20 @@ void audio_i2s_set_enabled(bool enabled) {
         audio_enabled = enabled;
     }
 }
+
+bool audio_i2s_set_sample_freq(uint32_t sample_freq) {
+    uint32_t divider = pio_divider(sample_freq);
+    if (!divider) {
+        return false;
+    }
+    if (!audio_enabled) {
+        shared_state.pending_divider = 0;
+        apply_pio_divider(divider, sample_freq);
+        return true;
+    }
+    shared_state.pending_freq = sample_freq;
+    __mem_fence_release();
+    shared_state.pending_divider = divider;
+    return true;
+}
 #endif
\ No newline at end of file
@@ -57,6 +57,11 @@ extern "C" {
 #endif
 #endif
 
+// Raise to 4 or 8 for TDM output; it sizes the ring storage, so stereo builds keep the default.
+#if PICO_AUDIO_I2S_MAX_CHANNELS != 2 && PICO_AUDIO_I2S_MAX_CHANNELS != 4 && PICO_AUDIO_I2S_MAX_CHANNELS != 8
+#error PICO_AUDIO_I2S_MAX_CHANNELS must be 2, 4 or 8
+#endif
+
 #ifndef PICO_AUDIO_I2S_BUFFERS_PER_CHANNEL
 #ifdef PICO_AUDIO_BUFFERS_PER_CHANNEL
 #define PICO_AUDIO_I2S_BUFFERS_PER_CHANNEL PICO_AUDIO_BUFFERS_PER_CHANNEL
@@ -81,6 +86,59 @@ extern "C" {
 #endif
 #endif
 
+// PICO_CONFIG: PICO_AUDIO_I2S_RING_SEGMENTS, Segments (and DMA channels) in ring playback mode, min=2, max=4, default=2, group=audio
+#ifndef PICO_AUDIO_I2S_RING_SEGMENTS
+#define PICO_AUDIO_I2S_RING_SEGMENTS 2u
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_I2S_RING_MAX_FRAMES, Largest ring segment in frames; a power of two, sizes the static ring, default=64, group=audio
+#ifndef PICO_AUDIO_I2S_RING_MAX_FRAMES
+#define PICO_AUDIO_I2S_RING_MAX_FRAMES 64u
+#endif
+
+#if PICO_AUDIO_I2S_RING_SEGMENTS < 2 || PICO_AUDIO_I2S_RING_SEGMENTS > 4
+#error PICO_AUDIO_I2S_RING_SEGMENTS must be 2, 3 or 4
+#endif
+
+#if PICO_AUDIO_I2S_RING_MAX_FRAMES & (PICO_AUDIO_I2S_RING_MAX_FRAMES - 1)
+#error PICO_AUDIO_I2S_RING_MAX_FRAMES must be a power of two
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_I2S_RING_INPUT, Reserve an input ring and DMA chain for audio_i2s_setup_duplex, type=bool, default=1, group=audio
+#ifndef PICO_AUDIO_I2S_RING_INPUT
+#define PICO_AUDIO_I2S_RING_INPUT 1
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_I2S_CONSUMER_BUFFERS, Buffers in the driver's static consumer pool; copying connections that need more fall back to the heap, min=1, default=2, group=audio
+#ifndef PICO_AUDIO_I2S_CONSUMER_BUFFERS
+#define PICO_AUDIO_I2S_CONSUMER_BUFFERS 2
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_I2S_CONSUMER_BUFFER_FRAMES, Frames per buffer in the driver's static consumer pool, default=256, group=audio
+#ifndef PICO_AUDIO_I2S_CONSUMER_BUFFER_FRAMES
+#define PICO_AUDIO_I2S_CONSUMER_BUFFER_FRAMES 256
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_I2S_BUFFER_PLACEMENT, Section attribute for the driver's consumer buffers and ring, such as __scratch_x("audio"); empty keeps them in .bss, group=audio
+#ifndef PICO_AUDIO_I2S_BUFFER_PLACEMENT
+#define PICO_AUDIO_I2S_BUFFER_PLACEMENT
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_I2S_IRQ_TIMING, Record the longest DMA IRQ handler run in cycles; takes over SysTick as a free-running counter, type=bool, default=0, group=audio
+#ifndef PICO_AUDIO_I2S_IRQ_TIMING
+#define PICO_AUDIO_I2S_IRQ_TIMING 0
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_I2S_STATS, Keep underrun counters, queue-depth histogram and DMA-start timestamps for audio_i2s_get_stats, type=bool, default=1, group=audio
+#ifndef PICO_AUDIO_I2S_STATS
+#define PICO_AUDIO_I2S_STATS 1
+#endif
+
+// PICO_CONFIG: PICO_AUDIO_I2S_STATS_DEPTH_BINS, Bins in the prepared-depth histogram; the last bin collects deeper queues, min=2, default=8, group=audio
+#ifndef PICO_AUDIO_I2S_STATS_DEPTH_BINS
+#define PICO_AUDIO_I2S_STATS_DEPTH_BINS 8
+#endif
+
 // Allow use of pico_audio driver without actually doing anything much
 #ifndef PICO_AUDIO_I2S_NOOP
 #ifdef PICO_AUDIO_NOOP
@@ -103,6 +161,7 @@ extern "C" {
 
 // The default order is CLOCK_PIN_BASE=LRCLK, CLOCK_PIN_BASE+1=BCLK
 // The swapped order is CLOCK_PIN_BASE=BCLK,  CLOCK_PIN_BASE+1=LRCLK
+// TDM output drives its frame sync on the LRCLK pin.
 #ifndef PICO_AUDIO_I2S_CLOCK_PINS_SWAPPED
 #define PICO_AUDIO_I2S_CLOCK_PINS_SWAPPED 0
 #endif
@@ -121,12 +180,31 @@ typedef struct audio_i2s_config {
 /** \brief Set up system to output I2S audio
  * \ingroup pico_audio_i2s
  *
+ * A channel_count of 4 or 8 selects TDM instead of I2S: S32 only, 32-bit slots, and a frame
+ * sync pulse one BCLK wide on the LRCLK pin, one bit ahead of slot 0. Buffers then hold one
+ * word per channel per frame (sample_stride 4 * channel_count), and
+ * PICO_AUDIO_I2S_MAX_CHANNELS must be at least channel_count.
+ *
  * \param intended_audio_format \todo
  * \param config The configuration to apply.
  */
 const audio_format_t *audio_i2s_setup(const audio_format_t *intended_audio_format,
                                                const audio_i2s_config_t *config);
 
+/** \brief Set up full-duplex I2S: output as audio_i2s_setup, plus ADC data in
+ * \ingroup pico_audio_i2s
+ *
+ * Loads the duplex PIO program, which shares BCLK and LRCLK and samples data_in_pin on every
+ * BCLK rising edge. Input is only delivered through the ring, so follow with
+ * audio_i2s_ring_connect() and read each block with audio_i2s_ring_input().
+ *
+ * \param intended_audio_format Stereo S16 or S32; input arrives in the same format
+ * \param config The configuration to apply
+ * \param data_in_pin GPIO carrying the ADC's serial data
+ */
+const audio_format_t *audio_i2s_setup_duplex(const audio_format_t *intended_audio_format,
+                                             const audio_i2s_config_t *config, uint data_in_pin);
+
 
 /** \brief \todo
  * \ingroup pico_audio_i2s
@@ -167,6 +245,20 @@ bool audio_i2s_connect_s8(audio_buffer_pool_t *producer);
 bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give, uint buffer_count,
                                  uint samples_per_buffer, audio_connection_t *connection);
 
+/** \brief Play a stereo producer at a different rate through a resampling connection
+ * \ingroup pico_audio_i2s
+ *
+ * The producer runs at connection->input_freq (its format's sample_freq must match) and the
+ * I2S clock at connection->output_freq, e.g. a DSP graph at 32 kHz for CPU headroom, or an
+ * externally clocked input stream trimmed with audio_resampling_connection_set_correction_ppm().
+ * Resampling happens as the DMA IRQ takes each buffer; see PICO_AUDIO_RESAMPLER_TAPS for cost.
+ *
+ * \param producer stereo S16 or S32 pool
+ * \param connection set up with audio_resampling_connection_init()
+ * \return true on success
+ */
+bool audio_i2s_connect_resampled(audio_buffer_pool_t *producer, audio_resampling_connection_t *connection);
+
 
 /** \brief Set up system to output I2S audio
  * \ingroup pico_audio_i2s
@@ -175,6 +267,117 @@ bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give,
  */
 void audio_i2s_set_enabled(bool enabled);
 
+/** \brief Change the output sample rate while audio is running
+ * \ingroup pico_audio_i2s
+ *
+ * The new PIO clock divider is applied by the DMA IRQ at the next transfer boundary (the next
+ * buffer, or the next ring segment), or immediately while audio is disabled. Nothing is
+ * resampled: the audio already queued plays at the new rate, so the caller should queue
+ * silence across the switch (rpdsp::SampleRateSwitch does this) and call this at most once per
+ * buffer. Buffers from a copying connection whose producer format has not changed keep the
+ * new rate.
+ *
+ * \param sample_freq new rate in Hz, e.g. 32000, 44100, 48000 or 96000
+ * \return false if the rate is outside the PIO clock divider's range for the loaded program
+ */
+bool audio_i2s_set_sample_freq(uint32_t sample_freq);
+
+/** \brief Play from a fixed ring of DMA segments instead of a buffer pool
+ * \ingroup pico_audio_i2s
+ *
+ * Use instead of audio_i2s_connect(), after audio_i2s_setup() and before
+ * audio_i2s_set_enabled(true). PICO_AUDIO_I2S_RING_SEGMENTS DMA channels (the configured
+ * channel plus unused ones claimed here) each own one segment and are chained in a circle,
+ * so the hardware moves from segment to segment with no CPU involvement. The DMA IRQ only
+ * counts finished segments and wakes the producer, which renders straight into the segment
+ * that just played. Latency is PICO_AUDIO_I2S_RING_SEGMENTS segments.
+ *
+ * \param format Stereo S16 or S32, or TDM S32; must match the format passed to audio_i2s_setup()
+ * \param frames_per_segment A power of two, at most PICO_AUDIO_I2S_RING_MAX_FRAMES
+ * \return false if the format or segment size is unsupported
+ */
+bool audio_i2s_ring_connect(const audio_format_t *format, uint frames_per_segment);
+
+/** \brief Get the next segment to render in ring mode
+ * \ingroup pico_audio_i2s
+ *
+ * Returns interleaved frames_per_segment frames: one packed L|R word per frame for S16, one
+ * word per channel for S32 (L, R) and TDM (slot 0 first). If the producer fell behind, the segments it missed have already
+ * played as silence and the next one after the playing segment is returned.
+ *
+ * \param block true to wait (WFE) for a segment to finish playing
+ * \return the segment, or NULL if none is free and block is false
+ */
+void *audio_i2s_ring_acquire(bool block);
+
+/** \brief Input captured for the segment from audio_i2s_ring_acquire()
+ * \ingroup pico_audio_i2s
+ *
+ * Only after audio_i2s_setup_duplex(), between acquire and release. The block lies in the
+ * input DMA ring itself (no copy), has the output segment's layout and length, and holds the
+ * frames that arrived while the output segment PICO_AUDIO_I2S_RING_SEGMENTS back was playing,
+ * so the round trip is a fixed PICO_AUDIO_I2S_RING_SEGMENTS segments.
+ *
+ * \return the input block, or NULL when not running duplex
+ */
+const void *audio_i2s_ring_input(void);
+
+/** \brief Hand the segment from audio_i2s_ring_acquire() back to the DMA ring
+ * \ingroup pico_audio_i2s
+ */
+void audio_i2s_ring_release(void);
+
+/** \brief Frames per ring segment, 0 if ring mode is not connected
+ * \ingroup pico_audio_i2s
+ */
+uint audio_i2s_ring_frames(void);
+
+/** \brief Segments that started playing before the producer released them
+ * \ingroup pico_audio_i2s
+ */
+uint32_t audio_i2s_ring_underruns(void);
+
+/** \brief Driver telemetry, updated by the DMA IRQ at every transfer start
+ * \ingroup pico_audio_i2s
+ *
+ * "Waiting" counts the rendered buffers (ring segments in ring mode) queued behind the one
+ * that just started. Output latency at a start is roughly (waiting + 1) buffers, so
+ * min_prepared_depth is the tightest margin seen and a silence insertion is a missed deadline.
+ */
+typedef struct audio_i2s_stats {
+    uint32_t transfers;                 ///< Transfers started, silence included
+    uint32_t silence_insertions;        ///< Transfers that played silence because nothing was ready
+    uint32_t min_prepared_depth;        ///< Fewest buffers waiting at a start; UINT32_MAX before the first
+    uint32_t last_start_us;             ///< time_us_32() at the latest start
+    uint32_t max_start_interval_us;     ///< Longest gap between consecutive starts
+    uint32_t depth_histogram[PICO_AUDIO_I2S_STATS_DEPTH_BINS]; ///< Starts by buffers waiting
+} audio_i2s_stats_t;
+
+/** \brief Copy a consistent snapshot of the driver telemetry
+ * \ingroup pico_audio_i2s
+ *
+ * Safe from the other core: the copy is retried if the IRQ updated it mid-way. Zeroes the
+ * snapshot when built with PICO_AUDIO_I2S_STATS=0.
+ */
+void audio_i2s_get_stats(audio_i2s_stats_t *out);
+
+/** \brief Clear the telemetry at the next transfer start
+ * \ingroup pico_audio_i2s
+ */
+void audio_i2s_reset_stats(void);
+
+/** \brief Longest DMA IRQ handler run seen, in processor cycles
+ * \ingroup pico_audio_i2s
+ *
+ * Always 0 unless built with PICO_AUDIO_I2S_IRQ_TIMING=1.
+ */
+uint32_t audio_i2s_irq_cycles_max(void);
+
+/** \brief Restart the worst-case IRQ measurement
+ * \ingroup pico_audio_i2s
+ */
+void audio_i2s_irq_cycles_reset(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -194,4 +194,281 @@ static inline void audio_i2s_32_program_init(PIO pio, uint sm, uint offset, uint
 }
 
 #endif
+
+// ------------------ //
+// audio_i2s_duplex //
+// ------------------ //
+
+#define audio_i2s_duplex_wrap_target 0
+#define audio_i2s_duplex_wrap 11
+
+#define audio_i2s_duplex_offset_entry_point 11u
+
+static const uint16_t audio_i2s_duplex_program_instructions[] = {
+            //     .wrap_target
+    0x7101, //  0: out    pins, 1         side 2 [1] 
+    0x5801, //  1: in     pins, 1         side 3     
+    0x1840, //  2: jmp    x--, 0          side 3     
+    0x6101, //  3: out    pins, 1         side 0 [1] 
+    0x4801, //  4: in     pins, 1         side 1     
+    0xe82e, //  5: set    x, 14           side 1     
+    0x6101, //  6: out    pins, 1         side 0 [1] 
+    0x4801, //  7: in     pins, 1         side 1     
+    0x0846, //  8: jmp    x--, 6          side 1     
+    0x7101, //  9: out    pins, 1         side 2 [1] 
+    0x5801, // 10: in     pins, 1         side 3     
+    0xf82e, // 11: set    x, 14           side 3     
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program audio_i2s_duplex_program = {
+    .instructions = audio_i2s_duplex_program_instructions,
+    .length = 12,
+    .origin = -1,
+};
+
+static inline pio_sm_config audio_i2s_duplex_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + audio_i2s_duplex_wrap_target, offset + audio_i2s_duplex_wrap);
+    sm_config_set_sideset(&c, 2, false, false);
+    return c;
+}
+#endif
+
+// -------------------------- //
+// audio_i2s_duplex_swapped //
+// -------------------------- //
+
+#define audio_i2s_duplex_swapped_wrap_target 0
+#define audio_i2s_duplex_swapped_wrap 11
+
+#define audio_i2s_duplex_swapped_offset_entry_point 11u
+
+static const uint16_t audio_i2s_duplex_swapped_program_instructions[] = {
+            //     .wrap_target
+    0x6901, //  0: out    pins, 1         side 1 [1] 
+    0x5801, //  1: in     pins, 1         side 3     
+    0x1840, //  2: jmp    x--, 0          side 3     
+    0x6101, //  3: out    pins, 1         side 0 [1] 
+    0x5001, //  4: in     pins, 1         side 2     
+    0xf02e, //  5: set    x, 14           side 2     
+    0x6101, //  6: out    pins, 1         side 0 [1] 
+    0x5001, //  7: in     pins, 1         side 2     
+    0x1046, //  8: jmp    x--, 6          side 2     
+    0x6901, //  9: out    pins, 1         side 1 [1] 
+    0x5801, // 10: in     pins, 1         side 3     
+    0xf82e, // 11: set    x, 14           side 3     
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program audio_i2s_duplex_swapped_program = {
+    .instructions = audio_i2s_duplex_swapped_program_instructions,
+    .length = 12,
+    .origin = -1,
+};
+
+static inline pio_sm_config audio_i2s_duplex_swapped_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + audio_i2s_duplex_swapped_wrap_target, offset + audio_i2s_duplex_swapped_wrap);
+    sm_config_set_sideset(&c, 2, false, false);
+    return c;
+}
+#endif
+
+// --------------------- //
+// audio_i2s_32_duplex //
+// --------------------- //
+
+#define audio_i2s_32_duplex_wrap_target 0
+#define audio_i2s_32_duplex_wrap 11
+
+#define audio_i2s_32_duplex_offset_entry_point 11u
+
+static const uint16_t audio_i2s_32_duplex_program_instructions[] = {
+            //     .wrap_target
+    0x7101, //  0: out    pins, 1         side 2 [1] 
+    0x5801, //  1: in     pins, 1         side 3     
+    0x1840, //  2: jmp    x--, 0          side 3     
+    0x6101, //  3: out    pins, 1         side 0 [1] 
+    0x4801, //  4: in     pins, 1         side 1     
+    0xe83e, //  5: set    x, 30           side 1     
+    0x6101, //  6: out    pins, 1         side 0 [1] 
+    0x4801, //  7: in     pins, 1         side 1     
+    0x0846, //  8: jmp    x--, 6          side 1     
+    0x7101, //  9: out    pins, 1         side 2 [1] 
+    0x5801, // 10: in     pins, 1         side 3     
+    0xf83e, // 11: set    x, 30           side 3     
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program audio_i2s_32_duplex_program = {
+    .instructions = audio_i2s_32_duplex_program_instructions,
+    .length = 12,
+    .origin = -1,
+};
+
+static inline pio_sm_config audio_i2s_32_duplex_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + audio_i2s_32_duplex_wrap_target, offset + audio_i2s_32_duplex_wrap);
+    sm_config_set_sideset(&c, 2, false, false);
+    return c;
+}
+#endif
+
+// ----------------------------- //
+// audio_i2s_32_duplex_swapped //
+// ----------------------------- //
+
+#define audio_i2s_32_duplex_swapped_wrap_target 0
+#define audio_i2s_32_duplex_swapped_wrap 11
+
+#define audio_i2s_32_duplex_swapped_offset_entry_point 11u
+
+static const uint16_t audio_i2s_32_duplex_swapped_program_instructions[] = {
+            //     .wrap_target
+    0x6901, //  0: out    pins, 1         side 1 [1] 
+    0x5801, //  1: in     pins, 1         side 3     
+    0x1840, //  2: jmp    x--, 0          side 3     
+    0x6101, //  3: out    pins, 1         side 0 [1] 
+    0x5001, //  4: in     pins, 1         side 2     
+    0xf03e, //  5: set    x, 30           side 2     
+    0x6101, //  6: out    pins, 1         side 0 [1] 
+    0x5001, //  7: in     pins, 1         side 2     
+    0x1046, //  8: jmp    x--, 6          side 2     
+    0x6901, //  9: out    pins, 1         side 1 [1] 
+    0x5801, // 10: in     pins, 1         side 3     
+    0xf83e, // 11: set    x, 30           side 3     
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program audio_i2s_32_duplex_swapped_program = {
+    .instructions = audio_i2s_32_duplex_swapped_program_instructions,
+    .length = 12,
+    .origin = -1,
+};
+
+static inline pio_sm_config audio_i2s_32_duplex_swapped_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + audio_i2s_32_duplex_swapped_wrap_target, offset + audio_i2s_32_duplex_swapped_wrap);
+    sm_config_set_sideset(&c, 2, false, false);
+    return c;
+}
+#endif
+
+#if !PICO_NO_HARDWARE
+// All four duplex variants share their wrap and entry point, so one init serves them all.
+static inline void audio_i2s_duplex_program_init(PIO pio, uint sm, uint offset, uint data_pin, uint data_in_pin, uint clock_pin_base) {
+    pio_sm_config sm_config = audio_i2s_duplex_program_get_default_config(offset);
+    sm_config_set_out_pins(&sm_config, data_pin, 1);
+    sm_config_set_in_pins(&sm_config, data_in_pin);
+    sm_config_set_sideset_pins(&sm_config, clock_pin_base);
+    sm_config_set_out_shift(&sm_config, false, true, 32);
+    sm_config_set_in_shift(&sm_config, false, true, 32);
+    pio_sm_init(pio, sm, offset, &sm_config);
+#if PICO_PIO_USE_GPIO_BASE
+    uint64_t pin_mask = (1ull << data_pin) | (3ull << clock_pin_base);
+    pio_sm_set_pindirs_with_mask64(pio, sm, pin_mask, pin_mask | (1ull << data_in_pin));
+#else
+    uint32_t pin_mask = (1u << data_pin) | (3u << clock_pin_base);
+    pio_sm_set_pindirs_with_mask(pio, sm, pin_mask, pin_mask | (1u << data_in_pin));
+#endif
+    pio_sm_set_pins(pio, sm, 0); // clear pins
+    pio_sm_exec(pio, sm, pio_encode_jmp(offset + audio_i2s_duplex_offset_entry_point));
+}
+#endif
+
+// --------- //
+// audio_tdm //
+// --------- //
+
+#define audio_tdm_wrap_target 0
+#define audio_tdm_wrap 3
+
+#define audio_tdm_offset_entry_point 3u
+
+static const uint16_t audio_tdm_program_instructions[] = {
+            //     .wrap_target
+    0x6001, //  0: out    pins, 1         side 0     
+    0x0840, //  1: jmp    x--, 0          side 1     
+    0x7001, //  2: out    pins, 1         side 2     
+    0xb822, //  3: mov    x, y            side 3     
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program audio_tdm_program = {
+    .instructions = audio_tdm_program_instructions,
+    .length = 4,
+    .origin = -1,
+};
+
+static inline pio_sm_config audio_tdm_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + audio_tdm_wrap_target, offset + audio_tdm_wrap);
+    sm_config_set_sideset(&c, 2, false, false);
+    return c;
+}
+#endif
+
+// ----------------- //
+// audio_tdm_swapped //
+// ----------------- //
+
+#define audio_tdm_swapped_wrap_target 0
+#define audio_tdm_swapped_wrap 3
+
+#define audio_tdm_swapped_offset_entry_point 3u
+
+static const uint16_t audio_tdm_swapped_program_instructions[] = {
+            //     .wrap_target
+    0x6001, //  0: out    pins, 1         side 0     
+    0x1040, //  1: jmp    x--, 0          side 2     
+    0x6801, //  2: out    pins, 1         side 1     
+    0xb822, //  3: mov    x, y            side 3     
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program audio_tdm_swapped_program = {
+    .instructions = audio_tdm_swapped_program_instructions,
+    .length = 4,
+    .origin = -1,
+};
+
+static inline pio_sm_config audio_tdm_swapped_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + audio_tdm_swapped_wrap_target, offset + audio_tdm_swapped_wrap);
+    sm_config_set_sideset(&c, 2, false, false);
+    return c;
+}
+
+// Both TDM variants share their wrap and entry point. Y is loaded through the FIFO before the
+// state machine runs, then the OSR is emptied so the first out autopulls real data.
+static inline void audio_tdm_program_init(PIO pio, uint sm, uint offset, uint data_pin, uint clock_pin_base, uint slots) {
+    pio_sm_config sm_config = audio_tdm_program_get_default_config(offset);
+    sm_config_set_out_pins(&sm_config, data_pin, 1);
+    sm_config_set_sideset_pins(&sm_config, clock_pin_base);
+    sm_config_set_out_shift(&sm_config, false, true, 32);
+    sm_config_set_fifo_join(&sm_config, PIO_FIFO_JOIN_TX);
+    pio_sm_init(pio, sm, offset, &sm_config);
+#if PICO_PIO_USE_GPIO_BASE
+    uint64_t pin_mask = (1ull << data_pin) | (3ull << clock_pin_base);
+    pio_sm_set_pindirs_with_mask64(pio, sm, pin_mask, pin_mask);
+#else
+    uint32_t pin_mask = (1u << data_pin) | (3u << clock_pin_base);
+    pio_sm_set_pindirs_with_mask(pio, sm, pin_mask, pin_mask);
+#endif
+    pio_sm_set_pins(pio, sm, 0); // clear pins
+    pio_sm_put(pio, sm, slots * 32u - 2u);
+    pio_sm_exec(pio, sm, pio_encode_pull(false, false));
+    pio_sm_exec(pio, sm, pio_encode_mov(pio_y, pio_osr));
+    pio_sm_exec(pio, sm, pio_encode_out(pio_null, 32));
+    pio_sm_exec(pio, sm, pio_encode_jmp(offset + audio_tdm_offset_entry_point));
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -75,6 +75,13 @@ inline static bool pico_buffer_alloc_in_place(mem_buffer_t *buffer, size_t size)
     return false;
 }
 
+// Static counterpart of pico_buffer_alloc_in_place: nothing to free, so flags stay clear.
+inline static void pico_buffer_wrap_in_place(mem_buffer_t *buffer, uint8_t *bytes, size_t size) {
+    buffer->bytes = bytes;
+    buffer->size = size;
+    buffer->flags = 0;
+}
+
 inline static mem_buffer_t *pico_buffer_wrap(uint8_t *bytes, size_t size) {
     mem_buffer_t *buffer = (mem_buffer_t *) malloc(sizeof(mem_buffer_t));
     if (buffer) {
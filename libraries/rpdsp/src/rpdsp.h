@@ -13,23 +13,37 @@
 #pragma once
 #include "rpdsp/algorithm.h"
 #include "rpdsp/analysis.h"
+#include "rpdsp/audio_arena.h"
+#include "rpdsp/beat_tracker.h"
+#include "rpdsp/block_cached_delay.h"
+#include "rpdsp/chroma.h"
 #include "rpdsp/clock_tracker.h"
 #include "rpdsp/config.h"
 #include "rpdsp/control_surface.h"
+#include "rpdsp/convolution.h"
+#include "rpdsp/crossover.h"
+#include "rpdsp/decimator.h"
 #include "rpdsp/delay_line.h"
 #include "rpdsp/dynamics.h"
 #include "rpdsp/effects.h"
 #include "rpdsp/envelope.h"
+#include "rpdsp/event_queue.h"
+#include "rpdsp/fft.h"
 #include "rpdsp/filter.h"
 #include "rpdsp/gate_pattern.h"
 #include "rpdsp/hypersaw.h"
 #include "rpdsp/joystick_recorder.h"
 #include "rpdsp/knob_bank.h"
 #include "rpdsp/ladder.h"
+#include "rpdsp/metering.h"
 #include "rpdsp/oscillator.h"
 #include "rpdsp/parameter_smoother.h"
 #include "rpdsp/pickup_knob.h"
 #include "rpdsp/realtime.h"
+#include "rpdsp/resampler.h"
 #include "rpdsp/rhythm_sequencer.h"
+#include "rpdsp/sample_format.h"
+#include "rpdsp/sample_rate_switch.h"
+#include "rpdsp/spectrum.h"
 #include "rpdsp/voice.h"
 #include "rpdsp/waveguide.h"
@@ -35,6 +35,14 @@ inline int32_t toInt24x32(float sample) {
   return static_cast<int32_t>(static_cast<uint32_t>(s) << 8);
 }
 
+// Convert a [-1, 1] float to a signed 16-bit sample, rounding to nearest. Rounding rather
+// than truncation matters at 16 bits: it keeps dither symmetric and avoids a dead zone at
+// zero. The +32768.5 bias makes the truncating conversion a floor, which SIMD paths share.
+inline int16_t toInt16(float sample) {
+  const float scaled = clamp(sample, -1.0f, 1.0f) * 32767.0f;
+  return static_cast<int16_t>(static_cast<int32_t>(scaled + 32768.5f) - 32768);
+}
+
 // Linear interpolation; pass a clamped t when overshoot is not desired.
 inline float lerp(float a, float b, float t) {
   return a + (b - a) * t;
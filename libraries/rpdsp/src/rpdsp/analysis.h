@@ -1,10 +1,12 @@
 #pragma once
 
 #include "algorithm.h"
+#include "fft.h"
 
 #include <array>
 #include <cmath>
 #include <cstddef>
+#include <cstring>
 
 namespace rpdsp {
 
@@ -55,6 +57,65 @@ class ZeroCrossingPitchDetector {
   bool hasLastSign_ = false;
 };
 
+struct YinEstimate {
+  float tau = 0.0f;  // refined lag in samples, 0 when nothing cleared the threshold
+  float value = 1.0f;
+};
+
+namespace yin_detail {
+
+// Parabolic sub-sample refinement around an integer minimum of the normalized difference.
+inline float parabolicTau(const float* difference, size_t tau, size_t minTau, size_t maxTau) {
+  if (tau <= minTau || tau >= maxTau) {
+    return static_cast<float>(tau);
+  }
+
+  const float left = difference[tau - 1];
+  const float center = difference[tau];
+  const float right = difference[tau + 1];
+  const float denominator = left - (2.0f * center) + right;
+  if (std::fabs(denominator) < 1.0e-12f) {
+    return static_cast<float>(tau);
+  }
+  // Sub-sample lag interpolation reduces pitch zippering between adjacent integer periods.
+  return static_cast<float>(tau) + 0.5f * (left - right) / denominator;
+}
+
+// Normalizes difference[1..maxTau] in place and picks the YIN period estimate.
+inline YinEstimate pick(float* difference, size_t minTau, size_t maxTau, float threshold) {
+  float runningSum = 0.0f;
+  // Cumulative mean normalization prevents short lags from winning only because they compare fewer samples.
+  for (size_t tau = 1; tau <= maxTau; ++tau) {
+    runningSum += difference[tau];
+    difference[tau] = runningSum > 0.0f ? difference[tau] * static_cast<float>(tau) / runningSum : 1.0f;
+  }
+
+  size_t estimateTau = 0;
+  float estimateValue = 1.0f;
+  for (size_t tau = minTau; tau <= maxTau; ++tau) {
+    if (difference[tau] < threshold) {
+      // Once below threshold, keep walking downhill to the local minimum for a cleaner estimate.
+      while (tau + 1 <= maxTau && difference[tau + 1] < difference[tau]) {
+        ++tau;
+      }
+      estimateTau = tau;
+      estimateValue = difference[tau];
+      break;
+    }
+    if (difference[tau] < estimateValue) {
+      estimateTau = tau;
+      estimateValue = difference[tau];
+    }
+  }
+
+  if (estimateTau == 0 || estimateValue >= threshold) {
+    return {};
+  }
+  return {parabolicTau(difference, estimateTau, minTau, maxTau), estimateValue};
+}
+
+}  // namespace yin_detail
+
 template <size_t WindowSize, size_t MaxTau>
 class YinPitchDetector {
  public:
@@ -137,65 +198,204 @@ class YinPitchDetector {
       difference_[tau] = sum;
     }
 
-    float runningSum = 0.0f;
-    // Cumulative mean normalization prevents short lags from winning only because they compare fewer samples.
-    for (size_t tau = 1; tau <= maxTau_; ++tau) {
-      runningSum += difference_[tau];
-      difference_[tau] = runningSum > 0.0f ? difference_[tau] * static_cast<float>(tau) / runningSum : 1.0f;
+    const YinEstimate estimate = yin_detail::pick(difference_.data(), minTau_, maxTau_, threshold_);
+    frequencyHz_ = estimate.tau > 0.0f ? sampleRate_ / estimate.tau : 0.0f;
+    confidence_ = clamp01(1.0f - estimate.value);
+    hasPitch_ = estimate.tau > 0.0f && frequencyHz_ >= minFrequencyHz_ && frequencyHz_ <= maxFrequencyHz_;
+    if (!hasPitch_) {
+      confidence_ = 0.0f;
+      frequencyHz_ = 0.0f;
     }
+  }
 
-    size_t estimateTau = 0;
-    float estimateValue = 1.0f;
-    for (size_t tau = minTau_; tau <= maxTau_; ++tau) {
-      if (difference_[tau] < threshold_) {
-        // Once below threshold, keep walking downhill to the local minimum for a cleaner estimate.
-        while (tau + 1 <= maxTau_ && difference_[tau + 1] < difference_[tau]) {
-          ++tau;
+  std::array<float, WindowSize> history_{};
+  std::array<float, MaxTau + 1> difference_{};
+  float sampleRate_ = kDefaultSampleRate;
+  float minFrequencyHz_ = 50.0f;
+  float maxFrequencyHz_ = 2000.0f;
+  float threshold_ = 0.15f;
+  float frequencyHz_ = 0.0f;
+  float confidence_ = 0.0f;
+  size_t minTau_ = 2;
+  size_t maxTau_ = MaxTau;
+  size_t updateIntervalSamples_ = kDefaultBlockSize * 4;
+  size_t samplesUntilAnalysis_ = kDefaultBlockSize * 4;
+  size_t writeIndex_ = 0;
+  size_t filled_ = 0;
+  bool hasPitch_ = false;
+};
+
+// YIN with a bounded per-block cost, for running on the audio core next to everything else.
+//
+// The history is written twice (at i and i + WindowSize) so the latest window is always one
+// contiguous span, and the difference function is rebuilt from an FFT autocorrelation:
+//   d(tau) = sum_{i < W-tau} x[i]^2 + sum_{i >= tau} x[i]^2 - 2 r(tau).
+// An analysis is a fixed sequence of analysisSteps() pieces (snapshot, RealFft<2W> steps,
+// power spectrum, inverse steps, pick); each block runs setStepsPerBlock() of them, so no
+// block pays for a whole analysis. Results lag the snapshot by
+// analysisSteps() / stepsPerBlock blocks.
+//
+// Memory: 4 * WindowSize floats (doubled history + FFT work) plus MaxTau + 1.
+template <size_t WindowSize, size_t MaxTau>
+class IncrementalYinPitchDetector {
+  static_assert(MaxTau >= 3, "MaxTau must leave room for interpolation");
+  static_assert(WindowSize > MaxTau + 1, "WindowSize must be larger than MaxTau");
+  static_assert((WindowSize & (WindowSize - 1)) == 0, "WindowSize must be a power of two");
+
+  // Zero-padding to 2W keeps lags up to MaxTau free of circular wrap-around.
+  using Fft = RealFft<2 * WindowSize>;
+
+  enum : size_t {
+    kSnapshotStep = 0,
+    kForwardFirst = 1,
+    kPowerStep = kForwardFirst + Fft::kSteps,
+    kInverseFirst = kPowerStep + 1,
+    kPickStep = kInverseFirst + Fft::kSteps,
+    kStepCount = kPickStep + 1,
+  };
+
+ public:
+  static constexpr size_t analysisSteps() { return kStepCount; }
+
+  void prepare(float sampleRate) {
+    sampleRate_ = sampleRate > 1.0f ? sampleRate : kDefaultSampleRate;
+    setFreqRange(minFrequencyHz_, maxFrequencyHz_);
+    reset();
+  }
+
+  void reset() {
+    history_.fill(0.0f);
+    work_.fill(0.0f);
+    difference_.fill(1.0f);
+    writeIndex_ = 0;
+    filled_ = 0;
+    samplesSinceSnapshot_ = 0;
+    blockPhase_ = 0;
+    step_ = kStepCount;
+    frequencyHz_ = 0.0f;
+    confidence_ = 0.0f;
+    hasPitch_ = false;
+  }
+
+  void setFreqRange(float minFrequencyHz, float maxFrequencyHz) {
+    minFrequencyHz_ = std::max(1.0f, minFrequencyHz);
+    maxFrequencyHz_ = std::max(minFrequencyHz_ + 1.0f, maxFrequencyHz);
+    const size_t minTau = static_cast<size_t>(std::ceil(sampleRate_ / maxFrequencyHz_));
+    const size_t maxTau = static_cast<size_t>(sampleRate_ / minFrequencyHz_);
+    minTau_ = std::max<size_t>(2, std::min(minTau, MaxTau - 2));
+    maxTau_ = std::max(minTau_ + 1, std::min<size_t>(maxTau, MaxTau));
+  }
+
+  void setThreshold(float threshold) { threshold_ = clamp(threshold, 0.02f, 0.95f); }
+
+  // Minimum spacing between snapshots; an analysis still in flight delays the next one.
+  void setUpdateIntervalSamples(size_t samples) { updateIntervalSamples_ = std::max<size_t>(1, samples); }
+
+  void setStepsPerBlock(size_t steps) { stepsPerBlock_ = std::min<size_t>(std::max<size_t>(1, steps), kStepCount); }
+
+  // Per-sample entry point: runs the block's step budget every kDefaultBlockSize samples.
+  void process(float sample) {
+    push(sample);
+    if (++blockPhase_ == kDefaultBlockSize) {
+      blockPhase_ = 0;
+      runSteps();
+    }
+  }
+
+  // Call once per audio block.
+  void process(const float* input, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+      push(input[i]);
+    }
+    runSteps();
+  }
+
+  [[nodiscard]] bool hasPitch() const { return hasPitch_; }
+
+  [[nodiscard]] float frequencyHz() const { return hasPitch_ ? frequencyHz_ : 0.0f; }
+
+  [[nodiscard]] float confidence() const { return confidence_; }
+
+ private:
+  void push(float sample) {
+    history_[writeIndex_] = sample;
+    history_[writeIndex_ + WindowSize] = sample;
+    writeIndex_ = (writeIndex_ + 1) & (WindowSize - 1);
+    filled_ = std::min(filled_ + 1, WindowSize);
+    ++samplesSinceSnapshot_;
+  }
+
+  void runSteps() {
+    for (size_t n = 0; n < stepsPerBlock_; ++n) {
+      if (step_ == kStepCount) {
+        if (filled_ < WindowSize || samplesSinceSnapshot_ < updateIntervalSamples_) {
+          return;
         }
-        estimateTau = tau;
-        estimateValue = difference_[tau];
-        break;
-      }
-      if (difference_[tau] < estimateValue) {
-        estimateTau = tau;
-        estimateValue = difference_[tau];
+        step_ = kSnapshotStep;
       }
+      runStep(step_);
+      ++step_;
     }
+  }
 
-    if (estimateTau == 0 || estimateValue >= threshold_) {
-      hasPitch_ = false;
-      confidence_ = 0.0f;
-      frequencyHz_ = 0.0f;
-      return;
+  void runStep(size_t step) {
+    if (step == kSnapshotStep) {
+      snapshot();
+    } else if (step < kPowerStep) {
+      Fft::forwardStep(work_.data(), step - kForwardFirst);
+    } else if (step == kPowerStep) {
+      // |X|^2 is the spectrum of the autocorrelation; the imaginary parts vanish.
+      work_[0] *= work_[0];
+      work_[1] *= work_[1];
+      for (size_t k = 2; k < 2 * WindowSize; k += 2) {
+        work_[k] = work_[k] * work_[k] + work_[k + 1] * work_[k + 1];
+        work_[k + 1] = 0.0f;
+      }
+    } else if (step < kPickStep) {
+      Fft::inverseStep(work_.data(), step - kInverseFirst);
+    } else {
+      pick();
     }
+  }
 
-    const float refinedTau = parabolicTau(estimateTau);
-    frequencyHz_ = refinedTau > 0.0f ? sampleRate_ / refinedTau : 0.0f;
-    confidence_ = clamp01(1.0f - estimateValue);
-    hasPitch_ = frequencyHz_ >= minFrequencyHz_ && frequencyHz_ <= maxFrequencyHz_;
-    if (!hasPitch_) {
-      confidence_ = 0.0f;
-      frequencyHz_ = 0.0f;
+  void snapshot() {
+    samplesSinceSnapshot_ = 0;
+    const float* window = history_.data() + writeIndex_;
+    std::memcpy(work_.data(), window, WindowSize * sizeof(float));
+    std::memset(work_.data() + WindowSize, 0, WindowSize * sizeof(float));
+
+    // Energy terms of d(tau) need the raw samples, which the FFT is about to overwrite.
+    float total = 0.0f;
+    for (size_t i = 0; i < WindowSize; ++i) {
+      total += window[i] * window[i];
+    }
+    float head = 0.0f;
+    float tail = 0.0f;
+    difference_[0] = 0.0f;
+    for (size_t tau = 1; tau <= maxTau_; ++tau) {
+      head += window[tau - 1] * window[tau - 1];
+      tail += window[WindowSize - tau] * window[WindowSize - tau];
+      difference_[tau] = 2.0f * total - head - tail;
     }
   }
 
-  [[nodiscard]] float parabolicTau(size_t tau) const {
-    if (tau <= minTau_ || tau >= maxTau_) {
-      return static_cast<float>(tau);
+  void pick() {
+    for (size_t tau = 1; tau <= maxTau_; ++tau) {
+      // Rounding can leave tiny negative values where the true difference is zero.
+      difference_[tau] = std::max(0.0f, difference_[tau] - 2.0f * work_[tau]);
     }
-
-    const float left = difference_[tau - 1];
-    const float center = difference_[tau];
-    const float right = difference_[tau + 1];
-    const float denominator = left - (2.0f * center) + right;
-    if (std::fabs(denominator) < 1.0e-12f) {
-      return static_cast<float>(tau);
+    const YinEstimate estimate = yin_detail::pick(difference_.data(), minTau_, maxTau_, threshold_);
+    frequencyHz_ = estimate.tau > 0.0f ? sampleRate_ / estimate.tau : 0.0f;
+    confidence_ = clamp01(1.0f - estimate.value);
+    hasPitch_ = estimate.tau > 0.0f && frequencyHz_ >= minFrequencyHz_ && frequencyHz_ <= maxFrequencyHz_;
+    if (!hasPitch_) {
+      confidence_ = 0.0f;
+      frequencyHz_ = 0.0f;
     }
-    // Sub-sample lag interpolation reduces pitch zippering between adjacent integer periods.
-    return static_cast<float>(tau) + 0.5f * (left - right) / denominator;
   }
 
-  std::array<float, WindowSize> history_{};
+  std::array<float, 2 * WindowSize> history_{};
+  std::array<float, 2 * WindowSize> work_{};
   std::array<float, MaxTau + 1> difference_{};
   float sampleRate_ = kDefaultSampleRate;
   float minFrequencyHz_ = 50.0f;
@@ -206,9 +406,12 @@ class YinPitchDetector {
   size_t minTau_ = 2;
   size_t maxTau_ = MaxTau;
   size_t updateIntervalSamples_ = kDefaultBlockSize * 4;
-  size_t samplesUntilAnalysis_ = kDefaultBlockSize * 4;
+  size_t stepsPerBlock_ = 1;
+  size_t samplesSinceSnapshot_ = 0;
   size_t writeIndex_ = 0;
   size_t filled_ = 0;
+  size_t blockPhase_ = 0;
+  size_t step_ = kStepCount;
   bool hasPitch_ = false;
 };
 
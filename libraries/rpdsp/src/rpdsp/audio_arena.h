@@ -0,0 +1,64 @@
+#pragma once
+
+#include "config.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef RPDSP_AUDIO_ARENA_BYTES
+#define RPDSP_AUDIO_ARENA_BYTES (64 * 1024)
+#endif
+
+namespace rpdsp {
+
+// Bump allocator over one fixed static block, for delay memory whose size is only known
+// per patch or per sample rate. Allocation happens in prepare(); nothing is ever freed
+// individually. reset() drops every buffer at once and is a control-side operation: stop
+// rendering the graph (or output silence), reset, re-prepare every module that took
+// arena memory, then resume. Never call allocate() or reset() from the audio callback.
+template <size_t Bytes>
+class AudioArena {
+  static_assert(Bytes > 0, "AudioArena needs storage");
+
+ public:
+  // Hands out count zeroed objects of T, or nullptr when the arena is exhausted.
+  template <typename T>
+  T* allocate(size_t count) {
+    const size_t align = alignof(T);
+    const size_t start = (used_ + align - 1) & ~(align - 1);
+    if (start > Bytes || count > (Bytes - start) / sizeof(T)) {
+      return nullptr;
+    }
+    used_ = start + count * sizeof(T);
+    // The arena only ever holds trivially-constructible sample types.
+    auto* items = reinterpret_cast<T*>(&storage_[start]);
+    for (size_t i = 0; i < count; ++i) {
+      items[i] = T{};
+    }
+    return items;
+  }
+
+  void reset() {
+    used_ = 0;
+    ++generation_;
+  }
+
+  [[nodiscard]] static constexpr size_t capacity() { return Bytes; }
+  [[nodiscard]] size_t used() const { return used_; }
+  [[nodiscard]] size_t remaining() const { return Bytes - used_; }
+  // Bumped by reset(); a view prepared under an older generation points at reused memory.
+  [[nodiscard]] std::uint32_t generation() const { return generation_; }
+  // Lets DelayLineView assert, in debug builds, that the arena was not reset under it.
+  [[nodiscard]] const std::uint32_t* generationCounter() const { return &generation_; }
+
+ private:
+  // 8-byte alignment covers float/int16 sample types and RP2350 DMA word transfers.
+  alignas(8) unsigned char storage_[Bytes] = {};
+  size_t used_ = 0;
+  std::uint32_t generation_ = 0;
+};
+
+// The sketch-wide arena size is a compile-time flag so it shows up in the link map.
+using DefaultAudioArena = AudioArena<RPDSP_AUDIO_ARENA_BYTES>;
+
+}  // namespace rpdsp
@@ -0,0 +1,428 @@
+#pragma once
+
+#include "algorithm.h"
+#include "clock_tracker.h"
+#include "realtime.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace rpdsp {
+
+// Onset novelty from STFT frames: power is summed into Bands log-spaced bands, compressed
+// with log(1 + gain * power), and the positive band-wise increase over the previous frame is
+// summed (band-limited spectral flux). Onsets are novelty peaks above a running mean plus a
+// margin, with a refractory gap. Per frame: one pass over N/2 bins plus Bands logs.
+template <size_t N, size_t Bands = 24>
+class SpectralFluxOnsetDetector {
+  static_assert(Bands >= 4, "SpectralFluxOnsetDetector needs a few bands");
+  static_assert(Bands < N / 2, "SpectralFluxOnsetDetector needs more bins than bands");
+
+ public:
+  // analysisRate is the rate of the samples the frames were built from; hop in samples.
+  void prepare(float analysisRate, size_t hop, float minFrequencyHz = 60.0f, float maxFrequencyHz = 8000.0f) {
+    analysisRate_ = safeSampleRate(analysisRate);
+    frameRate_ = analysisRate_ / static_cast<float>(hop > 0 ? hop : 1);
+    const float binHz = analysisRate_ / static_cast<float>(N);
+    const float low = std::max(minFrequencyHz, binHz);
+    const float high = std::max(low * 2.0f, std::min(maxFrequencyHz, 0.5f * analysisRate_ - binHz));
+    for (size_t band = 0; band <= Bands; ++band) {
+      const float hz = low * std::pow(high / low, static_cast<float>(band) / static_cast<float>(Bands));
+      bandEdge_[band] = std::min(N / 2, static_cast<size_t>(hz / binHz));
+    }
+    for (size_t band = 1; band <= Bands; ++band) {
+      // Low bands can collapse onto one bin; keep every band at least one bin wide, but never
+      // past the last bin process() may read. With many bands for N the top ones end up empty.
+      bandEdge_[band] = std::min(N / 2, std::max(bandEdge_[band], bandEdge_[band - 1] + 1));
+    }
+    refractoryFrames_ = static_cast<size_t>(0.06f * frameRate_) + 1;
+    reset();
+  }
+
+  void reset() {
+    previous_.fill(0.0f);
+    novelty_ = 0.0f;
+    mean_ = 0.0f;
+    framesSinceOnset_ = refractoryFrames_;
+    onset_ = false;
+    primed_ = false;
+  }
+
+  // Onsets need novelty above mean * ratio + margin.
+  void setThreshold(float ratio, float margin) {
+    ratio_ = std::max(1.0f, ratio);
+    margin_ = std::max(0.0f, margin);
+  }
+
+  [[nodiscard]] float frameRate() const { return frameRate_; }
+
+  // packed is a RealFft<N> forward() result. Returns this frame's novelty.
+  float process(const float* packed) {
+    float flux = 0.0f;
+    for (size_t band = 0; band < Bands; ++band) {
+      float power = 0.0f;
+      for (size_t k = bandEdge_[band]; k < bandEdge_[band + 1]; ++k) {
+        power += packed[2 * k] * packed[2 * k] + packed[2 * k + 1] * packed[2 * k + 1];
+      }
+      const float level = std::log(1.0f + kCompression * power);
+      flux += std::max(0.0f, level - previous_[band]);
+      previous_[band] = level;
+    }
+    // The first frame compares against silence and would always fire.
+    novelty_ = primed_ ? flux : 0.0f;
+    primed_ = true;
+
+    const float threshold = mean_ * ratio_ + margin_;
+    ++framesSinceOnset_;
+    onset_ = novelty_ > threshold && framesSinceOnset_ >= refractoryFrames_;
+    if (onset_) {
+      framesSinceOnset_ = 0;
+    }
+    // ~0.5 s running mean of novelty, so the threshold adapts to the material.
+    mean_ += (novelty_ - mean_) * std::min(1.0f, 2.0f / frameRate_);
+    return novelty_;
+  }
+
+  [[nodiscard]] float novelty() const { return novelty_; }
+  [[nodiscard]] bool onset() const { return onset_; }
+
+ private:
+  static constexpr float kCompression = 1.0f;
+
+  std::array<size_t, Bands + 1> bandEdge_{};
+  std::array<float, Bands> previous_{};
+  float analysisRate_ = kDefaultSampleRate;
+  float frameRate_ = kDefaultSampleRate / static_cast<float>(N / 2);
+  float novelty_ = 0.0f;
+  float mean_ = 0.0f;
+  float ratio_ = 1.5f;
+  float margin_ = 0.5f;
+  size_t refractoryFrames_ = 1;
+  size_t framesSinceOnset_ = 0;
+  bool onset_ = false;
+  bool primed_ = false;
+};
+
+// What the control core publishes for the audio core: the tempo and one beat instant,
+// in the audio core's own sample count, from which every other beat can be projected.
+struct TempoEstimate {
+  float bpm = 0.0f;
+  float samplesPerBeat = 0.0f;
+  float confidence = 0.0f;
+  std::uint32_t beatSample = 0;
+};
+static_assert(std::is_trivially_copyable_v<TempoEstimate>, "TempoEstimate is published through a Seqlock");
+
+// Tempo and beat phase from an onset novelty stream at a fixed frame rate.
+//
+// Tempo: a leaky autocorrelation of novelty over the lags for minBpm..maxBpm, updated with one
+// multiply-add per lag per frame (no periodic full recompute), weighted by a log-normal prior
+// around 120 BPM to settle octave ambiguity, refined by parabolic interpolation.
+// Phase: a beat grid advanced by the period each frame and pulled toward detected onsets that
+// land within a quarter period of a predicted beat. Novelty is also folded onto the grid's phase
+// (~4 s memory); when it piles up away from the beat, the grid seeded on an off-beat or slipped
+// while the tempo settled, and it moves to where the energy is.
+template <size_t MaxLag = 128>
+class TempoTracker {
+  static constexpr size_t kHistory = MaxLag + 1;
+  static constexpr size_t kPhaseBins = 16;
+
+ public:
+  void prepare(float frameRate, float minBpm = 60.0f, float maxBpm = 180.0f) {
+    frameRate_ = frameRate > 1.0f ? frameRate : 100.0f;
+    minLag_ = std::max<size_t>(2, static_cast<size_t>(std::floor(frameRate_ * 60.0f / std::max(minBpm + 1.0f, maxBpm))));
+    maxLag_ = std::min<size_t>(MaxLag - 1, static_cast<size_t>(std::ceil(frameRate_ * 60.0f / std::max(1.0f, minBpm))));
+    minLag_ = std::min(minLag_, maxLag_ - 1);
+    for (size_t lag = 0; lag < MaxLag; ++lag) {
+      const float bpm = lag > 0 ? 60.0f * frameRate_ / static_cast<float>(lag) : 0.0f;
+      const float octaves = lag > 0 ? std::log2(bpm / 120.0f) : 0.0f;
+      prior_[lag] = std::exp(-0.5f * (octaves / 0.9f) * (octaves / 0.9f));
+    }
+    // ~4 s memory: long enough to average a few bars, short enough to follow tempo changes.
+    decay_ = std::exp(-1.0f / (4.0f * frameRate_));
+    reset();
+  }
+
+  void reset() {
+    history_.fill(0.0f);
+    correlation_.fill(0.0f);
+    energy_ = 0.0f;
+    position_ = 0;
+    periodFrames_ = 0.0f;
+    confidence_ = 0.0f;
+    sinceBeat_ = 0.0f;
+    phaseEnergy_.fill(0.0f);
+    haveBeat_ = false;
+  }
+
+  void setPhaseGain(float gain) { phaseGain_ = clamp(gain, 0.0f, 1.0f); }
+
+  // One frame of novelty; onset marks a detected onset in this frame.
+  void process(float novelty, bool onset) {
+    history_[position_] = novelty;
+    history_[position_ + kHistory] = novelty;
+    const float* recent = history_.data() + position_ + kHistory;  // recent[-lag] = novelty lag frames ago
+    for (size_t lag = minLag_ - 1; lag <= maxLag_ + 1; ++lag) {
+      correlation_[lag] = decay_ * correlation_[lag] + novelty * recent[-static_cast<std::ptrdiff_t>(lag)];
+    }
+    energy_ = decay_ * energy_ + novelty * novelty;
+    position_ = position_ + 1 == kHistory ? 0 : position_ + 1;
+
+    updateTempo();
+    updatePhase(novelty, onset);
+  }
+
+  [[nodiscard]] float bpm() const { return periodFrames_ > 0.0f ? 60.0f * frameRate_ / periodFrames_ : 0.0f; }
+  [[nodiscard]] float periodFrames() const { return periodFrames_; }
+  [[nodiscard]] float confidence() const { return confidence_; }
+  // Frames (fractional) from the most recent beat on the tracked grid to the current frame.
+  [[nodiscard]] float framesSinceBeat() const { return sinceBeat_; }
+  [[nodiscard]] bool hasBeat() const { return haveBeat_ && periodFrames_ > 0.0f; }
+
+ private:
+  void updateTempo() {
+    size_t best = 0;
+    float bestScore = 0.0f;
+    for (size_t lag = minLag_; lag <= maxLag_; ++lag) {
+      // A fractional period splits its peak over two integer lags; score with the neighbours.
+      const float smoothed = 0.5f * (correlation_[lag - 1] + correlation_[lag + 1]) + correlation_[lag];
+      const float score = smoothed * prior_[lag];
+      if (score > bestScore) {
+        bestScore = score;
+        best = lag;
+      }
+    }
+    if (best == 0 || energy_ <= 0.0f) {
+      confidence_ = 0.0f;
+      return;
+    }
+    float period = static_cast<float>(best);
+    const float left = correlation_[best - 1];
+    const float center = correlation_[best];
+    const float right = correlation_[best + 1];
+    const float denominator = left - 2.0f * center + right;
+    if (best > minLag_ && best < maxLag_ && std::fabs(denominator) > 1.0e-12f) {
+      period += clamp(0.5f * (left - right) / denominator, -0.5f, 0.5f);
+    }
+    periodFrames_ = period;
+    confidence_ = clamp01(center / energy_);
+  }
+
+  void updatePhase(float novelty, bool onset) {
+    if (periodFrames_ <= 0.0f) {
+      return;
+    }
+    if (!haveBeat_) {
+      if (onset) {
+        sinceBeat_ = 0.0f;
+        haveBeat_ = true;
+      }
+      return;
+    }
+    // Kept relative to the current frame so precision does not decay over a long session.
+    sinceBeat_ += 1.0f;
+    while (sinceBeat_ >= periodFrames_) {
+      sinceBeat_ -= periodFrames_;
+    }
+    relocateBeat(novelty);
+    if (onset) {
+      // Pull the grid toward onsets near a predicted beat; off-beat onsets are ignored.
+      const float toLast = sinceBeat_;
+      const float toNext = sinceBeat_ - periodFrames_;
+      const float error = std::fabs(toLast) < std::fabs(toNext) ? toLast : toNext;
+      if (std::fabs(error) < 0.25f * periodFrames_) {
+        sinceBeat_ -= phaseGain_ * error;
+      }
+    }
+  }
+
+  void relocateBeat(float novelty) {
+    const size_t bin = std::min(kPhaseBins - 1, static_cast<size_t>(sinceBeat_ / periodFrames_ * kPhaseBins));
+    for (float& energy : phaseEnergy_) {
+      energy *= decay_;
+    }
+    phaseEnergy_[bin] += novelty;
+
+    // Energy within one bin either side of each phase; the beat bin is 0.
+    size_t best = 0;
+    float bestEnergy = 0.0f;
+    float beatEnergy = 0.0f;
+    for (size_t i = 0; i < kPhaseBins; ++i) {
+      const float energy = phaseEnergy_[(i + kPhaseBins - 1) % kPhaseBins] + phaseEnergy_[i] +
+                           phaseEnergy_[(i + 1) % kPhaseBins];
+      if (i == 0) {
+        beatEnergy = energy;
+      }
+      if (energy > bestEnergy) {
+        bestEnergy = energy;
+        best = i;
+      }
+    }
+    // Outside the onset pull's quarter-period reach, and clearly stronger than the beat.
+    if (best <= kPhaseBins / 4 || best >= kPhaseBins - kPhaseBins / 4 || bestEnergy < 1.5f * beatEnergy) {
+      return;
+    }
+    sinceBeat_ -= static_cast<float>(best) * periodFrames_ / kPhaseBins;
+    if (sinceBeat_ < 0.0f) {
+      sinceBeat_ += periodFrames_;
+    }
+    std::rotate(phaseEnergy_.begin(), phaseEnergy_.begin() + static_cast<std::ptrdiff_t>(best), phaseEnergy_.end());
+  }
+
+  std::array<float, 2 * kHistory> history_{};
+  std::array<float, MaxLag + 1> correlation_{};
+  std::array<float, MaxLag> prior_{};
+  std::array<float, kPhaseBins> phaseEnergy_{};
+  float frameRate_ = 100.0f;
+  float decay_ = 0.99f;
+  float energy_ = 0.0f;
+  float phaseGain_ = 0.25f;
+  float periodFrames_ = 0.0f;
+  float confidence_ = 0.0f;
+  float sinceBeat_ = 0.0f;
+  size_t minLag_ = 2;
+  size_t maxLag_ = MaxLag - 1;
+  size_t position_ = 0;
+  bool haveBeat_ = false;
+};
+
+// Control-core half of audio beat tracking: onset detection and tempo tracking on STFT
+// frames, publishing a TempoEstimate through a Seqlock after every frame. Per frame: one pass
+// over N/2 bins, Bands logs and ~2 * MaxLag multiply-adds, on top of the frame's FFT.
+template <size_t N, size_t Hop, size_t MaxLag = 128>
+class BeatTracker {
+ public:
+  // analysisRate is the STFT input rate; inputSamplesPerAnalysisSample is the decimation
+  // factor between the audio core's sample count and the frames (1 when undecimated), and
+  // inputLatencySamples the decimator's group delay in input samples
+  // (Decimator<Factor>::kLatencySamples), which is taken off every published beat.
+  void prepare(float analysisRate, size_t inputSamplesPerAnalysisSample = 1, size_t inputLatencySamples = 0,
+               float minBpm = 60.0f, float maxBpm = 180.0f) {
+    onsets_.prepare(analysisRate, Hop);
+    tempo_.prepare(onsets_.frameRate(), minBpm, maxBpm);
+    inputPerAnalysis_ = inputSamplesPerAnalysisSample > 0 ? inputSamplesPerAnalysisSample : 1;
+    inputLatency_ = static_cast<std::uint32_t>(inputLatencySamples);
+    reset();
+  }
+
+  void reset() {
+    onsets_.reset();
+    tempo_.reset();
+    published_.store(TempoEstimate{});
+  }
+
+  SpectralFluxOnsetDetector<N>& onsets() { return onsets_; }
+  TempoTracker<MaxLag>& tempo() { return tempo_; }
+
+  // frameEnd is StftFrameBuilder::lastFrameEnd() for this frame.
+  void process(const float* packed, std::uint32_t frameEnd) {
+    onsets_.process(packed);
+    tempo_.process(onsets_.novelty(), onsets_.onset());
+    if (!tempo_.hasBeat()) {
+      return;
+    }
+
+    // A frame is centred N/2 samples before its end; frames are Hop apart. Wrapping uint32
+    // arithmetic keeps this exact however long the session runs.
+    const std::uint32_t beatAnalysis =
+        frameEnd - static_cast<std::uint32_t>(N / 2) -
+        static_cast<std::uint32_t>(std::lround(tempo_.framesSinceBeat() * static_cast<float>(Hop)));
+    TempoEstimate estimate;
+    estimate.bpm = tempo_.bpm();
+    estimate.samplesPerBeat = tempo_.periodFrames() * static_cast<float>(Hop * inputPerAnalysis_);
+    estimate.confidence = tempo_.confidence();
+    // A decimated onset reaches the frames late by the decimator's group delay.
+    estimate.beatSample = beatAnalysis * static_cast<std::uint32_t>(inputPerAnalysis_) - inputLatency_;
+    published_.store(estimate);
+  }
+
+  [[nodiscard]] const Seqlock<TempoEstimate>& published() const { return published_; }
+
+ private:
+  SpectralFluxOnsetDetector<N> onsets_;
+  TempoTracker<MaxLag> tempo_;
+  Seqlock<TempoEstimate> published_;
+  size_t inputPerAnalysis_ = 1;
+  std::uint32_t inputLatency_ = 0;
+};
+
+// Audio-core half: runs a ClockTracker's ticks from the published tempo and snaps them to the
+// projected beat grid. One Seqlock read per block; ticks advance sample-accurately.
+class BeatClockSync {
+ public:
+  void reset() {
+    sampleCount_ = 0;
+    tickAccumulator_ = 0.0f;
+    lastVersion_ = 0;
+    estimate_ = TempoEstimate{};
+  }
+
+  // Estimates below this confidence leave the clock free-running at its current tempo.
+  void setMinimumConfidence(float confidence) { minimumConfidence_ = clamp01(confidence); }
+
+  // Advances clock by frames samples; returns the number of ticks advanced. A snap back onto
+  // the beat takes back this block's ticks but never reports fewer than zero.
+  int process(const Seqlock<TempoEstimate>& tempo, ClockTracker& clock, size_t frames) {
+    const std::uint32_t version = tempo.version();
+    if (version != lastVersion_) {
+      TempoEstimate fresh;
+      // A store in flight just means this block keeps the previous estimate.
+      if (tempo.tryLoad(fresh)) {
+        estimate_ = fresh;
+        lastVersion_ = version;
+      }
+    }
+    const bool follow = estimate_.confidence >= minimumConfidence_ && estimate_.samplesPerBeat > 1.0f;
+    if (follow && std::fabs(estimate_.bpm - clock.bpm()) > 0.01f) {
+      clock.setBpm(estimate_.bpm);
+    }
+
+    std::int32_t untilBeat = -1;
+    if (follow) {
+      // Project the published beat forward to the first beat at or after this block.
+      const float since = static_cast<float>(static_cast<std::int32_t>(sampleCount_ - estimate_.beatSample));
+      const float beats = std::ceil(since / estimate_.samplesPerBeat);
+      untilBeat = static_cast<std::int32_t>(std::lround(beats * estimate_.samplesPerBeat - since));
+    }
+
+    int ticks = 0;
+    const float samplesPerTick = clock.samplesPerTick();
+    size_t done = 0;
+    while (done < frames) {
+      size_t segment = frames - done;
+      bool beat = false;
+      if (untilBeat >= 0 && static_cast<size_t>(untilBeat) >= done && static_cast<size_t>(untilBeat) - done < segment) {
+        segment = static_cast<size_t>(untilBeat) - done;
+        beat = true;
+      }
+      tickAccumulator_ += static_cast<float>(segment);
+      while (samplesPerTick > 0.0f && tickAccumulator_ >= samplesPerTick) {
+        tickAccumulator_ -= samplesPerTick;
+        clock.advanceTick();
+        ++ticks;
+      }
+      done += segment;
+      if (beat) {
+        ticks = std::max(0, ticks + clock.alignToBeat());
+        tickAccumulator_ = 0.0f;
+        untilBeat = -1;
+      }
+    }
+    sampleCount_ += static_cast<std::uint32_t>(frames);
+    return ticks;
+  }
+
+  // Samples seen so far; must match the count the control side timestamps frames with.
+  [[nodiscard]] std::uint32_t sampleCount() const { return sampleCount_; }
+
+ private:
+  TempoEstimate estimate_;
+  float minimumConfidence_ = 0.2f;
+  float tickAccumulator_ = 0.0f;
+  std::uint32_t sampleCount_ = 0;
+  std::uint32_t lastVersion_ = 0;
+};
+
+}  // namespace rpdsp
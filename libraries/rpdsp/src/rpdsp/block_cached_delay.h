@@ -0,0 +1,256 @@
+#pragma once
+
+#include "algorithm.h"
+#include "realtime.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace rpdsp {
+
+// Bulk storage for BlockCachedDelay: any memory-mapped float region. On RP2350 this is
+// typically a buffer in the QSPI PSRAM window; on the host, a malloc'd or static array.
+// Only BlockCachedDelay::service() touches it, never the audio callback.
+class MemoryRegionBacking {
+ public:
+  MemoryRegionBacking() = default;
+  MemoryRegionBacking(float* base, size_t samples) : base_(base), samples_(samples) {}
+
+  [[nodiscard]] size_t size() const { return samples_; }
+  void read(size_t offset, float* destination, size_t count) const {
+    std::memcpy(destination, base_ + offset, count * sizeof(float));
+  }
+  void write(size_t offset, const float* source, size_t count) {
+    std::memcpy(base_ + offset, source, count * sizeof(float));
+  }
+
+ private:
+  float* base_ = nullptr;
+  size_t samples_ = 0;
+};
+
+// Multi-second delay / looper whose history lives in slow bulk memory. The audio side only
+// touches two small SRAM rings: finished write blocks wait in the write-behind ring until
+// service() copies them out, and service() prefetches the blocks the read head will need
+// into the read-ahead ring. Handoff is single-producer/single-consumer per ring through
+// atomic block counters, so neither side ever waits for the other.
+//
+// Core split: process() runs in the audio callback; service() runs on the control core
+// (or any context that may block on slow memory), at least once per BlockSize samples.
+// If service() falls behind, the audio side outputs silence for unfetched blocks and
+// drops writes that have no free slot (those blocks replay as silence), counting both,
+// rather than stalling.
+//
+// Delays are whole samples between minDelaySamples() and maxDelaySamples(). With feedback
+// at 1 and input gain at 0 the delay replays its buffer forever, which is a looper.
+template <size_t BlockSize = 256, size_t CacheBlocks = 4, typename Backing = MemoryRegionBacking>
+class BlockCachedDelay {
+  static_assert(BlockSize >= 16, "BlockCachedDelay blocks should amortize a bulk transfer");
+  static_assert(CacheBlocks >= 2, "BlockCachedDelay needs at least double buffering");
+
+ public:
+  // Control side, before audio starts: binds and clears the bulk store.
+  void prepare(float sampleRate, const Backing& backing) {
+    sampleRate_ = safeSampleRate(sampleRate);
+    backing_ = backing;
+    backingBlocks_ = backing_.size() / BlockSize;
+    std::array<float, BlockSize> silence{};
+    for (size_t block = 0; block < backingBlocks_; ++block) {
+      backing_.write(block * BlockSize, silence.data(), BlockSize);
+    }
+    reset();
+    setDelaySamples(delaySamples_);
+  }
+
+  // Control side, with the audio graph stopped.
+  void reset() {
+    for (auto& block : writeRing_) {
+      block.fill(0.0f);
+    }
+    for (auto& block : readRing_) {
+      block.fill(0.0f);
+    }
+    for (auto& tag : readTags_) {
+      tag.store(0, std::memory_order_relaxed);
+    }
+    for (auto& tag : writeTags_) {
+      tag.store(0, std::memory_order_relaxed);
+    }
+    writeBlock_ = 0;
+    writeOffset_ = 0;
+    writeSlotFree_ = true;
+    primed_ = false;
+    publishedCursor_ = 0;
+    writtenBlocks_.store(0, std::memory_order_relaxed);
+    flushedBlocks_.store(0, std::memory_order_relaxed);
+    readCursor_.store(0, std::memory_order_relaxed);
+    underruns_ = 0;
+    overruns_ = 0;
+  }
+
+  [[nodiscard]] static constexpr size_t minDelaySamples() { return (CacheBlocks + 1) * BlockSize; }
+  [[nodiscard]] size_t maxDelaySamples() const {
+    // Keep a cache's worth of blocks between the oldest read and the next overwrite.
+    return backingBlocks_ > 2 * CacheBlocks + 1 ? (backingBlocks_ - CacheBlocks - 1) * BlockSize : minDelaySamples();
+  }
+
+  // Jumps the read head; expect a short dropout while the new blocks are fetched.
+  void setDelaySamples(size_t samples) {
+    delaySamples_ = samples < minDelaySamples() ? minDelaySamples() : samples;
+    if (delaySamples_ > maxDelaySamples()) {
+      delaySamples_ = maxDelaySamples();
+    }
+    delayBlocks_ = static_cast<std::uint32_t>(delaySamples_ / BlockSize);
+    delayOffset_ = delaySamples_ % BlockSize;
+  }
+  void setDelaySeconds(float seconds) { setDelaySamples(static_cast<size_t>(std::max(0.0f, seconds) * sampleRate_)); }
+  // Up to 1 so a full-feedback loop can sustain indefinitely.
+  void setFeedback(float feedback) { feedback_ = clamp(feedback, -1.0f, 1.0f); }
+  // 0 stops recording into the loop; 1 records/overdubs the input.
+  void setInputGain(float gain) { inputGain_ = clamp01(gain); }
+  void setMix(float mix) { mix_ = clamp01(mix); }
+
+  [[nodiscard]] size_t delaySamples() const { return delaySamples_; }
+
+  float process(float input) {
+    const float delayed = readDelayed();
+    writeSample(input * inputGain_ + delayed * feedback_);
+    return lerp(input, delayed, mix_);
+  }
+
+  void process(const float* input, float* output, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+      output[i] = process(input[i]);
+    }
+  }
+
+  // Control side: flushes finished write blocks, then fills the read-ahead ring. Returns
+  // the number of bulk transfers done; maxTransfers bounds the time spent per call.
+  size_t service(size_t maxTransfers = static_cast<size_t>(-1)) {
+    size_t transfers = 0;
+    const std::uint32_t written = writtenBlocks_.load(std::memory_order_acquire);
+    std::uint32_t flushed = flushedBlocks_.load(std::memory_order_relaxed);
+    while (flushed != written && transfers < maxTransfers) {
+      auto& slot = writeRing_[flushed % CacheBlocks];
+      if (writeTags_[flushed % CacheBlocks].load(std::memory_order_acquire) != flushed + 1) {
+        // The audio side dropped this block (overrun); the slot still holds an older block.
+        slot.fill(0.0f);
+      }
+      backing_.write(backingOffset(flushed), slot.data(), BlockSize);
+      ++flushed;
+      flushedBlocks_.store(flushed, std::memory_order_release);
+      ++transfers;
+    }
+
+    const std::uint32_t cursor = readCursor_.load(std::memory_order_acquire);
+    for (std::uint32_t ahead = 0; ahead < CacheBlocks && transfers < maxTransfers; ++ahead) {
+      const std::uint32_t block = cursor + ahead;
+      // Blocks still in the write-behind ring are not in bulk memory yet.
+      if (static_cast<std::int32_t>(block - flushed) >= 0) {
+        break;
+      }
+      auto& tag = readTags_[block % CacheBlocks];
+      if (tag.load(std::memory_order_relaxed) == block + 1) {
+        continue;
+      }
+      tag.store(0, std::memory_order_release);
+      backing_.read(backingOffset(block), readRing_[block % CacheBlocks].data(), BlockSize);
+      tag.store(block + 1, std::memory_order_release);
+      ++transfers;
+    }
+    return transfers;
+  }
+
+  // Deadline misses seen by the audio side; read them from non-realtime code.
+  [[nodiscard]] std::uint32_t underruns() const { return underruns_; }
+  [[nodiscard]] std::uint32_t overruns() const { return overruns_; }
+
+ private:
+  [[nodiscard]] size_t backingOffset(std::uint32_t block) const {
+    return backingBlocks_ > 0 ? (block % backingBlocks_) * BlockSize : 0;
+  }
+
+  float readDelayed() {
+    std::uint32_t block = writeBlock_ - delayBlocks_;
+    size_t offset = writeOffset_;
+    if (offset < delayOffset_) {
+      offset += BlockSize;
+      --block;
+    }
+    offset -= delayOffset_;
+    if (block != publishedCursor_) {
+      publishedCursor_ = block;
+      readCursor_.store(block, std::memory_order_release);
+    }
+    if (!primed_) {
+      // Nothing has been written that far back yet: silence, but not a deadline miss.
+      if (writeBlock_ < delayBlocks_ || (writeBlock_ == delayBlocks_ && writeOffset_ < delayOffset_)) {
+        return 0.0f;
+      }
+      primed_ = true;
+    }
+    if (readTags_[block % CacheBlocks].load(std::memory_order_acquire) != block + 1) {
+      ++underruns_;
+      return 0.0f;
+    }
+    return readRing_[block % CacheBlocks][offset];
+  }
+
+  void writeSample(float value) {
+    if (writeOffset_ == 0) {
+      // A slot is reusable once service() has flushed the block that last used it.
+      const std::uint32_t flushed = flushedBlocks_.load(std::memory_order_acquire);
+      writeSlotFree_ = writeBlock_ - flushed < CacheBlocks;
+      if (!writeSlotFree_) {
+        ++overruns_;
+      }
+    }
+    if (writeSlotFree_) {
+      writeRing_[writeBlock_ % CacheBlocks][writeOffset_] = zapDenormal(value);
+    }
+    if (++writeOffset_ == BlockSize) {
+      // A dropped block leaves the tag alone: the slot still belongs to an unflushed older block,
+      // and service() spots the drop because the tag does not match.
+      if (writeSlotFree_) {
+        writeTags_[writeBlock_ % CacheBlocks].store(writeBlock_ + 1, std::memory_order_relaxed);
+      }
+      writeOffset_ = 0;
+      ++writeBlock_;
+      writtenBlocks_.store(writeBlock_, std::memory_order_release);
+    }
+  }
+
+  float sampleRate_ = kDefaultSampleRate;
+  float feedback_ = 0.5f;
+  float inputGain_ = 1.0f;
+  float mix_ = 0.5f;
+  size_t delaySamples_ = minDelaySamples();
+  std::uint32_t delayBlocks_ = CacheBlocks + 1;
+  size_t delayOffset_ = 0;
+  Backing backing_;
+  size_t backingBlocks_ = 0;
+
+  // Audio-side state.
+  std::uint32_t writeBlock_ = 0;
+  size_t writeOffset_ = 0;
+  bool writeSlotFree_ = true;
+  bool primed_ = false;
+  std::uint32_t publishedCursor_ = 0;
+  std::uint32_t underruns_ = 0;
+  std::uint32_t overruns_ = 0;
+
+  // Shared counters: each has exactly one writer.
+  std::atomic<std::uint32_t> writtenBlocks_{0};   // audio -> service
+  std::atomic<std::uint32_t> flushedBlocks_{0};   // service -> audio
+  std::atomic<std::uint32_t> readCursor_{0};      // audio -> service
+  std::array<std::atomic<std::uint32_t>, CacheBlocks> readTags_{};  // service -> audio, block + 1
+  std::array<std::atomic<std::uint32_t>, CacheBlocks> writeTags_{};  // audio -> service, block + 1 of the slot's last kept block
+
+  std::array<std::array<float, BlockSize>, CacheBlocks> writeRing_{};
+  std::array<std::array<float, BlockSize>, CacheBlocks> readRing_{};
+};
+
+}  // namespace rpdsp
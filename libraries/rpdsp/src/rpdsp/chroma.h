@@ -0,0 +1,244 @@
+#pragma once
+
+#include "algorithm.h"
+#include "spectrum.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace rpdsp {
+
+using ChromaVector = std::array<float, 12>;
+
+// Folds RealFft<N> frames into a 12-bin pitch-class profile (index 0 = C) for chord
+// following on the control core. Each bin between the frequency limits splits its power
+// between its two nearest semitones by triangular weight; frames are normalized to a peak
+// of 1 and smoothed with a one-pole across frames. prepare() builds the bin map; process()
+// is a single pass over N/2 bins with no allocation.
+//
+// Resolution: a semitone at 110 Hz is ~6.5 Hz wide, so for bass content feed it a decimated
+// stream (Decimator<4> + N = 2048 at 48 kHz gives 5.9 Hz bins).
+template <size_t N>
+class Chromagram {
+ public:
+  static constexpr size_t kBins = N / 2 + 1;
+
+  void prepare(float sampleRate, float minFrequencyHz = 80.0f, float maxFrequencyHz = 2000.0f) {
+    sampleRate_ = safeSampleRate(sampleRate);
+    const float binHz = sampleRate_ / static_cast<float>(N);
+    const float low = std::max(binHz, minFrequencyHz);
+    const float high = std::min(0.5f * sampleRate_, maxFrequencyHz);
+    firstBin_ = static_cast<size_t>(std::ceil(low / binHz));
+    lastBin_ = std::min(kBins - 1, static_cast<size_t>(high / binHz));
+    for (size_t k = 0; k < kBins; ++k) {
+      // Semitones above C-1 (MIDI 0), so floor() lands on a pitch class directly.
+      const float midi = k > 0 ? 69.0f + 12.0f * std::log2(static_cast<float>(k) * binHz / 440.0f) : 0.0f;
+      const float lower = std::floor(midi);
+      pitchClass_[k] = static_cast<std::uint8_t>(((static_cast<int>(lower) % 12) + 12) % 12);
+      upperWeight_[k] = midi - lower;
+    }
+    reset();
+  }
+
+  void reset() {
+    chroma_.fill(0.0f);
+    energy_ = 0.0f;
+  }
+
+  // 0 follows every frame; values toward 1 hold the profile across more frames.
+  void setSmoothing(float smoothing) { smoothing_ = clamp(smoothing, 0.0f, 0.99f); }
+
+  // packed is a RealFft<N> forward() result, e.g. from StftFrameBuilder::nextFrame().
+  void process(const float* packed) {
+    ChromaVector frame{};
+    float energy = 0.0f;
+    for (size_t k = firstBin_; k <= lastBin_; ++k) {
+      const float power = k == N / 2 ? packed[1] * packed[1]
+                                      : packed[2 * k] * packed[2 * k] + packed[2 * k + 1] * packed[2 * k + 1];
+      const std::uint8_t pc = pitchClass_[k];
+      const float upper = upperWeight_[k];
+      frame[pc] += power * (1.0f - upper);
+      frame[pc == 11 ? 0 : pc + 1] += power * upper;
+      energy += power;
+    }
+
+    float peak = 0.0f;
+    for (float& value : frame) {
+      // Square root keeps loud bass partials from masking the upper chord tones.
+      value = std::sqrt(value);
+      peak = std::max(peak, value);
+    }
+    const float scale = peak > 0.0f ? 1.0f / peak : 0.0f;
+    for (size_t pc = 0; pc < 12; ++pc) {
+      chroma_[pc] = smoothing_ * chroma_[pc] + (1.0f - smoothing_) * frame[pc] * scale;
+    }
+    // Unsmoothed mean power per bin in range, so a silence gate reacts within one frame.
+    const float bins = static_cast<float>(lastBin_ >= firstBin_ ? lastBin_ - firstBin_ + 1 : 1);
+    energy_ = energy / bins;
+  }
+
+  [[nodiscard]] const ChromaVector& chroma() const { return chroma_; }
+  [[nodiscard]] float energy() const { return energy_; }
+
+  // Bit pc set for every class at or above threshold (relative to the peak of 1).
+  [[nodiscard]] std::uint16_t pitchClassMask(float threshold = 0.5f) const {
+    std::uint16_t mask = 0;
+    for (size_t pc = 0; pc < 12; ++pc) {
+      if (chroma_[pc] >= threshold) {
+        mask = static_cast<std::uint16_t>(mask | (1u << pc));
+      }
+    }
+    return mask;
+  }
+
+ private:
+  std::array<std::uint8_t, kBins> pitchClass_{};
+  std::array<float, kBins> upperWeight_{};
+  ChromaVector chroma_{};
+  float sampleRate_ = kDefaultSampleRate;
+  float smoothing_ = 0.6f;
+  float energy_ = 0.0f;
+  size_t firstBin_ = 1;
+  size_t lastBin_ = N / 2;
+};
+
+// Chord qualities the template matcher knows, in the order ties are resolved (simplest first).
+enum class ChordShape : std::uint8_t {
+  Major,
+  Minor,
+  Diminished,
+  Augmented,
+  Sus2,
+  Sus4,
+  Major7,
+  Minor7,
+  Dominant7,
+  HalfDiminished7,
+  Diminished7,
+};
+
+struct ChordMatch {
+  std::uint8_t root = 0;           // pitch class, 0 = C
+  ChordShape shape = ChordShape::Major;
+  std::uint16_t mask = 0;          // pitch classes of the matched template, rooted
+  float score = 0.0f;              // weighted cosine similarity with the chromagram, 0..1
+  bool valid = false;
+};
+
+// Scores every root x shape template (132 masks) against a chroma vector by cosine
+// similarity, weighted like ChordAnalyzer's pattern weights so four-note chords need a real
+// seventh rather than the third harmonic of the third (B over a C triad). Keeps the current
+// chord unless a rival wins by a margin, so the result does not flicker between close
+// readings. About 600 adds per call; no allocation.
+class ChordTemplateMatcher {
+ public:
+  static constexpr size_t kShapes = 11;
+
+  void reset() { current_ = ChordMatch{}; }
+
+  // Below this score nothing is reported.
+  void setMinimumScore(float score) { minimumScore_ = clamp01(score); }
+  // How much a different chord must beat the current one by before it takes over.
+  void setHysteresis(float margin) { hysteresis_ = clamp(margin, 0.0f, 0.5f); }
+
+  [[nodiscard]] static constexpr std::uint16_t shapeMask(ChordShape shape) {
+    return kShapeMasks[static_cast<size_t>(shape)];
+  }
+
+  [[nodiscard]] static constexpr std::uint16_t rotate(std::uint16_t mask, std::uint8_t root) {
+    return static_cast<std::uint16_t>(((mask << root) | (mask >> (12 - root))) & 0x0fffu);
+  }
+
+  // Best template for this chroma, ignoring hysteresis.
+  [[nodiscard]] ChordMatch bestMatch(const ChromaVector& chroma) const {
+    float norm = 0.0f;
+    for (float value : chroma) {
+      norm += value * value;
+    }
+    ChordMatch best;
+    if (norm <= 0.0f) {
+      return best;
+    }
+    const float inverseNorm = 1.0f / std::sqrt(norm);
+    for (size_t shape = 0; shape < kShapes; ++shape) {
+      const float templateScale = inverseNorm * kInverseSqrtTones[shape];
+      for (std::uint8_t root = 0; root < 12; ++root) {
+        const std::uint16_t mask = rotate(kShapeMasks[shape], root);
+        const float score = maskedSum(chroma, mask) * templateScale;
+        if (score > best.score) {
+          best = {root, static_cast<ChordShape>(shape), mask, score, true};
+        }
+      }
+    }
+    return best;
+  }
+
+  // Updates and returns the followed chord.
+  const ChordMatch& process(const ChromaVector& chroma) {
+    ChordMatch best = bestMatch(chroma);
+    if (!best.valid || best.score < minimumScore_) {
+      current_ = ChordMatch{};
+      return current_;
+    }
+    if (current_.valid && (best.root != current_.root || best.shape != current_.shape)) {
+      // Re-score the held chord on this frame; keep it unless the rival is clearly better.
+      const float norm = std::sqrt(dot(chroma, chroma));
+      const float heldScore =
+          maskedSum(chroma, current_.mask) * kInverseSqrtTones[static_cast<size_t>(current_.shape)] / norm;
+      if (best.score < heldScore + hysteresis_) {
+        current_.score = heldScore;
+        return current_;
+      }
+    }
+    current_ = best;
+    return current_;
+  }
+
+  [[nodiscard]] const ChordMatch& current() const { return current_; }
+
+ private:
+  static float maskedSum(const ChromaVector& chroma, std::uint16_t mask) {
+    float sum = 0.0f;
+    for (size_t pc = 0; pc < 12; ++pc) {
+      if ((mask >> pc) & 1u) {
+        sum += chroma[pc];
+      }
+    }
+    return sum;
+  }
+
+  static float dot(const ChromaVector& a, const ChromaVector& b) {
+    float sum = 0.0f;
+    for (size_t pc = 0; pc < 12; ++pc) {
+      sum += a[pc] * b[pc];
+    }
+    return sum;
+  }
+
+  // Interval sets rooted on C, bit n = n semitones above the root.
+  static constexpr std::array<std::uint16_t, kShapes> kShapeMasks = {
+      0x091,  // Major: 0 4 7
+      0x089,  // Minor: 0 3 7
+      0x049,  // Diminished: 0 3 6
+      0x111,  // Augmented: 0 4 8
+      0x085,  // Sus2: 0 2 7
+      0x0a1,  // Sus4: 0 5 7
+      0x891,  // Major7: 0 4 7 11
+      0x489,  // Minor7: 0 3 7 10
+      0x491,  // Dominant7: 0 4 7 10
+      0x449,  // HalfDiminished7: 0 3 6 10
+      0x249,  // Diminished7: 0 3 6 9
+  };
+  // Template weight / sqrt(tone count): 1 for triads, 0.92 for sevenths.
+  static constexpr std::array<float, kShapes> kInverseSqrtTones = {
+      0.57735027f, 0.57735027f, 0.57735027f, 0.57735027f, 0.57735027f, 0.57735027f,
+      0.46f,       0.46f,       0.46f,       0.46f,       0.46f};
+
+  ChordMatch current_;
+  float minimumScore_ = 0.6f;
+  float hysteresis_ = 0.05f;
+};
+
+}  // namespace rpdsp
@@ -71,6 +71,23 @@ class ClockTracker {
     return false;
   }
 
+  // Snap the tick counter to the nearest quarter-note boundary, e.g. on a detected beat.
+  // Returns the correction applied, in ticks (negative when the clock ran ahead).
+  int alignToBeat() {
+    const int loopTicks = totalTicks();
+    if (loopTicks <= 0 || pulsesPerQuarter_ <= 0)
+      return 0;
+
+    const int offset = tick_ % pulsesPerQuarter_;
+    const int correction = offset >= pulsesPerQuarter_ / 2 ? pulsesPerQuarter_ - offset : -offset;
+    tick_ += correction;
+    if (tick_ >= loopTicks) {
+      tick_ -= loopTicks;
+      ++loopCount_;
+    }
+    return correction;
+  }
+
   // Feed one sample of an external clock gate; returns true on a rising edge.
   bool processExternalClock(bool clockHigh) {
     const bool rising = clockHigh && !lastClockHigh_;
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "config.h"
+#include "fft.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+namespace rpdsp {
+
+// Zero-latency uniformly partitioned convolution for cabinet and small-room IRs.
+//
+// The IR is cut into MaxPartitions partitions of BlockSize taps. Partition 0 runs as a
+// direct-form FIR on the current block, so the output has no added latency. Partitions
+// 1.. run as overlap-save in the frequency domain (FFT size 2 * BlockSize) against a
+// frequency-domain delay line (FDL) of past input spectra; they only need input that has
+// already arrived, which is what lets the head stay direct.
+//
+// Cost per block, independent of where the IR energy sits:
+//   - BlockSize^2 multiply-adds for the direct head,
+//   - one forward and one inverse RealFft<2 * BlockSize>,
+//   - (partitions - 1) * (BlockSize + 1) complex multiply-adds.
+// See estimatedCyclesPerBlock() and the catalog for how many taps fit the budget.
+//
+// Memory: two spectra of 2 * BlockSize floats per FFT partition (IR + FDL), all in the type.
+template <size_t MaxPartitions, size_t BlockSize = kDefaultBlockSize>
+class PartitionedConvolver {
+  static_assert(MaxPartitions >= 1, "PartitionedConvolver needs at least the direct partition");
+  static_assert((BlockSize & (BlockSize - 1)) == 0 && BlockSize >= 4, "BlockSize must be a power of two");
+
+  static constexpr size_t kFftSize = 2 * BlockSize;
+  static constexpr size_t kFftPartitions = MaxPartitions - 1;
+  using Fft = RealFft<kFftSize>;
+  using Spectrum = std::array<float, kFftSize>;
+
+ public:
+  static constexpr size_t kMaxTaps = MaxPartitions * BlockSize;
+  static constexpr size_t kBlockSize = BlockSize;
+
+  // Rough Cortex-M33 cycle model (single-cycle FPU MAC, ~2 cycles per MAC with loads):
+  // direct head 2 * B^2, each real FFT ~6 * N log2 N, each complex MAC bin ~8 cycles.
+  static constexpr size_t estimatedCyclesPerBlock(size_t partitions) {
+    const size_t head = 2 * BlockSize * BlockSize;
+    const size_t ffts = partitions > 1 ? 2 * Fft::estimatedCycles() : 0;
+    const size_t macs = partitions > 1 ? (partitions - 1) * (BlockSize + 1) * 8 : 0;
+    return head + ffts + macs;
+  }
+
+  void reset() {
+    window_.fill(0.0f);
+    for (auto& spectrum : fdl_) {
+      spectrum.fill(0.0f);
+    }
+    fdlHead_ = 0;
+  }
+
+  // Control side: FFTs every partition, so never call it from the audio callback. Taps
+  // beyond kMaxTaps are dropped; the history is cleared so the old IR cannot ring on.
+  void setImpulseResponse(const float* impulse, size_t length) {
+    if (length > kMaxTaps) {
+      length = kMaxTaps;
+    }
+    partitions_ = length > 0 ? (length + BlockSize - 1) / BlockSize : 1;
+    head_.fill(0.0f);
+    for (size_t i = 0; i < BlockSize && i < length; ++i) {
+      head_[i] = impulse[i];
+    }
+    for (size_t p = 0; p < kFftPartitions; ++p) {
+      Spectrum& spectrum = irSpectra_[p];
+      spectrum.fill(0.0f);
+      const size_t start = (p + 1) * BlockSize;
+      for (size_t i = 0; i < BlockSize && start + i < length; ++i) {
+        spectrum[i] = impulse[start + i];
+      }
+      Fft::forward(spectrum.data());
+    }
+    reset();
+  }
+
+  [[nodiscard]] size_t partitions() const { return partitions_; }
+
+  // Exactly BlockSize frames; input and output may alias.
+  void process(const float* input, float* output) {
+    std::memcpy(&window_[BlockSize], input, BlockSize * sizeof(float));
+
+    // Partition 0: direct FIR over the previous and current block.
+    for (size_t n = 0; n < BlockSize; ++n) {
+      const float* x = &window_[BlockSize + n];
+      float sum = 0.0f;
+      for (size_t j = 0; j < BlockSize; ++j) {
+        sum += head_[j] * x[-static_cast<std::ptrdiff_t>(j)];
+      }
+      output[n] = sum;
+    }
+
+    if (kFftPartitions == 0) {
+      std::memcpy(&window_[0], &window_[BlockSize], BlockSize * sizeof(float));
+      return;
+    }
+
+    // Partitions 1..: the FDL already holds X[t-1], X[t-2], ... from earlier blocks.
+    if (partitions_ > 1) {
+      accumulator_.fill(0.0f);
+      size_t slot = fdlHead_;
+      for (size_t p = 0; p + 1 < partitions_; ++p) {
+        Fft::multiplyAccumulate(fdl_[slot].data(), irSpectra_[p].data(), accumulator_.data());
+        slot = slot == 0 ? kFftPartitions - 1 : slot - 1;
+      }
+      Fft::inverse(accumulator_.data());
+      // Overlap-save: only the second half of the circular result is linear convolution.
+      for (size_t n = 0; n < BlockSize; ++n) {
+        output[n] += accumulator_[BlockSize + n];
+      }
+    }
+
+    // Push X[t], the spectrum of [previous block, current block], as the newest FDL entry.
+    fdlHead_ = fdlHead_ + 1 == kFftPartitions ? 0 : fdlHead_ + 1;
+    Spectrum& newest = fdl_[fdlHead_];
+    std::memcpy(newest.data(), window_.data(), kFftSize * sizeof(float));
+    Fft::forward(newest.data());
+    std::memcpy(&window_[0], &window_[BlockSize], BlockSize * sizeof(float));
+  }
+
+ private:
+  std::array<float, BlockSize> head_{};
+  std::array<float, kFftSize> window_{};
+  std::array<Spectrum, kFftPartitions> irSpectra_{};
+  std::array<Spectrum, kFftPartitions> fdl_{};
+  Spectrum accumulator_{};
+  size_t fdlHead_ = 0;
+  size_t partitions_ = 1;
+};
+
+}  // namespace rpdsp
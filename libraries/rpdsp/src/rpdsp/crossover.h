@@ -0,0 +1,221 @@
+#pragma once
+
+#include "algorithm.h"
+#include "realtime.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace rpdsp {
+
+// Coefficients of a Butterworth (k = sqrt 2) TPT state-variable section; shared by every
+// section that runs at the same frequency.
+struct ButterworthSvfCoefficients {
+  static constexpr float kDamping = 1.41421356f;
+
+  void setFrequency(float cutoffHz, float sampleRate) {
+    const float g = std::tan(kPi * clampCutoff(cutoffHz, sampleRate) / sampleRate);
+    a1 = 1.0f / (1.0f + g * (g + kDamping));
+    a2 = g * a1;
+    a3 = g * a2;
+  }
+
+  float a1 = 1.0f;
+  float a2 = 0.0f;
+  float a3 = 0.0f;
+};
+
+// State of one section; tick() is the StateVariableFilter update with the damping fixed.
+struct ButterworthSvfState {
+  void reset() {
+    ic1eq = 0.0f;
+    ic2eq = 0.0f;
+  }
+
+  // Writes the bandpass; returns the lowpass. The highpass is input - kDamping * bp - lp.
+  float tick(const ButterworthSvfCoefficients& c, float input, float& bandpass) {
+    const float v3 = input - ic2eq;
+    const float v1 = c.a1 * ic1eq + c.a2 * v3;
+    const float v2 = ic2eq + c.a2 * ic1eq + c.a3 * v3;
+    ic1eq = zapDenormal((2.0f * v1) - ic1eq);
+    ic2eq = zapDenormal((2.0f * v2) - ic2eq);
+    bandpass = v1;
+    return v2;
+  }
+
+  float ic1eq = 0.0f;
+  float ic2eq = 0.0f;
+};
+
+// 4th-order Linkwitz-Riley crossover: each output is a squared Butterworth, so low + high is
+// the 2nd-order allpass at the crossover frequency and the bands are in phase (-6 dB each).
+// Three TPT sections: one shared input stage, then one more lowpass and one more highpass.
+class LinkwitzRileyCrossover {
+ public:
+  void prepare(float sampleRate) {
+    sampleRate_ = safeSampleRate(sampleRate);
+    setFrequency(frequencyHz_);
+  }
+
+  void reset() {
+    input_.reset();
+    low_.reset();
+    high_.reset();
+  }
+
+  void setFrequency(float frequencyHz) {
+    frequencyHz_ = clampCutoff(frequencyHz, sampleRate_);
+    coefficients_.setFrequency(frequencyHz_, sampleRate_);
+  }
+
+  [[nodiscard]] float frequency() const { return frequencyHz_; }
+
+  void process(float input, float& low, float& high) {
+    constexpr float k = ButterworthSvfCoefficients::kDamping;
+    float bandpass = 0.0f;
+    const float lowpass = input_.tick(coefficients_, input, bandpass);
+    const float highpass = input - k * bandpass - lowpass;
+
+    low = low_.tick(coefficients_, lowpass, bandpass);
+    const float highLowpass = high_.tick(coefficients_, highpass, bandpass);
+    high = highpass - k * bandpass - highLowpass;
+  }
+
+ private:
+  float sampleRate_ = kDefaultSampleRate;
+  float frequencyHz_ = 1000.0f;
+  ButterworthSvfCoefficients coefficients_{};
+  ButterworthSvfState input_{};
+  ButterworthSvfState low_{};
+  ButterworthSvfState high_{};
+};
+
+// The phase of an LR4 crossover without the split; keeps bands from other crossovers aligned.
+class LinkwitzRileyAllpass {
+ public:
+  void prepare(float sampleRate) {
+    sampleRate_ = safeSampleRate(sampleRate);
+    setFrequency(frequencyHz_);
+  }
+
+  void reset() { state_.reset(); }
+
+  void setFrequency(float frequencyHz) {
+    frequencyHz_ = clampCutoff(frequencyHz, sampleRate_);
+    coefficients_.setFrequency(frequencyHz_, sampleRate_);
+  }
+
+  [[nodiscard]] float frequency() const { return frequencyHz_; }
+
+  float process(float input) {
+    // lp - k bp + hp collapses to input - 2k bp.
+    float bandpass = 0.0f;
+    state_.tick(coefficients_, input, bandpass);
+    return input - 2.0f * ButterworthSvfCoefficients::kDamping * bandpass;
+  }
+
+ private:
+  float sampleRate_ = kDefaultSampleRate;
+  float frequencyHz_ = 1000.0f;
+  ButterworthSvfCoefficients coefficients_{};
+  ButterworthSvfState state_{};
+};
+
+// 2-, 3- or 4-band LR4 splitter whose bands sum to an allpass (flat magnitude). Every path
+// sees every crossover once: 3 bands split at f0 then f1 and put the low band through the f1
+// allpass; 4 bands split at f1 first and cross-compensate each half with the other half's
+// allpass. Crossover frequencies must be ascending.
+template <size_t Bands>
+class BandSplitter {
+  static_assert(Bands >= 2 && Bands <= 4, "BandSplitter supports 2, 3 or 4 bands");
+
+ public:
+  static constexpr size_t kCrossovers = Bands - 1;
+
+  BandSplitter() {
+    for (size_t i = 0; i < kCrossovers; ++i) {
+      frequencies_[i] = defaultFrequency(i);
+    }
+  }
+
+  void prepare(float sampleRate) {
+    for (auto& crossover : crossovers_) {
+      crossover.prepare(sampleRate);
+    }
+    for (auto& allpass : allpasses_) {
+      allpass.prepare(sampleRate);
+    }
+    for (size_t i = 0; i < kCrossovers; ++i) {
+      setCrossover(i, frequencies_[i]);
+    }
+  }
+
+  void reset() {
+    for (auto& crossover : crossovers_) {
+      crossover.reset();
+    }
+    for (auto& allpass : allpasses_) {
+      allpass.reset();
+    }
+  }
+
+  void setCrossover(size_t index, float frequencyHz) {
+    if (index >= kCrossovers) {
+      return;
+    }
+    crossovers_[index].setFrequency(frequencyHz);
+    frequencies_[index] = crossovers_[index].frequency();
+    if constexpr (Bands == 3) {
+      if (index == 1) {
+        allpasses_[0].setFrequency(frequencyHz);
+      }
+    } else if constexpr (Bands == 4) {
+      if (index == 2) {
+        allpasses_[0].setFrequency(frequencyHz);
+      } else if (index == 0) {
+        allpasses_[1].setFrequency(frequencyHz);
+      }
+    }
+  }
+
+  [[nodiscard]] float crossover(size_t index) const {
+    return index < kCrossovers ? frequencies_[index] : 0.0f;
+  }
+
+  void process(float input, std::array<float, Bands>& bands) {
+    if constexpr (Bands == 2) {
+      crossovers_[0].process(input, bands[0], bands[1]);
+    } else if constexpr (Bands == 3) {
+      float low = 0.0f;
+      float rest = 0.0f;
+      crossovers_[0].process(input, low, rest);
+      bands[0] = allpasses_[0].process(low);
+      crossovers_[1].process(rest, bands[1], bands[2]);
+    } else {
+      float low = 0.0f;
+      float high = 0.0f;
+      crossovers_[1].process(input, low, high);
+      crossovers_[0].process(allpasses_[0].process(low), bands[0], bands[1]);
+      crossovers_[2].process(allpasses_[1].process(high), bands[2], bands[3]);
+    }
+  }
+
+ private:
+  static float defaultFrequency(size_t index) {
+    if constexpr (Bands == 2) {
+      return 1000.0f;
+    } else if constexpr (Bands == 3) {
+      return index == 0 ? 200.0f : 2000.0f;
+    } else {
+      constexpr std::array<float, 3> kDefaults = {120.0f, 800.0f, 5000.0f};
+      return kDefaults[index];
+    }
+  }
+
+  std::array<LinkwitzRileyCrossover, kCrossovers> crossovers_{};
+  std::array<LinkwitzRileyAllpass, Bands - 2> allpasses_{};
+  std::array<float, kCrossovers> frequencies_{};
+};
+
+}  // namespace rpdsp
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "algorithm.h"
+
+#include <array>
+#include <cstddef>
+
+namespace rpdsp {
+
+// 2:1 polyphase half-band decimator. A 23-tap Kaiser-windowed (beta 7) half-band FIR: every
+// other tap is zero, so the filter splits into a 12-tap symmetric branch (6 multiplies per
+// output) and a pure delay for the 0.5 centre tap. Only output samples are computed.
+//
+// Relative to the input rate: flat within 0.002 dB to 0.1 fs, -0.85 dB at 0.2 fs, and at
+// least 67 dB rejection above 0.35 fs, so everything that can alias below 0.15 fs is removed.
+class HalfBandDecimator {
+ public:
+  static constexpr size_t kPairs = 6;
+  // Group delay, in input samples.
+  static constexpr size_t kLatencySamples = 2 * kPairs - 1;
+
+  void reset() {
+    even_.fill(0.0f);
+    odd_.fill(0.0f);
+    evenIndex_ = 0;
+    oddIndex_ = 0;
+    outputPhase_ = false;
+  }
+
+  // Consumes one input sample; every second call writes output and returns true.
+  bool process(float input, float& output) {
+    if (!outputPhase_) {
+      odd_[oddIndex_] = input;
+      oddIndex_ = oddIndex_ + 1 == kPairs ? 0 : oddIndex_ + 1;
+      outputPhase_ = true;
+      return false;
+    }
+    outputPhase_ = false;
+
+    // Written twice so taps read one contiguous span, newest first.
+    evenIndex_ = evenIndex_ == 0 ? 2 * kPairs - 1 : evenIndex_ - 1;
+    even_[evenIndex_] = input;
+    even_[evenIndex_ + 2 * kPairs] = input;
+    const float* taps = even_.data() + evenIndex_;
+
+    float sum = 0.5f * odd_[oddIndex_];
+    for (size_t j = 0; j < kPairs; ++j) {
+      sum += kCoefficients[j] * (taps[kPairs - 1 - j] + taps[kPairs + j]);
+    }
+    output = sum;
+    return true;
+  }
+
+ private:
+  // Non-zero off-centre taps h[c +- (2j + 1)], normalized for unity DC gain.
+  static constexpr std::array<float, kPairs> kCoefficients = {
+      0.309811317f, -0.083011428f, 0.031466432f, -0.010516246f, 0.002421523f, -0.000171598f};
+
+  std::array<float, 4 * kPairs> even_{};
+  std::array<float, kPairs> odd_{};
+  size_t evenIndex_ = 0;
+  size_t oddIndex_ = 0;
+  bool outputPhase_ = false;
+};
+
+// Cascade of half-band stages for 1x/2x/4x/8x decimation. Each stage keeps ~0.1 of its own
+// input rate flat, so at 48 kHz: 2x is flat to 4.8 kHz, 4x to 2.4 kHz, 8x to 1.2 kHz.
+template <size_t Factor>
+class Decimator {
+  static_assert(Factor == 1 || Factor == 2 || Factor == 4 || Factor == 8, "Decimator factor must be 1, 2, 4 or 8");
+
+  static constexpr size_t kStages = Factor == 8 ? 3 : Factor == 4 ? 2 : Factor == 2 ? 1 : 0;
+
+ public:
+  static constexpr size_t kFactor = Factor;
+  // Group delay of the whole cascade, in input samples.
+  static constexpr size_t kLatencySamples = HalfBandDecimator::kLatencySamples * (Factor - 1);
+
+  void prepare(float sampleRate) {
+    sampleRate_ = safeSampleRate(sampleRate);
+    reset();
+  }
+
+  void reset() {
+    for (auto& stage : stages_) {
+      stage.reset();
+    }
+  }
+
+  [[nodiscard]] float inputSampleRate() const { return sampleRate_; }
+
+  [[nodiscard]] float outputSampleRate() const { return sampleRate_ / static_cast<float>(Factor); }
+
+  // Consumes one input sample; writes output and returns true once every Factor calls.
+  bool process(float input, float& output) {
+    float value = input;
+    for (auto& stage : stages_) {
+      if (!stage.process(value, value)) {
+        return false;
+      }
+    }
+    output = value;
+    return true;
+  }
+
+  // Returns the number of samples written to output (at most frames / Factor, rounded up).
+  size_t process(const float* input, size_t frames, float* output) {
+    size_t written = 0;
+    for (size_t i = 0; i < frames; ++i) {
+      if (process(input[i], output[written])) {
+        ++written;
+      }
+    }
+    return written;
+  }
+
+ private:
+  std::array<HalfBandDecimator, kStages> stages_{};
+  float sampleRate_ = kDefaultSampleRate;
+};
+
+// Runs an analyzer (pitch detector, envelope follower, meter) on a decimated copy of the
+// signal. prepare() hands the analyzer the decimated rate, so its time constants and
+// frequency ranges stay in Hz and ms. Size the analyzer for the lower rate: at 4x, a
+// YinPitchDetector<256, 128> reaches down to ~94 Hz for a sixteenth of the <1024, 512> cost.
+template <typename Analyzer, size_t Factor>
+class DecimatedAnalyzer {
+ public:
+  void prepare(float sampleRate) {
+    decimator_.prepare(sampleRate);
+    analyzer_.prepare(decimator_.outputSampleRate());
+  }
+
+  void reset() {
+    decimator_.reset();
+    analyzer_.reset();
+  }
+
+  void process(float input) {
+    float decimated = 0.0f;
+    if (decimator_.process(input, decimated)) {
+      analyzer_.process(decimated);
+    }
+  }
+
+  void process(const float* input, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+      process(input[i]);
+    }
+  }
+
+  [[nodiscard]] Analyzer& analyzer() { return analyzer_; }
+  [[nodiscard]] const Analyzer& analyzer() const { return analyzer_; }
+  [[nodiscard]] float analysisSampleRate() const { return decimator_.outputSampleRate(); }
+
+ private:
+  Decimator<Factor> decimator_;
+  Analyzer analyzer_;
+};
+
+}  // namespace rpdsp
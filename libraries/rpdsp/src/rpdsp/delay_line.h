@@ -1,35 +1,182 @@
 #pragma once
 
+#include "realtime.h"
+
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 namespace rpdsp {
 
-template <size_t Capacity>
+// Storage policies decide how DelayLine keeps samples in memory. Each one exposes a
+// Sample type plus encode()/decode(); DelayLine converts on push() and read(), so the
+// read/readLinear/readCubic API is identical whichever policy is chosen.
+
+// Full 32-bit float storage: exact, and the default.
+struct FloatStorage {
+  using Sample = float;
+  Sample encode(float value) { return value; }
+  static float decode(Sample stored) { return stored; }
+};
+
+// Q15 int16 storage at half the memory of float. Values are clipped to [-1, 1), so keep
+// feedback paths below full scale. TPDF dither decorrelates the requantization error from
+// the signal, which keeps long decaying tails hissy rather than grainy. Each instance seeds
+// its dither from its own address, so the lines of a plate or FDN add uncorrelated noise
+// instead of the same sequence summing coherently.
+struct Q15Storage {
+  using Sample = std::int16_t;
+
+  Q15Storage() : rng_(seedFor(this)) {}
+  // A copied line keeps dithering independently of its source.
+  Q15Storage(const Q15Storage&) : rng_(seedFor(this)) {}
+  Q15Storage& operator=(const Q15Storage&) { return *this; }
+
+  Sample encode(float value) {
+    // One xorshift draw yields both uniform halves of the triangular dither (+/-1 LSB).
+    const std::uint32_t r = rng_.nextU32();
+    const float dither = static_cast<float>(static_cast<int32_t>(r & 0xFFFFu) +
+                                            static_cast<int32_t>(r >> 16) - 65535) *
+                         (1.0f / 65536.0f);
+    float scaled = value * 32768.0f + dither;
+    scaled = scaled < -32768.0f ? -32768.0f : (scaled > 32767.0f ? 32767.0f : scaled);
+    // Round half away from zero without a libm call.
+    return static_cast<Sample>(static_cast<int32_t>(scaled + (scaled >= 0.0f ? 0.5f : -0.5f)));
+  }
+
+  static float decode(Sample stored) { return static_cast<float>(stored) * (1.0f / 32768.0f); }
+
+ private:
+  static std::uint32_t seedFor(const void* address) {
+    const std::uint64_t bits = reinterpret_cast<std::uintptr_t>(address);
+    // Murmur3's finalizer, so neighbouring lines get unrelated seeds.
+    std::uint32_t x = static_cast<std::uint32_t>(bits ^ (bits >> 32)) ^ 0x51A7E5EDu;
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x;
+  }
+
+  XorShift32 rng_;
+};
+
+// bfloat16-style storage: the top 16 bits of the float, rounded to nearest even. Keeps
+// float headroom (no clipping) but only 8 mantissa bits, so the error floor is about
+// -50 dB relative to the signal. Suited to diffuse reverb tanks, not clean echoes.
+struct BFloat16Storage {
+  using Sample = std::uint16_t;
+
+  Sample encode(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits += 0x7FFFu + ((bits >> 16) & 1u);
+    return static_cast<Sample>(bits >> 16);
+  }
+
+  static float decode(Sample stored) {
+    const std::uint32_t bits = static_cast<std::uint32_t>(stored) << 16;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+};
+
+// Power-of-two capacities wrap with a bitmask instead of a compare-and-branch, which
+// matters most for readCubic(); pick e.g. 2048 over 2000 when the extra memory is cheap.
+// Every effect built on DelayLine (Delay, Chorus, CombFilter, AllpassFilter,
+// KarplusStrongVoice) gets the masked path automatically from its capacity.
+template <size_t Capacity, typename Storage = FloatStorage>
 class DelayLine {
   static_assert(Capacity > 1, "DelayLine capacity must be greater than one sample.");
 
  public:
+  using Sample = typename Storage::Sample;
+  static constexpr bool kMasked = (Capacity & (Capacity - 1)) == 0;
+
   // Capacity is a template parameter so delay memory is reserved before audio starts.
-  void reset() { buffer_.fill(0.0f); writeIndex_ = 0; }
+  void reset() { buffer_.fill(Sample{}); writeIndex_ = 0; }
 
   void push(float value) {
-    buffer_[writeIndex_] = value;
-    ++writeIndex_;
-    if (writeIndex_ == Capacity) {
-      writeIndex_ = 0;
+    buffer_[writeIndex_] = storage_.encode(value);
+    if constexpr (kMasked) {
+      writeIndex_ = (writeIndex_ + 1) & kMask;
+    } else {
+      ++writeIndex_;
+      if (writeIndex_ == Capacity) {
+        writeIndex_ = 0;
+      }
+    }
+  }
+
+  // Block push: same result as count push() calls, copied as at most two contiguous
+  // spans per Capacity samples (memcpy for float storage).
+  void write(const float* input, size_t count) {
+    while (count > 0) {
+      const size_t span = std::min(count, Capacity - writeIndex_);
+      storeSpan(&buffer_[writeIndex_], input, span);
+      writeIndex_ += span;
+      if (writeIndex_ == Capacity) {
+        writeIndex_ = 0;
+      }
+      input += span;
+      count -= span;
     }
   }
 
   float read(size_t delaySamples) const {
     assert(delaySamples < Capacity);
     // writeIndex_ points at the next slot, so one sample of delay is just behind it.
+    if constexpr (kMasked) {
+      return Storage::decode(buffer_[(writeIndex_ - delaySamples - 1) & kMask]);
+    }
     const size_t readOffset = delaySamples + 1;
     const size_t index = writeIndex_ >= readOffset
                                       ? writeIndex_ - readOffset
                                       : Capacity + writeIndex_ - readOffset;
-    return buffer_[index];
+    return Storage::decode(buffer_[index]);
+  }
+
+  // Block read: output[i] == read(delaySamples + count - 1 - i), i.e. the count samples
+  // ending delaySamples behind the write head, oldest first, in at most two spans.
+  void read(float* output, size_t count, size_t delaySamples) const {
+    assert(delaySamples + count <= Capacity);
+    const size_t readOffset = delaySamples + count;
+    size_t index = writeIndex_ >= readOffset ? writeIndex_ - readOffset : Capacity + writeIndex_ - readOffset;
+    while (count > 0) {
+      const size_t span = std::min(count, Capacity - index);
+      loadSpan(output, &buffer_[index], span);
+      index += span;
+      if (index == Capacity) {
+        index = 0;
+      }
+      output += span;
+      count -= span;
+    }
+  }
+
+  // Several integer taps in one pass: the write head is loaded once and each tap costs
+  // one subtract plus a mask (or a single conditional wrap).
+  template <size_t Taps>
+  std::array<float, Taps> readTaps(const std::array<size_t, Taps>& delays) const {
+    std::array<float, Taps> out{};
+    const size_t head = writeIndex_ + Capacity - 1;
+    for (size_t i = 0; i < Taps; ++i) {
+      assert(delays[i] < Capacity);
+      size_t index = head - delays[i];
+      if constexpr (kMasked) {
+        index &= kMask;
+      } else if (index >= Capacity) {
+        index -= Capacity;
+      }
+      out[i] = Storage::decode(buffer_[index]);
+    }
+    return out;
   }
 
   float readLinear(float delaySamples) const {
@@ -50,10 +197,23 @@ class DelayLine {
     const auto whole = static_cast<size_t>(delaySamples);
     const float frac = delaySamples - static_cast<float>(whole);
 
-    const float ym1 = read(previousDelayIndex(whole));
-    const float y0 = read(whole);
-    const float y1 = read(nextDelayIndex(whole));
-    const float y2 = read(nextDelayIndex(nextDelayIndex(whole)));
+    float ym1;
+    float y0;
+    float y1;
+    float y2;
+    if (kMasked && whole > 0 && whole + 2 < Capacity) {
+      // Interior taps sit in adjacent slots, so one masked base index serves all four.
+      const size_t index = (writeIndex_ - whole - 1) & kMask;
+      ym1 = Storage::decode(buffer_[(index + 1) & kMask]);
+      y0 = Storage::decode(buffer_[index]);
+      y1 = Storage::decode(buffer_[(index - 1) & kMask]);
+      y2 = Storage::decode(buffer_[(index - 2) & kMask]);
+    } else {
+      ym1 = read(previousDelayIndex(whole));
+      y0 = read(whole);
+      y1 = read(nextDelayIndex(whole));
+      y2 = read(nextDelayIndex(nextDelayIndex(whole)));
+    }
 
     const float c0 = (-frac * (frac - 1.0f) * (frac - 2.0f)) * (1.0f / 6.0f);
     const float c1 = ((frac + 1.0f) * (frac - 1.0f) * (frac - 2.0f)) * 0.5f;
@@ -64,6 +224,28 @@ class DelayLine {
   }
 
  private:
+  static constexpr size_t kMask = Capacity - 1;
+
+  void storeSpan(Sample* destination, const float* source, size_t count) {
+    if constexpr (std::is_same_v<Storage, FloatStorage>) {
+      std::memcpy(destination, source, count * sizeof(float));
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        destination[i] = storage_.encode(source[i]);
+      }
+    }
+  }
+
+  static void loadSpan(float* destination, const Sample* source, size_t count) {
+    if constexpr (std::is_same_v<Storage, FloatStorage>) {
+      std::memcpy(destination, source, count * sizeof(float));
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        destination[i] = Storage::decode(source[i]);
+      }
+    }
+  }
+
   static float clampDelaySamples(float delaySamples) {
     if (delaySamples < 0.0f) {
       return 0.0f;
@@ -83,8 +265,177 @@ class DelayLine {
     return delaySamples < Capacity - 1 ? delaySamples + 1 : Capacity - 1;
   }
 
-  std::array<float, Capacity> buffer_{};
+  std::array<Sample, Capacity> buffer_{};
   size_t writeIndex_ = 0;
+  // Empty for FloatStorage, so it adds no padding to float-only lines.
+  [[no_unique_address]] Storage storage_;
+};
+
+// Runtime-sized ring over arena memory. One instantiation serves every length, and
+// the length can follow the patch or sample rate. The API mirrors DelayLine; reads
+// before a successful prepare() return silence. Debug builds assert on any use after
+// the arena was reset without a fresh prepare().
+template <typename Storage = FloatStorage>
+class DelayLineView {
+ public:
+  using Sample = typename Storage::Sample;
+
+  // Claims capacity samples from the arena. Call from prepare(), never from the callback.
+  template <typename Arena>
+  bool prepare(Arena& arena, size_t capacity) {
+    buffer_ = capacity > 1 ? arena.template allocate<Sample>(capacity) : nullptr;
+    capacity_ = buffer_ != nullptr ? capacity : 0;
+    writeIndex_ = 0;
+    arenaGeneration_ = arena.generationCounter();
+    generation_ = arena.generation();
+    return buffer_ != nullptr;
+  }
+
+  void reset() {
+    assertCurrent();
+    for (size_t i = 0; i < capacity_; ++i) {
+      buffer_[i] = Sample{};
+    }
+    writeIndex_ = 0;
+  }
+
+  [[nodiscard]] size_t capacity() const { return capacity_; }
+  [[nodiscard]] bool isPrepared() const { return capacity_ > 0; }
+
+  void push(float value) {
+    if (capacity_ == 0) {
+      return;
+    }
+    assertCurrent();
+    buffer_[writeIndex_] = storage_.encode(value);
+    ++writeIndex_;
+    if (writeIndex_ == capacity_) {
+      writeIndex_ = 0;
+    }
+  }
+
+  void write(const float* input, size_t count) {
+    assertCurrent();
+    while (count > 0 && capacity_ > 0) {
+      const size_t span = std::min(count, capacity_ - writeIndex_);
+      for (size_t i = 0; i < span; ++i) {
+        buffer_[writeIndex_ + i] = storage_.encode(input[i]);
+      }
+      writeIndex_ += span;
+      if (writeIndex_ == capacity_) {
+        writeIndex_ = 0;
+      }
+      input += span;
+      count -= span;
+    }
+  }
+
+  float read(size_t delaySamples) const {
+    if (capacity_ == 0) {
+      return 0.0f;
+    }
+    assert(delaySamples < capacity_);
+    assertCurrent();
+    const size_t readOffset = delaySamples + 1;
+    const size_t index = writeIndex_ >= readOffset ? writeIndex_ - readOffset : capacity_ + writeIndex_ - readOffset;
+    return Storage::decode(buffer_[index]);
+  }
+
+  void read(float* output, size_t count, size_t delaySamples) const {
+    for (size_t i = 0; i < count; ++i) {
+      output[i] = read(delaySamples + count - 1 - i);
+    }
+  }
+
+  float readLinear(float delaySamples) const {
+    delaySamples = clampDelaySamples(delaySamples);
+    const auto whole = static_cast<size_t>(delaySamples);
+    const float frac = delaySamples - static_cast<float>(whole);
+    const float a = read(whole);
+    const float b = read(nextDelayIndex(whole));
+    return a + (b - a) * frac;
+  }
+
+  float readCubic(float delaySamples) const {
+    delaySamples = clampDelaySamples(delaySamples);
+    const auto whole = static_cast<size_t>(delaySamples);
+    const float frac = delaySamples - static_cast<float>(whole);
+
+    const float ym1 = read(whole > 0 ? whole - 1 : 0);
+    const float y0 = read(whole);
+    const float y1 = read(nextDelayIndex(whole));
+    const float y2 = read(nextDelayIndex(nextDelayIndex(whole)));
+
+    const float c0 = (-frac * (frac - 1.0f) * (frac - 2.0f)) * (1.0f / 6.0f);
+    const float c1 = ((frac + 1.0f) * (frac - 1.0f) * (frac - 2.0f)) * 0.5f;
+    const float c2 = (-(frac + 1.0f) * frac * (frac - 2.0f)) * 0.5f;
+    const float c3 = ((frac + 1.0f) * frac * (frac - 1.0f)) * (1.0f / 6.0f);
+
+    return (ym1 * c0) + (y0 * c1) + (y1 * c2) + (y2 * c3);
+  }
+
+  template <size_t Taps>
+  std::array<float, Taps> readTaps(const std::array<size_t, Taps>& delays) const {
+    std::array<float, Taps> out{};
+    for (size_t i = 0; i < Taps; ++i) {
+      out[i] = read(delays[i]);
+    }
+    return out;
+  }
+
+ private:
+  [[nodiscard]] float clampDelaySamples(float delaySamples) const {
+    const float maxDelay = capacity_ > 0 ? static_cast<float>(capacity_ - 1) : 0.0f;
+    return delaySamples < 0.0f ? 0.0f : (delaySamples > maxDelay ? maxDelay : delaySamples);
+  }
+
+  [[nodiscard]] size_t nextDelayIndex(size_t delaySamples) const {
+    return delaySamples + 1 < capacity_ ? delaySamples + 1 : delaySamples;
+  }
+
+  void assertCurrent() const {
+    assert(capacity_ == 0 || arenaGeneration_ == nullptr || *arenaGeneration_ == generation_);
+  }
+
+  Sample* buffer_ = nullptr;
+  size_t capacity_ = 0;
+  size_t writeIndex_ = 0;
+  // Empty for FloatStorage, so it adds no padding to float-only lines.
+  [[no_unique_address]] Storage storage_;
+  // Recorded in every build so debug and release translation units agree on the layout;
+  // only the check in assertCurrent() is debug-only.
+  const std::uint32_t* arenaGeneration_ = nullptr;
+  std::uint32_t generation_ = 0;
+};
+
+// A fixed set of weighted integer taps over any DelayLine or DelayLineView, read in one pass.
+template <size_t Taps>
+class MultiTap {
+ public:
+  void setTap(size_t tap, size_t delaySamples, float gain = 1.0f) {
+    assert(tap < Taps);
+    delays_[tap] = delaySamples;
+    gains_[tap] = gain;
+  }
+
+  template <typename Line>
+  std::array<float, Taps> read(const Line& line) const {
+    return line.readTaps(delays_);
+  }
+
+  template <typename Line>
+  float mix(const Line& line) const {
+    const std::array<float, Taps> values = line.readTaps(delays_);
+    float sum = 0.0f;
+    for (size_t i = 0; i < Taps; ++i) {
+      sum += values[i] * gains_[i];
+    }
+    return sum;
+  }
+
+ private:
+  std::array<size_t, Taps> delays_{};
+  std::array<float, Taps> gains_{};
 };
 
 }  // namespace rpdsp
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "algorithm.h"
+#include "crossover.h"
 #include "realtime.h"
 
+#include <array>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 
 namespace rpdsp {
 
@@ -164,4 +168,356 @@ class Compressor {
   GainReductionSmoother gainSmoother_;
 };
 
+// Compressor gain computer for several independent lanes, run once per control period. Each
+// lane gets the peak of its input over the period; the detector, static curve and gain
+// smoother then run at the control rate, where log10/pow are affordable. State is one array
+// per field so all lanes update in the same loop.
+template <size_t Lanes>
+class DecimatedGainComputer {
+ public:
+  DecimatedGainComputer() {
+    for (size_t i = 0; i < Lanes; ++i) {
+      curves_[i].setThresholdDb(-18.0f);
+      curves_[i].setRatio(2.0f);
+    }
+    attackMs_.fill(5.0f);
+    releaseMs_.fill(100.0f);
+  }
+
+  void prepare(float controlRate) {
+    controlRate_ = safeSampleRate(controlRate);
+    for (size_t i = 0; i < Lanes; ++i) {
+      setAttackRelease(i, attackMs_[i], releaseMs_[i]);
+    }
+    reset();
+  }
+
+  void reset() {
+    envelope_.fill(0.0f);
+    gainReductionDb_.fill(0.0f);
+  }
+
+  void setThresholdDb(size_t lane, float db) {
+    if (lane < Lanes) {
+      curves_[lane].setThresholdDb(db);
+    }
+  }
+
+  void setRatio(size_t lane, float ratio) {
+    if (lane < Lanes) {
+      curves_[lane].setRatio(ratio);
+    }
+  }
+
+  void setKneeWidthDb(size_t lane, float db) {
+    if (lane < Lanes) {
+      curves_[lane].setKneeWidthDb(db);
+    }
+  }
+
+  void setMakeupGainDb(size_t lane, float db) {
+    if (lane < Lanes) {
+      makeupGainDb_[lane] = db;
+    }
+  }
+
+  void setAttackRelease(size_t lane, float attackMs, float releaseMs) {
+    if (lane >= Lanes) {
+      return;
+    }
+    attackMs_[lane] = std::max(0.001f, attackMs);
+    releaseMs_[lane] = std::max(0.001f, releaseMs);
+    attackCoeff_[lane] = onePoleSmooth(attackMs_[lane], controlRate_);
+    releaseCoeff_[lane] = onePoleSmooth(releaseMs_[lane], controlRate_);
+  }
+
+  // Consumes one control period's peaks and writes each lane's linear gain, makeup included.
+  void process(const std::array<float, Lanes>& peaks, std::array<float, Lanes>& gains) {
+    for (size_t i = 0; i < Lanes; ++i) {
+      // Same detector and smoother as Compressor, one step per control period.
+      const float levelCoeff = peaks[i] > envelope_[i] ? attackCoeff_[i] : releaseCoeff_[i];
+      envelope_[i] = zapDenormal(((1.0f - levelCoeff) * peaks[i]) + (levelCoeff * envelope_[i]));
+      const float target = std::min(0.0f, curves_[i].gainReductionDb(gainToDb(envelope_[i])));
+      const float gainCoeff = target < gainReductionDb_[i] ? attackCoeff_[i] : releaseCoeff_[i];
+      gainReductionDb_[i] = ((1.0f - gainCoeff) * target) + (gainCoeff * gainReductionDb_[i]);
+      gains[i] = dbToGain(gainReductionDb_[i] + makeupGainDb_[i]);
+    }
+  }
+
+  [[nodiscard]] float gainReductionDb(size_t lane) const {
+    return lane < Lanes ? gainReductionDb_[lane] : 0.0f;
+  }
+
+ private:
+  float controlRate_ = kDefaultSampleRate;
+  std::array<CompressorStaticCurve, Lanes> curves_{};
+  std::array<float, Lanes> attackMs_{};
+  std::array<float, Lanes> releaseMs_{};
+  std::array<float, Lanes> attackCoeff_{};
+  std::array<float, Lanes> releaseCoeff_{};
+  std::array<float, Lanes> makeupGainDb_{};
+  std::array<float, Lanes> envelope_{};
+  std::array<float, Lanes> gainReductionDb_{};
+};
+
+// Stereo-linked multiband compressor: LR4 band split, one DecimatedGainComputer lane per band,
+// gains ramped linearly across each control period so the decimation never steps audibly.
+// Detection follows the louder channel so the stereo image does not shift. Gain reacts one
+// control period late (kControlInterval samples), which is negligible against typical attacks.
+template <size_t Bands = 3>
+class MultibandCompressor {
+ public:
+  static constexpr size_t kControlInterval = 8;
+
+  void prepare(float sampleRate) {
+    const float rate = safeSampleRate(sampleRate);
+    splitters_[0].prepare(rate);
+    splitters_[1].prepare(rate);
+    computer_.prepare(rate / static_cast<float>(kControlInterval));
+    reset();
+  }
+
+  void reset() {
+    splitters_[0].reset();
+    splitters_[1].reset();
+    computer_.reset();
+    peaks_.fill(0.0f);
+    gains_.fill(1.0f);
+    targets_.fill(1.0f);
+    previousTargets_.fill(1.0f);
+    steps_.fill(0.0f);
+    controlPhase_ = 0;
+  }
+
+  void setCrossover(size_t index, float frequencyHz) {
+    splitters_[0].setCrossover(index, frequencyHz);
+    splitters_[1].setCrossover(index, frequencyHz);
+  }
+
+  void setThresholdDb(size_t band, float db) { computer_.setThresholdDb(band, db); }
+  void setRatio(size_t band, float ratio) { computer_.setRatio(band, ratio); }
+  void setKneeWidthDb(size_t band, float db) { computer_.setKneeWidthDb(band, db); }
+  void setMakeupGainDb(size_t band, float db) { computer_.setMakeupGainDb(band, db); }
+  void setAttackRelease(size_t band, float attackMs, float releaseMs) {
+    computer_.setAttackRelease(band, attackMs, releaseMs);
+  }
+
+  [[nodiscard]] float crossover(size_t index) const { return splitters_[0].crossover(index); }
+  [[nodiscard]] float gainReductionDb(size_t band) const { return computer_.gainReductionDb(band); }
+
+  // In place.
+  void process(float* left, float* right, size_t frames) {
+    std::array<float, Bands> leftLanes{};
+    std::array<float, Bands> rightLanes{};
+    for (size_t n = 0; n < frames; ++n) {
+      if (controlPhase_ == 0) {
+        updateGains();
+      }
+      controlPhase_ = (controlPhase_ + 1) % kControlInterval;
+
+      splitters_[0].process(left[n], leftLanes);
+      splitters_[1].process(right[n], rightLanes);
+      float outLeft = 0.0f;
+      float outRight = 0.0f;
+      for (size_t b = 0; b < Bands; ++b) {
+        peaks_[b] = std::max(peaks_[b], std::max(std::fabs(leftLanes[b]), std::fabs(rightLanes[b])));
+        gains_[b] += steps_[b];
+        outLeft += leftLanes[b] * gains_[b];
+        outRight += rightLanes[b] * gains_[b];
+      }
+      left[n] = outLeft;
+      right[n] = outRight;
+    }
+  }
+
+ private:
+  void updateGains() {
+    computer_.process(peaks_, targets_);
+    constexpr float kInverseInterval = 1.0f / static_cast<float>(kControlInterval);
+    for (size_t b = 0; b < Bands; ++b) {
+      // Land exactly on the target at the end of the period; snap off any ramp rounding first.
+      gains_[b] = previousTargets_[b];
+      steps_[b] = (targets_[b] - gains_[b]) * kInverseInterval;
+      previousTargets_[b] = targets_[b];
+      peaks_[b] = 0.0f;
+    }
+  }
+
+  std::array<BandSplitter<Bands>, 2> splitters_{};
+  DecimatedGainComputer<Bands> computer_{};
+  std::array<float, Bands> peaks_{};
+  std::array<float, Bands> gains_{};
+  std::array<float, Bands> targets_{};
+  std::array<float, Bands> previousTargets_{};
+  std::array<float, Bands> steps_{};
+  size_t controlPhase_ = 0;
+};
+
+// Maximum of the last `window` values in O(1) amortized: a monotonic deque of (time, value)
+// where each value is larger than every later one, so the front is always the maximum.
+// Worst case one push pops the whole window, which is bounded by Capacity.
+template <size_t Capacity>
+class SlidingMaximum {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SlidingMaximum capacity must be a power of two");
+
+ public:
+  void setWindow(size_t window) {
+    window_ = std::max<size_t>(1, std::min(window, Capacity));
+    reset();
+  }
+
+  void reset() {
+    head_ = 0;
+    tail_ = 0;
+    time_ = 0;
+  }
+
+  float process(float value) {
+    while (tail_ != head_ && values_[(tail_ - 1) & kMask] <= value) {
+      --tail_;
+    }
+    values_[tail_ & kMask] = value;
+    times_[tail_ & kMask] = time_;
+    ++tail_;
+    // Unsigned differences stay correct across the 32-bit wrap.
+    while (time_ - times_[head_ & kMask] >= window_) {
+      ++head_;
+    }
+    ++time_;
+    return values_[head_ & kMask];
+  }
+
+  [[nodiscard]] size_t window() const { return window_; }
+
+ private:
+  static constexpr size_t kMask = Capacity - 1;
+
+  std::array<float, Capacity> values_{};
+  std::array<std::uint32_t, Capacity> times_{};
+  size_t window_ = Capacity;
+  size_t head_ = 0;
+  size_t tail_ = 0;
+  std::uint32_t time_ = 0;
+};
+
+// Stereo-linked lookahead brickwall limiter for the output stage. The signal is delayed by the
+// lookahead L; the gain each peak needs is held for L + 1 samples (SlidingMaximum), released
+// exponentially, then averaged over L samples. The average covers only gains already at or below
+// what the peak needs, so the gain has fully arrived when the peak leaves the delay, and the
+// attack is a smooth L-sample ramp instead of a step. Set the lookahead before playback; changing
+// it resets the state.
+template <size_t MaxLookahead = 128>
+class LookaheadLimiter {
+  static_assert(MaxLookahead > 0 && (MaxLookahead & (MaxLookahead - 1)) == 0,
+                "LookaheadLimiter lookahead capacity must be a power of two");
+
+ public:
+  // Starts with a full unity gain box, so an unprepared limiter passes audio through.
+  LookaheadLimiter() { reset(); }
+
+  void prepare(float sampleRate) {
+    sampleRate_ = safeSampleRate(sampleRate);
+    setCeilingDb(ceilingDb_);
+    setReleaseMs(releaseMs_);
+    setLookaheadMs(lookaheadMs_);
+  }
+
+  void reset() {
+    delayLeft_.fill(0.0f);
+    delayRight_.fill(0.0f);
+    box_.fill(1.0f);
+    boxSum_ = static_cast<float>(lookahead_);
+    boxFresh_ = 0.0f;
+    index_ = 0;
+    released_ = 1.0f;
+    gain_ = 1.0f;
+    peaks_.setWindow(lookahead_ + 1);
+  }
+
+  void setCeilingDb(float db) {
+    ceilingDb_ = clamp(db, -24.0f, 0.0f);
+    ceiling_ = dbToGain(ceilingDb_);
+  }
+
+  void setLookaheadMs(float ms) {
+    lookaheadMs_ = std::max(0.0f, ms);
+    const float samples = std::round(lookaheadMs_ * 0.001f * sampleRate_);
+    lookahead_ = static_cast<size_t>(clamp(samples, 1.0f, static_cast<float>(MaxLookahead)));
+    reset();
+  }
+
+  void setReleaseMs(float ms) {
+    releaseMs_ = std::max(0.001f, ms);
+    releaseCoeff_ = onePoleSmooth(releaseMs_, sampleRate_);
+  }
+
+  [[nodiscard]] float ceilingDb() const { return ceilingDb_; }
+  [[nodiscard]] size_t latencySamples() const { return lookahead_; }
+  [[nodiscard]] float gainReductionDb() const { return gainToDb(gain_); }
+
+  // In place, one frame.
+  void process(float& left, float& right) {
+    const float peak = peaks_.process(std::max(std::fabs(left), std::fabs(right)));
+    const float required = peak > ceiling_ ? ceiling_ / peak : 1.0f;
+    // Instant attack, exponential release toward the held requirement.
+    released_ = required < released_ ? required : required + releaseCoeff_ * (released_ - required);
+
+    // Running box sum, replaced by an exact re-sum whenever the ring wraps.
+    boxSum_ += released_ - box_[index_];
+    boxFresh_ += released_;
+    box_[index_] = released_;
+
+    const float delayedLeft = delayLeft_[index_];
+    const float delayedRight = delayRight_[index_];
+    delayLeft_[index_] = left;
+    delayRight_[index_] = right;
+    if (++index_ == lookahead_) {
+      index_ = 0;
+      boxSum_ = boxFresh_;
+      boxFresh_ = 0.0f;
+    }
+
+    gain_ = std::min(boxSum_ / static_cast<float>(lookahead_), 1.0f);
+    left = delayedLeft * gain_;
+    right = delayedRight * gain_;
+  }
+
+  void process(float* left, float* right, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+      process(left[i], right[i]);
+    }
+  }
+
+  // The whole output stage in one pass: limit and pack interleaved 24-in-32 words for I2S.
+  // left and right may alias (mono source); the inputs are not modified.
+  void processToInt24x32(const float* left, const float* right, int32_t* interleaved, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+      float l = left[i];
+      float r = right[i];
+      process(l, r);
+      interleaved[2 * i] = toInt24x32(l);
+      interleaved[2 * i + 1] = toInt24x32(r);
+    }
+  }
+
+ private:
+  float sampleRate_ = kDefaultSampleRate;
+  float ceilingDb_ = -0.3f;
+  float ceiling_ = 1.0f;
+  float lookaheadMs_ = 1.0f;
+  float releaseMs_ = 60.0f;
+  float releaseCoeff_ = 0.0f;
+  // The hold window is lookahead + 1 samples, so the deque needs more than MaxLookahead slots.
+  SlidingMaximum<2 * MaxLookahead> peaks_{};
+  std::array<float, MaxLookahead> delayLeft_{};
+  std::array<float, MaxLookahead> delayRight_{};
+  std::array<float, MaxLookahead> box_{};
+  float boxSum_ = 0.0f;
+  float boxFresh_ = 0.0f;
+  float released_ = 1.0f;
+  float gain_ = 1.0f;
+  size_t lookahead_ = 1;
+  size_t index_ = 0;
+};
+
 }  // namespace rpdsp
\ No newline at end of file
@@ -12,6 +12,9 @@
 
 namespace rpdsp {
 
+// Stack scratch for the block forms of the feedback filters: the largest RPDSP_BLOCK_SIZE.
+inline constexpr size_t kBlockChunk = 64;
+
 class Waveshaper {
  public:
   void setDrive(float drive) {
@@ -34,7 +37,7 @@ class Waveshaper {
   float outputGain_ = 1.0f;
 };
 
-template <size_t Capacity>
+template <size_t Capacity, typename Storage = FloatStorage>
 class Delay {
  public:
   void prepare(float sampleRate) {
@@ -61,7 +64,7 @@ class Delay {
   float delaySamples_ = 1.0f;
   float feedback_ = 0.0f;
   float mix_ = 0.5f;
-  DelayLine<Capacity> delay_;
+  DelayLine<Capacity, Storage> delay_;
 };
 
 template <size_t Capacity>
@@ -103,7 +106,7 @@ class Chorus {
   DelayLine<Capacity> delay_;
 };
 
-template <size_t Capacity>
+template <size_t Capacity, typename Storage = FloatStorage>
 class CombFilter {
  public:
   void reset() { delay_.reset(); }
@@ -117,13 +120,32 @@ class CombFilter {
     return delayed;
   }
 
+  // In-place block form. A chunk no longer than the loop only reads samples written
+  // before it, so each chunk is one block read, one arithmetic pass and one block write.
+  void process(float* buffer, size_t frames) {
+    const size_t chunkLimit = std::min(delaySamples_ + 1, kBlockChunk);
+    std::array<float, kBlockChunk> delayed;
+    while (frames > 0) {
+      const size_t count = std::min(frames, chunkLimit);
+      delay_.read(delayed.data(), count, delaySamples_ + 1 - count);
+      for (size_t i = 0; i < count; ++i) {
+        const float feed = buffer[i] + delayed[i] * feedback_;
+        buffer[i] = delayed[i];
+        delayed[i] = feed;
+      }
+      delay_.write(delayed.data(), count);
+      buffer += count;
+      frames -= count;
+    }
+  }
+
  private:
-  DelayLine<Capacity> delay_;
+  DelayLine<Capacity, Storage> delay_;
   size_t delaySamples_ = Capacity / 2;
   float feedback_ = 0.7f;
 };
 
-template <size_t Capacity>
+template <size_t Capacity, typename Storage = FloatStorage>
 class AllpassFilter {
  public:
   void reset() { delay_.reset(); }
@@ -138,12 +160,57 @@ class AllpassFilter {
     return delayed - feedback_ * bufferInput;
   }
 
+  // In-place block form; same chunking as CombFilter::process(float*, size_t).
+  void process(float* buffer, size_t frames) {
+    const size_t chunkLimit = std::min(delaySamples_ + 1, kBlockChunk);
+    std::array<float, kBlockChunk> delayed;
+    while (frames > 0) {
+      const size_t count = std::min(frames, chunkLimit);
+      delay_.read(delayed.data(), count, delaySamples_ + 1 - count);
+      for (size_t i = 0; i < count; ++i) {
+        const float bufferInput = buffer[i] + delayed[i] * feedback_;
+        buffer[i] = delayed[i] - feedback_ * bufferInput;
+        delayed[i] = bufferInput;
+      }
+      delay_.write(delayed.data(), count);
+      buffer += count;
+      frames -= count;
+    }
+  }
+
+  // Read inside the diffuser's delay memory; reverb output taps use this.
+  [[nodiscard]] float tap(size_t delaySamples) const { return delay_.read(delaySamples); }
+
  private:
-  DelayLine<Capacity> delay_;
+  DelayLine<Capacity, Storage> delay_;
   size_t delaySamples_ = Capacity / 2;
   float feedback_ = 0.5f;
 };
 
+template <size_t Capacity, typename Storage = FloatStorage>
+class ModulatedAllpassFilter {
+ public:
+  void reset() { delay_.reset(); }
+  void setDelaySamples(float samples) { delaySamples_ = clamp(samples, 0.0f, static_cast<float>(Capacity - 1)); }
+  void setFeedback(float feedback) { feedback_ = clamp(feedback, -0.99f, 0.99f); }
+
+  float process(float input, float modulationSamples) {
+    // Sweeping the read point smears the tank's resonant modes; the cubic read avoids the
+    // high-frequency loss a linear read would add on every pass around the loop.
+    const float delayed = delay_.readCubic(delaySamples_ + modulationSamples);
+    const float bufferInput = input + delayed * feedback_;
+    delay_.push(bufferInput);
+    return delayed - feedback_ * bufferInput;
+  }
+
+  [[nodiscard]] float tap(size_t delaySamples) const { return delay_.read(delaySamples); }
+
+ private:
+  DelayLine<Capacity, Storage> delay_;
+  float delaySamples_ = static_cast<float>(Capacity / 2);
+  float feedback_ = 0.5f;
+};
+
 class SchroederReverb {
  public:
   void prepare(float sampleRate) {
@@ -252,4 +319,237 @@ class StereoSchroederReverb {
   DelayLine<kRightPreDelayCapacity> rightPreDelay_;
 };
 
+// Dattorro plate ("Effect Design Part 1", JAES 1997): bandwidth filter, four input
+// diffusers, then a figure-eight tank whose two halves each run a modulated allpass,
+// a delay, damping, a second allpass and a second delay before feeding the other half.
+// The paper quotes lengths at 29761 Hz; capacities are scaled to MaxSampleRate at compile
+// time so the whole reverb is one fixed-size object (~147 KB at 48 kHz, see the catalog).
+// Running above MaxSampleRate keeps the capacities and shrinks the plate instead.
+// Storage applies to every tank and diffuser line; Q15Storage halves the footprint.
+template <size_t MaxSampleRate = 48000, size_t PreDelayCapacity = 1024, typename Storage = FloatStorage>
+class DattorroPlateReverb {
+  static_assert(MaxSampleRate >= 8000, "DattorroPlateReverb needs at least an 8 kHz tank");
+
+  static constexpr float kReferenceRate = 29761.0f;
+  static constexpr size_t scaled(size_t samplesAtReference) {
+    return (samplesAtReference * MaxSampleRate + 29760) / 29761 + 1;
+  }
+
+  // Paper lengths at 29761 Hz; tank excursion is the peak modulation depth.
+  static constexpr size_t kDiffuserLengths[4] = {142, 107, 379, 277};
+  static constexpr size_t kExcursion = 16;
+  static constexpr size_t kLeftModulatedLength = 672;
+  static constexpr size_t kLeftDelay1Length = 4453;
+  static constexpr size_t kLeftAllpassLength = 1800;
+  static constexpr size_t kLeftDelay2Length = 3720;
+  static constexpr size_t kRightModulatedLength = 908;
+  static constexpr size_t kRightDelay1Length = 4217;
+  static constexpr size_t kRightAllpassLength = 2656;
+  static constexpr size_t kRightDelay2Length = 3163;
+
+ public:
+  void prepare(float sampleRate) {
+    sampleRate_ = safeSampleRate(sampleRate);
+    scale_ = std::min(sampleRate_, static_cast<float>(MaxSampleRate)) / kReferenceRate;
+
+    diffuser1_.setDelaySamples(scaledDelay(kDiffuserLengths[0]));
+    diffuser2_.setDelaySamples(scaledDelay(kDiffuserLengths[1]));
+    diffuser3_.setDelaySamples(scaledDelay(kDiffuserLengths[2]));
+    diffuser4_.setDelaySamples(scaledDelay(kDiffuserLengths[3]));
+    leftModulated_.setDelaySamples(static_cast<float>(scaledDelay(kLeftModulatedLength)));
+    rightModulated_.setDelaySamples(static_cast<float>(scaledDelay(kRightModulatedLength)));
+    leftAllpass_.setDelaySamples(scaledDelay(kLeftAllpassLength));
+    rightAllpass_.setDelaySamples(scaledDelay(kRightAllpassLength));
+    leftDelay1Samples_ = scaledDelay(kLeftDelay1Length);
+    leftDelay2Samples_ = scaledDelay(kLeftDelay2Length);
+    rightDelay1Samples_ = scaledDelay(kRightDelay1Length);
+    rightDelay2Samples_ = scaledDelay(kRightDelay2Length);
+
+    // Output taps from table 2 of the paper, in the same order as the sums in process().
+    static constexpr size_t kTapOffsets[14] = {266, 2974, 1913, 1996, 1990, 187, 1066,
+                                               353, 3627, 1228, 2673, 2111, 335, 121};
+    for (size_t i = 0; i < 14; ++i) {
+      taps_[i] = scaledDelay(kTapOffsets[i]);
+    }
+
+    setDiffusion(inputDiffusion_);
+    setModDepth(modDepth_);
+    bandwidth_.prepare(sampleRate_);
+    bandwidth_.setCutoff(bandwidthHz_);
+    leftDamping_.prepare(sampleRate_);
+    rightDamping_.prepare(sampleRate_);
+    setDamping(damping_);
+    lfo_.prepare(sampleRate_);
+    lfo_.setFreq(modRateHz_);
+    setPreDelayMilliseconds(preDelayMs_);
+    reset();
+  }
+
+  void reset() {
+    preDelay_.reset();
+    bandwidth_.reset();
+    diffuser1_.reset();
+    diffuser2_.reset();
+    diffuser3_.reset();
+    diffuser4_.reset();
+    leftModulated_.reset();
+    rightModulated_.reset();
+    leftDelay1_.reset();
+    rightDelay1_.reset();
+    leftDamping_.reset();
+    rightDamping_.reset();
+    leftAllpass_.reset();
+    rightAllpass_.reset();
+    leftDelay2_.reset();
+    rightDelay2_.reset();
+    lfo_.reset();
+  }
+
+  // Tank gain per pass; values near 1 give very long tails.
+  void setDecay(float decay) { decay_ = clamp(decay, 0.0f, 0.99f); }
+
+  // 0 leaves the tank bright; 1 rolls each pass off at roughly 1 kHz.
+  void setDamping(float damping) {
+    damping_ = clamp01(damping);
+    const float cutoffHz = 18000.0f * std::pow(1000.0f / 18000.0f, damping_);
+    leftDamping_.setCutoff(cutoffHz);
+    rightDamping_.setCutoff(cutoffHz);
+  }
+
+  void setBandwidthHz(float hz) {
+    bandwidthHz_ = hz;
+    bandwidth_.setCutoff(bandwidthHz_);
+  }
+
+  // Scales the paper's input (0.75/0.625) and decay (0.7/0.5) diffusion coefficients.
+  void setDiffusion(float amount) {
+    inputDiffusion_ = clamp01(amount);
+    diffuser1_.setFeedback(0.75f * inputDiffusion_);
+    diffuser2_.setFeedback(0.75f * inputDiffusion_);
+    diffuser3_.setFeedback(0.625f * inputDiffusion_);
+    diffuser4_.setFeedback(0.625f * inputDiffusion_);
+    // The paper inverts the first tank allpass relative to the input diffusers.
+    leftModulated_.setFeedback(-0.7f * inputDiffusion_);
+    rightModulated_.setFeedback(-0.7f * inputDiffusion_);
+    leftAllpass_.setFeedback(0.5f * inputDiffusion_);
+    rightAllpass_.setFeedback(0.5f * inputDiffusion_);
+  }
+
+  void setModDepth(float depth) {
+    modDepth_ = clamp01(depth);
+    excursionSamples_ = modDepth_ * static_cast<float>(kExcursion) * scale_ * 0.5f;
+  }
+
+  void setModRate(float hz) {
+    modRateHz_ = std::max(0.01f, hz);
+    lfo_.setFreq(modRateHz_);
+  }
+
+  void setPreDelayMilliseconds(float milliseconds) {
+    preDelayMs_ = std::max(0.0f, milliseconds);
+    const auto samples = static_cast<size_t>(preDelayMs_ * 0.001f * sampleRate_);
+    preDelaySamples_ = samples < PreDelayCapacity ? samples : PreDelayCapacity - 1;
+  }
+
+  void setMix(float mix) { mix_ = clamp01(mix); }
+
+  std::array<float, 2> process(float leftInput, float rightInput) {
+    // The plate is mono-in: the stereo image comes entirely from the output taps.
+    const float pre = preDelay_.read(preDelaySamples_);
+    preDelay_.push((leftInput + rightInput) * 0.5f);
+
+    float diffused = bandwidth_.process(pre);
+    diffused = diffuser1_.process(diffused);
+    diffused = diffuser2_.process(diffused);
+    diffused = diffuser3_.process(diffused);
+    diffused = diffuser4_.process(diffused);
+
+    // Each half is fed by the far end of the other half, which closes the figure eight.
+    const float leftTail = leftDelay2_.read(leftDelay2Samples_);
+    const float rightTail = rightDelay2_.read(rightDelay2Samples_);
+    // Centre the excursion on the nominal length so the tank tuning stays put on average.
+    const float modulation = excursionSamples_ * lfo_.process();
+
+    const float leftIn = leftModulated_.process(diffused + decay_ * rightTail, modulation);
+    const float leftDelayed = leftDelay1_.read(leftDelay1Samples_);
+    leftDelay1_.push(leftIn);
+    const float leftMid = leftAllpass_.process(decay_ * leftDamping_.process(leftDelayed));
+    leftDelay2_.push(zapDenormal(leftMid));
+
+    const float rightIn = rightModulated_.process(diffused + decay_ * leftTail, -modulation);
+    const float rightDelayed = rightDelay1_.read(rightDelay1Samples_);
+    rightDelay1_.push(rightIn);
+    const float rightMid = rightAllpass_.process(decay_ * rightDamping_.process(rightDelayed));
+    rightDelay2_.push(zapDenormal(rightMid));
+
+    // Taps are spread across both halves so each output decorrelates from the other.
+    const float wetLeft = 0.6f * (rightDelay1_.read(taps_[0]) + rightDelay1_.read(taps_[1]) -
+                                  rightAllpass_.tap(taps_[2]) + rightDelay2_.read(taps_[3]) -
+                                  leftDelay1_.read(taps_[4]) - leftAllpass_.tap(taps_[5]) -
+                                  leftDelay2_.read(taps_[6]));
+    const float wetRight = 0.6f * (leftDelay1_.read(taps_[7]) + leftDelay1_.read(taps_[8]) -
+                                   leftAllpass_.tap(taps_[9]) + leftDelay2_.read(taps_[10]) -
+                                   rightDelay1_.read(taps_[11]) - rightAllpass_.tap(taps_[12]) -
+                                   rightDelay2_.read(taps_[13]));
+
+    return {lerp(leftInput, wetLeft, mix_), lerp(rightInput, wetRight, mix_)};
+  }
+
+  // Single-precision block loop; inputs and outputs may alias.
+#if defined(__GNUC__)
+  __attribute__((optimize("unroll-loops")))
+#endif
+  void process(const float* leftIn, const float* rightIn, float* leftOut, float* rightOut, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+      const std::array<float, 2> out = process(leftIn[i], rightIn[i]);
+      leftOut[i] = out[0];
+      rightOut[i] = out[1];
+    }
+  }
+
+ private:
+  // Paper length -> read index at the prepared rate; read(n) is an n + 1 sample delay.
+  [[nodiscard]] size_t scaledDelay(size_t samplesAtReference) const {
+    const auto samples = static_cast<size_t>(static_cast<float>(samplesAtReference) * scale_ + 0.5f);
+    return samples > 1 ? samples - 1 : 0;
+  }
+
+  float sampleRate_ = kDefaultSampleRate;
+  float scale_ = kDefaultSampleRate / kReferenceRate;
+  float decay_ = 0.5f;
+  float damping_ = 0.3f;
+  float bandwidthHz_ = 10000.0f;
+  float inputDiffusion_ = 1.0f;
+  float modDepth_ = 0.5f;
+  float modRateHz_ = 1.0f;
+  float excursionSamples_ = 0.0f;
+  float preDelayMs_ = 0.0f;
+  float mix_ = 0.25f;
+  size_t preDelaySamples_ = 0;
+  size_t leftDelay1Samples_ = 0;
+  size_t leftDelay2Samples_ = 0;
+  size_t rightDelay1Samples_ = 0;
+  size_t rightDelay2Samples_ = 0;
+  std::array<size_t, 14> taps_{};
+
+  OnePoleLowpass bandwidth_;
+  OnePoleLowpass leftDamping_;
+  OnePoleLowpass rightDamping_;
+  // Triangle LFO: the tank only needs a slow smooth sweep, not a per-sample std::sin.
+  TriangleOscillator lfo_;
+  DelayLine<PreDelayCapacity, Storage> preDelay_;
+  AllpassFilter<scaled(kDiffuserLengths[0]), Storage> diffuser1_;
+  AllpassFilter<scaled(kDiffuserLengths[1]), Storage> diffuser2_;
+  AllpassFilter<scaled(kDiffuserLengths[2]), Storage> diffuser3_;
+  AllpassFilter<scaled(kDiffuserLengths[3]), Storage> diffuser4_;
+  ModulatedAllpassFilter<scaled(kLeftModulatedLength + kExcursion) + 2, Storage> leftModulated_;
+  ModulatedAllpassFilter<scaled(kRightModulatedLength + kExcursion) + 2, Storage> rightModulated_;
+  DelayLine<scaled(kLeftDelay1Length), Storage> leftDelay1_;
+  DelayLine<scaled(kRightDelay1Length), Storage> rightDelay1_;
+  AllpassFilter<scaled(kLeftAllpassLength), Storage> leftAllpass_;
+  AllpassFilter<scaled(kRightAllpassLength), Storage> rightAllpass_;
+  DelayLine<scaled(kLeftDelay2Length), Storage> leftDelay2_;
+  DelayLine<scaled(kRightDelay2Length), Storage> rightDelay2_;
+};
+
 }  // namespace rpdsp
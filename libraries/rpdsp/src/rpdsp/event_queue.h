@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace rpdsp {
+
+// One control event for the audio graph. time is an absolute frame on the audio core's clock
+// (see EventQueue::now()); number is the MIDI note, CC number or parameter id, and value the
+// velocity, 0..1 CC value or parameter value.
+struct Event {
+  enum class Type : std::uint8_t { kNoteOn, kNoteOff, kParameter, kControlChange };
+
+  static constexpr std::uint16_t kAllNotes = 0xffff;
+
+  std::uint32_t time = 0;
+  Type type = Type::kNoteOn;
+  std::uint8_t channel = 0;
+  std::uint16_t number = 0;
+  float value = 0.0f;
+
+  static Event noteOn(std::uint32_t time, int note, float velocity, int channel = 0) {
+    return {time, Type::kNoteOn, toByte(channel), toByte(note), velocity};
+  }
+  // note < 0 releases every note, matching TriggeredSynthVoice::noteOff's wildcard.
+  static Event noteOff(std::uint32_t time, int note = -1, int channel = 0) {
+    return {time, Type::kNoteOff, toByte(channel), note < 0 ? kAllNotes : std::uint16_t{toByte(note)}, 0.0f};
+  }
+  static Event parameter(std::uint32_t time, std::uint16_t id, float value) {
+    return {time, Type::kParameter, 0, id, value};
+  }
+  static Event controlChange(std::uint32_t time, int controller, float value, int channel = 0) {
+    return {time, Type::kControlChange, toByte(channel), toByte(controller), value};
+  }
+
+  // The note as TriggeredSynthVoice takes it, with kAllNotes mapped back to -1.
+  [[nodiscard]] int note() const { return number == kAllNotes ? -1 : static_cast<int>(number); }
+
+ private:
+  static std::uint8_t toByte(int value) { return static_cast<std::uint8_t>(std::min(std::max(value, 0), 127)); }
+};
+
+// Wait-free single-producer single-consumer event ring from the control core into the audio
+// graph. The control core stamps each event with a frame time and push()es it; the audio core
+// calls process() once per block, which splits the render at every event that falls inside the
+// block and applies it at its exact sample offset. Events must be pushed in time order; one that
+// is already late is applied at the start of the next block rendered.
+//
+// For jitter-free timing, stamp events a fixed latency ahead of now(), at least one block (plus
+// the control loop's own period) so they never arrive late. Slots are plain memory ordered by
+// the acquire/release indices, so nothing is shared that both cores write.
+template <size_t Capacity = 64>
+class EventQueue {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "EventQueue capacity must be a power of two");
+
+ public:
+  static constexpr size_t kCapacity = Capacity;
+
+  // Not realtime-safe: only while neither core is using the queue.
+  void reset(std::uint32_t time = 0) {
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    time_.store(time, std::memory_order_release);
+  }
+
+  // Control core. False when the ring is full; the event is dropped, never overwritten.
+  bool push(const Event& event) {
+    const std::uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    slots_[tail & kMask] = event;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // First frame of the block the audio core will render next. Readable from either core.
+  [[nodiscard]] std::uint32_t now() const { return time_.load(std::memory_order_acquire); }
+
+  [[nodiscard]] size_t size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+
+  // Audio core. Renders frames by calling render(offset, count) for each span between events
+  // and apply(event) at each boundary, then advances now() by frames. Events scheduled past this
+  // block stay queued. Bounded by Capacity applies per block.
+  template <typename Apply, typename Render>
+  void process(size_t frames, Apply&& apply, Render&& render) {
+    const std::uint32_t start = time_.load(std::memory_order_relaxed);
+    const std::uint32_t tail = tail_.load(std::memory_order_acquire);
+    std::uint32_t head = head_.load(std::memory_order_relaxed);
+    size_t rendered = 0;
+    for (; head != tail; ++head) {
+      const Event& event = slots_[head & kMask];
+      // Wrap-safe signed distance, so the 32-bit clock (~24 hours at 48 kHz) can roll over.
+      const std::int32_t delta = static_cast<std::int32_t>(event.time - start);
+      if (delta >= static_cast<std::int32_t>(frames)) {
+        break;
+      }
+      const size_t offset = std::max(static_cast<size_t>(std::max(delta, std::int32_t{0})), rendered);
+      if (offset > rendered) {
+        render(rendered, offset - rendered);
+        rendered = offset;
+      }
+      apply(event);
+    }
+    // Released before the tail render so the control core sees free slots as early as possible.
+    head_.store(head, std::memory_order_release);
+    if (rendered < frames) {
+      render(rendered, frames - rendered);
+    }
+    time_.store(start + static_cast<std::uint32_t>(frames), std::memory_order_release);
+  }
+
+ private:
+  static constexpr std::uint32_t kMask = static_cast<std::uint32_t>(Capacity - 1);
+
+  std::array<Event, Capacity> slots_{};
+  std::atomic<std::uint32_t> head_{0};  // written by the audio core only
+  std::atomic<std::uint32_t> tail_{0};  // written by the control core only
+  std::atomic<std::uint32_t> time_{0};  // written by the audio core only
+};
+
+}  // namespace rpdsp
@@ -0,0 +1,299 @@
+#pragma once
+
+#include "config.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace rpdsp {
+
+namespace fft_detail {
+
+// Compile-time sine/cosine for twiddle tables. Evaluated in double and only ever at
+// compile time, so the tables land in flash/rodata with no startup cost.
+constexpr double kPiDouble = 3.14159265358979323846;
+
+constexpr double taylorSin(double x) {
+  // |x| <= pi/4 after reduction, so 12 terms are far below float precision.
+  double term = x;
+  double sum = x;
+  for (int n = 1; n < 12; ++n) {
+    term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double taylorCos(double x) {
+  double term = 1.0;
+  double sum = 1.0;
+  for (int n = 1; n < 12; ++n) {
+    term *= -x * x / static_cast<double>((2 * n - 1) * (2 * n));
+    sum += term;
+  }
+  return sum;
+}
+
+// cos/sin of 2*pi*k/n, reduced by octant so the series always converges quickly.
+constexpr double unitCos(size_t k, size_t n);
+
+constexpr double unitSin(size_t k, size_t n) {
+  k %= n;
+  if (8 * k <= n) {
+    return taylorSin(2.0 * kPiDouble * static_cast<double>(k) / static_cast<double>(n));
+  }
+  if (4 * k <= n) {
+    return unitCos(n / 4 - k, n);
+  }
+  if (2 * k <= n) {
+    return unitSin(n / 2 - k, n);
+  }
+  return -unitSin(k - n / 2, n);
+}
+
+constexpr double unitCos(size_t k, size_t n) {
+  k %= n;
+  if (8 * k <= n) {
+    return taylorCos(2.0 * kPiDouble * static_cast<double>(k) / static_cast<double>(n));
+  }
+  if (4 * k <= n) {
+    return unitSin(n / 4 - k, n);
+  }
+  if (2 * k <= n) {
+    return -unitCos(n / 2 - k, n);
+  }
+  return -unitCos(k - n / 2, n);
+}
+
+}  // namespace fft_detail
+
+// In-place real FFT of N samples (power of two), built as an N/2-point complex radix-2 FFT
+// plus a split pass. Twiddle and bit-reversal tables are constexpr statics, so they live in
+// flash; there is no allocation and no per-instance state.
+//
+// Packed spectrum layout (also used by the multiply helpers and the convolver):
+//   data[0] = Re X[0], data[1] = Re X[N/2], data[2k] = Re X[k], data[2k + 1] = Im X[k].
+// inverse() scales by 1/N, so inverse(forward(x)) == x.
+template <size_t N>
+class RealFft {
+  static_assert(N >= 8 && (N & (N - 1)) == 0, "RealFft size must be a power of two >= 8");
+
+  static constexpr size_t kHalf = N / 2;
+
+  static constexpr size_t log2Half() {
+    size_t bits = 0;
+    while ((size_t{1} << bits) < kHalf) {
+      ++bits;
+    }
+    return bits;
+  }
+
+  static constexpr std::array<float, kHalf> makeCos() {
+    std::array<float, kHalf> table{};
+    for (size_t k = 0; k < kHalf; ++k) {
+      table[k] = static_cast<float>(fft_detail::unitCos(k, N));
+    }
+    return table;
+  }
+
+  static constexpr std::array<float, kHalf> makeSin() {
+    std::array<float, kHalf> table{};
+    for (size_t k = 0; k < kHalf; ++k) {
+      table[k] = static_cast<float>(fft_detail::unitSin(k, N));
+    }
+    return table;
+  }
+
+  static constexpr std::array<std::uint16_t, kHalf> makeBitReverse() {
+    std::array<std::uint16_t, kHalf> table{};
+    size_t bits = 0;
+    while ((size_t{1} << bits) < kHalf) {
+      ++bits;
+    }
+    for (size_t i = 0; i < kHalf; ++i) {
+      size_t reversed = 0;
+      for (size_t b = 0; b < bits; ++b) {
+        reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+      }
+      table[i] = static_cast<std::uint16_t>(reversed);
+    }
+    return table;
+  }
+
+  // W_N^k = cos(2 pi k / N) - i sin(2 pi k / N), for k < N/2.
+  static constexpr std::array<float, kHalf> kCos = makeCos();
+  static constexpr std::array<float, kHalf> kSin = makeSin();
+  static constexpr std::array<std::uint16_t, kHalf> kBitReverse = makeBitReverse();
+
+ public:
+  static constexpr size_t kSize = N;
+
+  // Rough Cortex-M33 estimate for one forward or inverse call: ~6 cycles per N log2 N
+  // (butterfly loads/stores dominate the single-cycle FPU ops). Host timing in the catalog.
+  static constexpr size_t estimatedCycles() {
+    size_t log2N = 0;
+    while ((size_t{1} << log2N) < N) {
+      ++log2N;
+    }
+    return 6 * N * log2N;
+  }
+
+  // forward()/inverse() broken into kSteps bounded pieces (a permutation, one radix-2 stage,
+  // or the split pass, each ~N/2 butterflies), so a large transform can be spread across
+  // audio blocks. Running steps 0..kSteps-1 in order equals one forward()/inverse() call.
+  static constexpr size_t kSteps = log2Half() + 2;
+
+  static void forwardStep(float* data, size_t step) {
+    if (step == 0) {
+      bitReverse(data);
+    } else if (step <= log2Half()) {
+      butterflyStage(data, size_t{1} << (step - 1), -1.0f);
+    } else {
+      splitForward(data);
+    }
+  }
+
+  static void inverseStep(float* data, size_t step) {
+    if (step == 0) {
+      splitInverse(data);
+    } else if (step == 1) {
+      bitReverse(data);
+    } else if (step < kSteps) {
+      butterflyStage(data, size_t{1} << (step - 2), 1.0f);
+    }
+    if (step + 1 == kSteps) {
+      scale(data);
+    }
+  }
+
+  static void forward(float* data) {
+    complexTransform(data, false);
+    splitForward(data);
+  }
+
+  static void inverse(float* data) {
+    splitInverse(data);
+    complexTransform(data, true);
+    scale(data);
+  }
+
+  // acc += a * b on packed spectra (one partition of a frequency-domain convolution).
+  static void multiplyAccumulate(const float* a, const float* b, float* acc) {
+    acc[0] += a[0] * b[0];
+    acc[1] += a[1] * b[1];
+    for (size_t k = 2; k < N; k += 2) {
+      acc[k] += a[k] * b[k] - a[k + 1] * b[k + 1];
+      acc[k + 1] += a[k] * b[k + 1] + a[k + 1] * b[k];
+    }
+  }
+
+ private:
+  static void splitForward(float* data) {
+    // Split the N/2-point transform of the even/odd-packed signal into the N-point spectrum.
+    const float dc = data[0];
+    const float odd0 = data[1];
+    data[0] = dc + odd0;
+    data[1] = dc - odd0;
+    for (size_t k = 1; k <= kHalf / 2; ++k) {
+      const size_t j = kHalf - k;
+      const float zkr = data[2 * k];
+      const float zki = data[2 * k + 1];
+      const float zjr = data[2 * j];
+      const float zji = data[2 * j + 1];
+      // Even part E = (Z[k] + conj Z[j]) / 2, odd part O = (Z[k] - conj Z[j]) / 2i.
+      const float er = 0.5f * (zkr + zjr);
+      const float ei = 0.5f * (zki - zji);
+      const float or_ = 0.5f * (zki + zji);
+      const float oi = -0.5f * (zkr - zjr);
+      const float wr = kCos[k];
+      const float wi = -kSin[k];
+      const float tr = or_ * wr - oi * wi;
+      const float ti = or_ * wi + oi * wr;
+      data[2 * k] = er + tr;
+      data[2 * k + 1] = ei + ti;
+      data[2 * j] = er - tr;
+      data[2 * j + 1] = -(ei - ti);
+    }
+  }
+
+  static void splitInverse(float* data) {
+    // Undo the split: rebuild Z[k] = E[k] + i W^-k O[k] from X[k] and X[N/2 - k].
+    const float x0 = data[0];
+    const float xn = data[1];
+    data[0] = 0.5f * (x0 + xn);
+    data[1] = 0.5f * (x0 - xn);
+    for (size_t k = 1; k <= kHalf / 2; ++k) {
+      const size_t j = kHalf - k;
+      const float xkr = data[2 * k];
+      const float xki = data[2 * k + 1];
+      const float xjr = data[2 * j];
+      const float xji = -data[2 * j + 1];
+      const float er = 0.5f * (xkr + xjr);
+      const float ei = 0.5f * (xki + xji);
+      const float dr = 0.5f * (xkr - xjr);
+      const float di = 0.5f * (xki - xji);
+      // O = (X[k] - conj X[N/2-k]) W^-k / 2
+      const float wr = kCos[k];
+      const float wi = kSin[k];
+      const float or_ = dr * wr - di * wi;
+      const float oi = dr * wi + di * wr;
+      // Z[k] = E + i O, Z[j] = conj(E - i O)
+      data[2 * k] = er - oi;
+      data[2 * k + 1] = ei + or_;
+      data[2 * j] = er + oi;
+      data[2 * j + 1] = -(ei - or_);
+    }
+  }
+
+  static void scale(float* data) {
+    const float gain = 1.0f / static_cast<float>(kHalf);
+    for (size_t i = 0; i < N; ++i) {
+      data[i] *= gain;
+    }
+  }
+
+  // Iterative radix-2 decimation-in-time over N/2 interleaved complex values.
+  static void complexTransform(float* data, bool inverseDirection) {
+    bitReverse(data);
+    const float sign = inverseDirection ? 1.0f : -1.0f;
+    for (size_t span = 1; span < kHalf; span <<= 1) {
+      butterflyStage(data, span, sign);
+    }
+  }
+
+  static void bitReverse(float* data) {
+    for (size_t i = 0; i < kHalf; ++i) {
+      const size_t r = kBitReverse[i];
+      if (r > i) {
+        const float tr = data[2 * i];
+        const float ti = data[2 * i + 1];
+        data[2 * i] = data[2 * r];
+        data[2 * i + 1] = data[2 * r + 1];
+        data[2 * r] = tr;
+        data[2 * r + 1] = ti;
+      }
+    }
+  }
+
+  static void butterflyStage(float* data, size_t span, float sign) {
+    // Stage twiddles are W_{2 span}^j = W_N^{j * N / (2 span)}.
+    const size_t stride = kHalf / span;
+    for (size_t start = 0; start < kHalf; start += 2 * span) {
+      for (size_t j = 0; j < span; ++j) {
+        const float wr = kCos[j * stride];
+        const float wi = sign * kSin[j * stride];
+        const size_t a = 2 * (start + j);
+        const size_t b = a + 2 * span;
+        const float tr = data[b] * wr - data[b + 1] * wi;
+        const float ti = data[b] * wi + data[b + 1] * wr;
+        data[b] = data[a] - tr;
+        data[b + 1] = data[a + 1] - ti;
+        data[a] += tr;
+        data[a + 1] += ti;
+      }
+    }
+  }
+};
+
+}  // namespace rpdsp
@@ -126,6 +126,41 @@ class BiquadLowpass {
   float z2_ = 0.0f;
 };
 
+// Normalized (a0 == 1) biquad coefficients; designed off the audio path.
+struct BiquadCoefficients {
+  float b0 = 1.0f;
+  float b1 = 0.0f;
+  float b2 = 0.0f;
+  float a1 = 0.0f;
+  float a2 = 0.0f;
+};
+
+// Fixed-coefficient biquad for filters whose design lives elsewhere (K-weighting, crossovers).
+class Biquad {
+ public:
+  void setCoefficients(const BiquadCoefficients& coefficients) { c_ = coefficients; }
+
+  [[nodiscard]] const BiquadCoefficients& coefficients() const { return c_; }
+
+  void reset() {
+    z1_ = 0.0f;
+    z2_ = 0.0f;
+  }
+
+  float process(float input) {
+    // Same transposed direct form II as BiquadLowpass.
+    const float out = (c_.b0 * input) + z1_;
+    z1_ = (c_.b1 * input) - (c_.a1 * out) + z2_;
+    z2_ = (c_.b2 * input) - (c_.a2 * out);
+    return zapDenormal(out);
+  }
+
+ private:
+  BiquadCoefficients c_{};
+  float z1_ = 0.0f;
+  float z2_ = 0.0f;
+};
+
 struct StateVariableOutput {
   float lowpass = 0.0f;
   float bandpass = 0.0f;
@@ -0,0 +1,411 @@
+#pragma once
+
+#include "algorithm.h"
+#include "filter.h"
+#include "realtime.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace rpdsp {
+
+// Sliding-window RMS at kDefaultBlockSize granularity. Each segment's sum of squares enters a
+// running sum and the oldest leaves it, so a reading is O(1). Add/subtract rounding would
+// drift over hours, so a second sum restarts every time the ring wraps; at that point it holds
+// exactly the current window and replaces the running sum. MaxSegments bounds memory, not the
+// window: 512 segments of 32 samples cover 341 ms at 48 kHz in 2 KB.
+template <size_t MaxSegments = 512>
+class WindowedRmsMeter {
+  static_assert(MaxSegments > 0, "WindowedRmsMeter needs at least one segment");
+
+ public:
+  void prepare(float sampleRate, float windowSeconds = 0.3f) {
+    const float samples = safeSampleRate(sampleRate) * std::max(windowSeconds, 0.0f);
+    const float segments = std::round(samples / static_cast<float>(kDefaultBlockSize));
+    segments_ = static_cast<size_t>(clamp(segments, 1.0f, static_cast<float>(MaxSegments)));
+    reset();
+  }
+
+  void reset() {
+    ring_.fill(0.0f);
+    sum_ = 0.0f;
+    fresh_ = 0.0f;
+    partial_ = 0.0f;
+    partialCount_ = 0;
+    index_ = 0;
+  }
+
+  void process(float sample) {
+    partial_ += sample * sample;
+    if (++partialCount_ == kDefaultBlockSize) {
+      pushSegment();
+    }
+  }
+
+  void process(const float* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      process(samples[i]);
+    }
+  }
+
+  // Until the first window has passed, the missing segments count as silence.
+  [[nodiscard]] float rms() const {
+    return std::sqrt(std::max(sum_, 0.0f) / static_cast<float>(windowSamples()));
+  }
+
+  [[nodiscard]] float rmsDb() const { return gainToDb(rms()); }
+  [[nodiscard]] size_t windowSamples() const { return segments_ * kDefaultBlockSize; }
+
+ private:
+  void pushSegment() {
+    sum_ += partial_ - ring_[index_];
+    ring_[index_] = partial_;
+    fresh_ += partial_;
+    if (++index_ == segments_) {
+      index_ = 0;
+      sum_ = fresh_;
+      fresh_ = 0.0f;
+    }
+    partial_ = 0.0f;
+    partialCount_ = 0;
+  }
+
+  std::array<float, MaxSegments> ring_{};
+  float sum_ = 0.0f;
+  float fresh_ = 0.0f;
+  float partial_ = 0.0f;
+  size_t partialCount_ = 0;
+  size_t segments_ = MaxSegments;
+  size_t index_ = 0;
+};
+
+// 4x oversampled peak estimate (ITU-R BS.1770 style). A 48-tap Kaiser-windowed sinc split into
+// four 12-tap phases evaluates the waveform between samples, catching overs that a sample-peak
+// meter misses by up to ~3 dB. Passband is flat within 0.01 dB to 0.2 fs and -0.5 dB at 0.35 fs,
+// so near-Nyquist content reads slightly low. 48 multiplies per sample per channel.
+class TruePeakDetector {
+ public:
+  static constexpr size_t kTaps = 12;
+
+  void reset() {
+    history_.fill(0.0f);
+    index_ = 0;
+    peak_ = 0.0f;
+  }
+
+  // Clears the held peak but keeps the interpolator history.
+  void resetPeak() { peak_ = 0.0f; }
+
+  float process(float input) {
+    // Written twice so every phase reads one contiguous span, newest first.
+    index_ = index_ == 0 ? kTaps - 1 : index_ - 1;
+    history_[index_] = input;
+    history_[index_ + kTaps] = input;
+    const float* x = history_.data() + index_;
+
+    float peak = std::fabs(input);
+    for (const auto& phase : kPhases) {
+      float sum = 0.0f;
+      for (size_t k = 0; k < kTaps; ++k) {
+        sum += phase[k] * x[k];
+      }
+      peak = std::max(peak, std::fabs(sum));
+    }
+    peak_ = std::max(peak_, peak);
+    return peak;
+  }
+
+  void process(const float* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      process(samples[i]);
+    }
+  }
+
+  [[nodiscard]] float truePeak() const { return peak_; }
+  [[nodiscard]] float truePeakDb() const { return gainToDb(peak_); }
+
+ private:
+  // Phase p holds h[4k + p] of the prototype, each phase normalized for unity DC gain.
+  static constexpr std::array<std::array<float, kTaps>, 4> kPhases = {{
+      {-0.000632457f, 0.005918094f, -0.021513864f, 0.053138206f, -0.106034881f, 0.211754879f,
+       0.879751556f, -0.010032951f, -0.028088073f, 0.024630019f, -0.012896646f, 0.004006118f},
+      {-0.000312321f, 0.004369744f, -0.020388471f, 0.062051275f, -0.157158117f, 0.484148098f,
+       0.732244732f, -0.134982620f, 0.035236523f, -0.004148195f, -0.002394897f, 0.001334249f},
+      {0.001334249f, -0.002394897f, -0.004148195f, 0.035236523f, -0.134982620f, 0.732244732f,
+       0.484148098f, -0.157158117f, 0.062051275f, -0.020388471f, 0.004369744f, -0.000312321f},
+      {0.004006118f, -0.012896646f, 0.024630019f, -0.028088073f, -0.010032951f, 0.879751556f,
+       0.211754879f, -0.106034881f, 0.053138206f, -0.021513864f, 0.005918094f, -0.000632457f},
+  }};
+
+  std::array<float, 2 * kTaps> history_{};
+  size_t index_ = 0;
+  float peak_ = 0.0f;
+};
+
+// EBU R128 / ITU-R BS.1770-4 stereo loudness. K-weighting (high shelf + RLB high-pass) feeds
+// 100 ms sub-blocks of mean square energy; momentary is the last 4 (400 ms), short-term the
+// last 30 (3 s). Integrated loudness keeps a 0.1 LU histogram of 400 ms blocks above the -70
+// LUFS absolute gate and re-applies the -10 LU relative gate from the counts every sub-block,
+// so memory is fixed however long the programme runs.
+class LoudnessMeter {
+ public:
+  static constexpr size_t kMomentaryBlocks = 4;
+  static constexpr size_t kShortTermBlocks = 30;
+  static constexpr size_t kHistogramBins = 700;
+  static constexpr float kAbsoluteGateLufs = -70.0f;
+  static constexpr float kRelativeGateLu = -10.0f;
+  // Reported for silence and before any block passes the gates.
+  static constexpr float kSilenceLufs = -120.0f;
+
+  // BS.1770 stage 1 at any rate: the 48 kHz reference filter re-derived by bilinear transform.
+  static BiquadCoefficients kWeightingShelf(float sampleRate) {
+    const double f0 = 1681.974450955533;
+    const double gainDb = 3.999843853973347;
+    const double q = 0.7071752369554196;
+    const double k = std::tan(3.14159265358979323846 * f0 / safeSampleRate(sampleRate));
+    const double vh = std::pow(10.0, gainDb / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    const double a0 = 1.0 + k / q + k * k;
+    BiquadCoefficients c;
+    c.b0 = static_cast<float>((vh + vb * k / q + k * k) / a0);
+    c.b1 = static_cast<float>(2.0 * (k * k - vh) / a0);
+    c.b2 = static_cast<float>((vh - vb * k / q + k * k) / a0);
+    c.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+    c.a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+    return c;
+  }
+
+  // BS.1770 stage 2 (revised low-frequency B-curve); the numerator stays 1, -2, 1.
+  static BiquadCoefficients kWeightingHighPass(float sampleRate) {
+    const double f0 = 38.13547087602444;
+    const double q = 0.5003270373238773;
+    const double k = std::tan(3.14159265358979323846 * f0 / safeSampleRate(sampleRate));
+    const double a0 = 1.0 + k / q + k * k;
+    BiquadCoefficients c;
+    c.b0 = 1.0f;
+    c.b1 = -2.0f;
+    c.b2 = 1.0f;
+    c.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+    c.a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+    return c;
+  }
+
+  static float loudnessFromEnergy(float energy) {
+    constexpr float kMinEnergy = 1.0e-12f;
+    if (energy <= kMinEnergy) {
+      return kSilenceLufs;
+    }
+    return -0.691f + 10.0f * std::log10(energy);
+  }
+
+  void prepare(float sampleRate) {
+    const float rate = safeSampleRate(sampleRate);
+    const BiquadCoefficients shelf = kWeightingShelf(rate);
+    const BiquadCoefficients highPass = kWeightingHighPass(rate);
+    for (size_t ch = 0; ch < 2; ++ch) {
+      shelf_[ch].setCoefficients(shelf);
+      highPass_[ch].setCoefficients(highPass);
+    }
+    subBlockSamples_ = std::max<size_t>(1, static_cast<size_t>(std::lround(rate * 0.1f)));
+    reset();
+  }
+
+  void reset() {
+    for (size_t ch = 0; ch < 2; ++ch) {
+      shelf_[ch].reset();
+      highPass_[ch].reset();
+    }
+    subBlocks_.fill(0.0f);
+    subBlockIndex_ = 0;
+    subBlocksSeen_ = 0;
+    accumulator_ = 0.0f;
+    accumulated_ = 0;
+    momentary_ = kSilenceLufs;
+    shortTerm_ = kSilenceLufs;
+    resetIntegrated();
+  }
+
+  void resetIntegrated() {
+    histogram_.fill(0);
+    integrated_ = kSilenceLufs;
+  }
+
+  void process(float left, float right) {
+    const float l = highPass_[0].process(shelf_[0].process(left));
+    const float r = highPass_[1].process(shelf_[1].process(right));
+    // Left and right both carry channel weight 1.0.
+    accumulator_ += l * l + r * r;
+    if (++accumulated_ == subBlockSamples_) {
+      finishSubBlock();
+    }
+  }
+
+  void process(const float* left, const float* right, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+      process(left[i], right[i]);
+    }
+  }
+
+  // Windows not yet filled treat the missing sub-blocks as silence.
+  [[nodiscard]] float momentaryLufs() const { return momentary_; }
+  [[nodiscard]] float shortTermLufs() const { return shortTerm_; }
+  [[nodiscard]] float integratedLufs() const { return integrated_; }
+  [[nodiscard]] size_t subBlockSamples() const { return subBlockSamples_; }
+
+ private:
+  void finishSubBlock() {
+    subBlocks_[subBlockIndex_] = accumulator_ / static_cast<float>(subBlockSamples_);
+    accumulator_ = 0.0f;
+    accumulated_ = 0;
+
+    // Re-summing 30 floats each 100 ms is cheaper than tracking a running sum and never drifts.
+    float momentary = 0.0f;
+    float shortTerm = 0.0f;
+    size_t index = subBlockIndex_;
+    for (size_t i = 0; i < kShortTermBlocks; ++i) {
+      shortTerm += subBlocks_[index];
+      if (i < kMomentaryBlocks) {
+        momentary += subBlocks_[index];
+      }
+      index = index == 0 ? kShortTermBlocks - 1 : index - 1;
+    }
+    subBlockIndex_ = subBlockIndex_ + 1 == kShortTermBlocks ? 0 : subBlockIndex_ + 1;
+    momentary_ = loudnessFromEnergy(momentary / static_cast<float>(kMomentaryBlocks));
+    shortTerm_ = loudnessFromEnergy(shortTerm / static_cast<float>(kShortTermBlocks));
+
+    // Gating blocks are the 400 ms windows at 75% overlap, i.e. one per full momentary window.
+    if (subBlocksSeen_ < kMomentaryBlocks) {
+      ++subBlocksSeen_;
+    }
+    if (subBlocksSeen_ == kMomentaryBlocks && momentary_ > kAbsoluteGateLufs) {
+      const float position = (momentary_ - kAbsoluteGateLufs) * 10.0f;
+      const size_t bin = std::min(static_cast<size_t>(position), kHistogramBins - 1);
+      ++histogram_[bin];
+      integrated_ = gatedLoudness();
+    }
+  }
+
+  float gatedLoudness() const {
+    // Bin centre energies follow a geometric series, so no pow() and no table per bin.
+    const float step = std::pow(10.0f, 0.01f);
+    const float firstEnergy = std::pow(10.0f, (kAbsoluteGateLufs + 0.05f + 0.691f) / 10.0f);
+
+    float energy = firstEnergy;
+    float total = 0.0f;
+    std::uint32_t count = 0;
+    for (size_t i = 0; i < kHistogramBins; ++i, energy *= step) {
+      total += static_cast<float>(histogram_[i]) * energy;
+      count += histogram_[i];
+    }
+    if (count == 0) {
+      return kSilenceLufs;
+    }
+
+    const float gate = loudnessFromEnergy(total / static_cast<float>(count)) + kRelativeGateLu;
+    const float gatePosition = std::ceil((gate - kAbsoluteGateLufs) * 10.0f - 0.5f);
+    const size_t firstBin = static_cast<size_t>(clamp(gatePosition, 0.0f, static_cast<float>(kHistogramBins)));
+    energy = firstEnergy * std::pow(step, static_cast<float>(firstBin));
+    total = 0.0f;
+    count = 0;
+    for (size_t i = firstBin; i < kHistogramBins; ++i, energy *= step) {
+      total += static_cast<float>(histogram_[i]) * energy;
+      count += histogram_[i];
+    }
+    return count > 0 ? loudnessFromEnergy(total / static_cast<float>(count)) : kSilenceLufs;
+  }
+
+  std::array<Biquad, 2> shelf_{};
+  std::array<Biquad, 2> highPass_{};
+  std::array<float, kShortTermBlocks> subBlocks_{};
+  std::array<std::uint32_t, kHistogramBins> histogram_{};
+  float accumulator_ = 0.0f;
+  float momentary_ = kSilenceLufs;
+  float shortTerm_ = kSilenceLufs;
+  float integrated_ = kSilenceLufs;
+  size_t subBlockSamples_ = 4800;
+  size_t accumulated_ = 0;
+  size_t subBlockIndex_ = 0;
+  size_t subBlocksSeen_ = 0;
+};
+
+// One consistent set of meter values; true peak covers the span since the previous publication.
+struct MeterReadings {
+  float rmsLeftDb = -240.0f;
+  float rmsRightDb = -240.0f;
+  float truePeakDb = -240.0f;
+  float momentaryLufs = LoudnessMeter::kSilenceLufs;
+  float shortTermLufs = LoudnessMeter::kSilenceLufs;
+  float integratedLufs = LoudnessMeter::kSilenceLufs;
+};
+static_assert(std::is_trivially_copyable_v<MeterReadings>, "MeterReadings is published through a Seqlock");
+
+// Stereo meter bundle for the audio core. process() runs in the callback and publishes through a
+// Seqlock every publish interval, so a UI on the other core reads a whole, untorn snapshot
+// without ever blocking the writer. Peak hold/decay belongs to the reader.
+template <size_t RmsSegments = 512>
+class StereoMeter {
+ public:
+  void prepare(float sampleRate, float rmsWindowSeconds = 0.3f, float publishIntervalSeconds = 0.05f) {
+    const float rate = safeSampleRate(sampleRate);
+    rms_[0].prepare(rate, rmsWindowSeconds);
+    rms_[1].prepare(rate, rmsWindowSeconds);
+    loudness_.prepare(rate);
+    const float interval = std::max(publishIntervalSeconds, 0.0f) * rate;
+    publishIntervalSamples_ = std::max<size_t>(1, static_cast<size_t>(interval));
+    reset();
+  }
+
+  void reset() {
+    rms_[0].reset();
+    rms_[1].reset();
+    peak_[0].reset();
+    peak_[1].reset();
+    loudness_.reset();
+    samplesSincePublish_ = 0;
+  }
+
+  void process(const float* left, const float* right, size_t frames) {
+    rms_[0].process(left, frames);
+    rms_[1].process(right, frames);
+    peak_[0].process(left, frames);
+    peak_[1].process(right, frames);
+    loudness_.process(left, right, frames);
+
+    samplesSincePublish_ += frames;
+    if (samplesSincePublish_ >= publishIntervalSamples_) {
+      samplesSincePublish_ = 0;
+      publish();
+    }
+  }
+
+  // Reader side: call load() / tryLoad() from any core.
+  [[nodiscard]] const Seqlock<MeterReadings>& readings() const { return readings_; }
+
+  [[nodiscard]] LoudnessMeter& loudness() { return loudness_; }
+  [[nodiscard]] const LoudnessMeter& loudness() const { return loudness_; }
+
+ private:
+  void publish() {
+    MeterReadings readings;
+    readings.rmsLeftDb = rms_[0].rmsDb();
+    readings.rmsRightDb = rms_[1].rmsDb();
+    readings.truePeakDb = gainToDb(std::max(peak_[0].truePeak(), peak_[1].truePeak()));
+    readings.momentaryLufs = loudness_.momentaryLufs();
+    readings.shortTermLufs = loudness_.shortTermLufs();
+    readings.integratedLufs = loudness_.integratedLufs();
+    readings_.store(readings);
+    peak_[0].resetPeak();
+    peak_[1].resetPeak();
+  }
+
+  std::array<WindowedRmsMeter<RmsSegments>, 2> rms_{};
+  std::array<TruePeakDetector, 2> peak_{};
+  LoudnessMeter loudness_{};
+  Seqlock<MeterReadings> readings_{};
+  size_t publishIntervalSamples_ = 2400;
+  size_t samplesSincePublish_ = 0;
+};
+
+}  // namespace rpdsp
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 namespace rpdsp {
 
@@ -34,4 +39,109 @@ class XorShift32 {
   std::uint32_t state_;
 };
 
+// Single-writer, many-reader publication of a small trivially copyable value between
+// cores. store() never waits; load() retries only while a store is in flight, which is a
+// few dozen cycles. The payload is held in 32-bit atomic words, so it stays lock-free on
+// Cortex-M33 (no 64-bit exclusives) and free of data races on the host.
+template <typename T>
+class Seqlock {
+  static_assert(std::is_trivially_copyable_v<T>, "Seqlock payload must be trivially copyable");
+
+  static constexpr size_t kWords = (sizeof(T) + sizeof(std::uint32_t) - 1) / sizeof(std::uint32_t);
+
+ public:
+  Seqlock() { store(T{}); }
+
+  void store(const T& value) {
+    std::array<std::uint32_t, kWords> words{};
+    std::memcpy(words.data(), &value, sizeof(T));
+    const std::uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    // Odd while writing; the fence keeps the word stores after the odd mark.
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  // One attempt; false if a store overlapped the copy.
+  bool tryLoad(T& value) const {
+    const std::uint32_t before = sequence_.load(std::memory_order_acquire);
+    if (before & 1u) {
+      return false;
+    }
+    std::array<std::uint32_t, kWords> words{};
+    for (size_t i = 0; i < kWords; ++i) {
+      words[i] = words_[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) != before) {
+      return false;
+    }
+    // Through void*: payloads with default member initializers are trivially copyable but not
+    // trivial, and GCC's -Wclass-memaccess would flag a typed destination.
+    std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+    return true;
+  }
+
+  [[nodiscard]] T load() const {
+    T value{};
+    while (!tryLoad(value)) {
+    }
+    return value;
+  }
+
+  // Number of completed stores; lets a reader skip work when nothing changed.
+  [[nodiscard]] std::uint32_t version() const { return sequence_.load(std::memory_order_acquire) >> 1; }
+
+ private:
+  std::atomic<std::uint32_t> sequence_{0};
+  std::array<std::atomic<std::uint32_t>, kWords> words_{};
+};
+
+// Single-writer, single-reader publication of a whole parameter struct from the control core to
+// the audio core. A triple buffer: each side owns one slot and they trade through the third
+// with one atomic exchange, so neither side ever waits or retries. Unlike Seqlock the reader
+// cannot be held up by a writer interrupted mid-store, which suits the audio callback. The
+// audio core calls update() once per block and reads current() into locals; the slot it holds
+// stays untouched until its next update(). The roles also work the other way round, for the
+// audio core publishing state that the control core displays.
+template <typename T>
+class ParameterSnapshot {
+  static_assert(std::is_copy_assignable<T>::value, "ParameterSnapshot payload must be copy-assignable");
+
+ public:
+  explicit ParameterSnapshot(const T& initial = T{}) { slots_.fill(initial); }
+
+  // Control core. Overwrites a value the audio core has not picked up yet.
+  void publish(const T& value) {
+    slots_[write_] = value;
+    const std::uint32_t previous = state_.exchange(write_ | kFresh, std::memory_order_acq_rel);
+    write_ = previous & kIndexMask;
+  }
+
+  // Audio core. Takes the newest published value, if any; true when current() changed.
+  bool update() {
+    if ((state_.load(std::memory_order_relaxed) & kFresh) == 0) {
+      return false;
+    }
+    const std::uint32_t previous = state_.exchange(read_, std::memory_order_acq_rel);
+    read_ = previous & kIndexMask;
+    return true;
+  }
+
+  // Audio core. The value taken by the last update().
+  [[nodiscard]] const T& current() const { return slots_[read_]; }
+
+ private:
+  static constexpr std::uint32_t kIndexMask = 3u;
+  static constexpr std::uint32_t kFresh = 4u;
+
+  std::array<T, 3> slots_{};
+  std::atomic<std::uint32_t> state_{1};  // the shared slot's index, plus kFresh once published
+  std::uint32_t write_ = 2;              // control core only
+  std::uint32_t read_ = 0;               // audio core only
+};
+
 }  // namespace rpdsp
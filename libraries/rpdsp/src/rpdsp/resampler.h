@@ -0,0 +1,259 @@
+#pragma once
+
+#include "algorithm.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace rpdsp {
+
+// Largest drift correction PolyphaseResampler accepts: +-1 %, far beyond any crystal pair.
+constexpr float kMaxResampleCorrection = 0.01f;
+
+namespace resampler_detail {
+
+// Zeroth-order modified Bessel function of the first kind, for the Kaiser window.
+inline double besselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  const double quarterSquare = 0.25 * x * x;
+  for (int k = 1; k < 32 && term > 1.0e-12 * sum; ++k) {
+    term *= quarterSquare / (static_cast<double>(k) * static_cast<double>(k));
+    sum += term;
+  }
+  return sum;
+}
+
+}  // namespace resampler_detail
+
+// Polyphase windowed-sinc sample-rate converter: a fixed nominal ratio set in prepare(), plus a
+// small runtime correction for clock drift. The Kaiser-windowed (beta 8) prototype is tabulated
+// at Phases sub-sample offsets; each output interpolates the coefficient row for its exact
+// offset once and shares it across channels, so any ratio is handled, not just L/M fractions.
+// The position is a 32.32 fixed-point accumulator, so a long stream never drifts from rounding.
+//
+// The filter's whole transition band sits below the lower rate's Nyquist, so anything that
+// would alias or image is down at least 80 dB. Between nearby rates (44.1/48 kHz, 32 -> 48 kHz,
+// drift correction) the passband (-0.1 dB) reaches 0.34 fs with the default 32 taps and 0.42 fs
+// with 64; spurs from the sub-sample interpolation stay below about -70 dB up to 0.3 fs. The
+// taps span input samples, so decimating narrows the passband by the ratio: use 64 taps for
+// 96 -> 48 kHz (flat to 0.34 of the output rate). Cost per output frame: Taps interpolations
+// plus Channels x Taps multiply-adds, an estimated ~160 cycles for stereo at 32 taps on the
+// M33 (~4 % of a core at 48 kHz); not measured on hardware.
+template <size_t Channels = 2, size_t Taps = 32, size_t Phases = 32>
+class PolyphaseResampler {
+  static_assert(Channels >= 1, "PolyphaseResampler needs at least one channel");
+  static_assert(Taps >= 8 && Taps % 2 == 0, "PolyphaseResampler taps must be even and at least 8");
+  static_assert(Phases >= 2 && (Phases & (Phases - 1)) == 0, "PolyphaseResampler phases must be a power of two");
+
+ public:
+  static constexpr size_t kChannels = Channels;
+  static constexpr size_t kTaps = Taps;
+  static constexpr size_t kPhases = Phases;
+  // Group delay, in input samples.
+  static constexpr size_t kLatencySamples = Taps / 2;
+  // Input samples per output sample, either way. Decimating past about Taps / 8 : 1 leaves the
+  // transition band too wide to fit below the output Nyquist, and some aliasing returns.
+  static constexpr float kMaxRatio = 8.0f;
+  // Half the Kaiser transition band in cycles per input sample; it narrows as 1 / Taps.
+  static constexpr double kHalfTransition = 3.2 / static_cast<double>(Taps);
+  static constexpr double kKaiserBeta = 8.0;
+
+  // Designs the coefficient table; not for the audio callback (a few thousand sin/exp calls).
+  void prepare(float inputRate, float outputRate) {
+    inputRate_ = safeSampleRate(inputRate);
+    outputRate_ = safeSampleRate(outputRate);
+    nominalRatio_ = clamp(inputRate_ / outputRate_, 1.0f / kMaxRatio, kMaxRatio);
+    // The stopband starts at the lower rate's Nyquist, so nothing aliases or images.
+    const double nyquist = 0.5 * std::min(1.0, 1.0 / static_cast<double>(nominalRatio_));
+    design(std::max(nyquist - kHalfTransition, 0.25 * nyquist));
+    setRatioCorrection(0.0f);
+    reset();
+  }
+
+  void reset() {
+    for (auto& history : history_) {
+      history.fill(0.0f);
+    }
+    index_ = 0;
+    frac_ = 0;
+    need_ = 1;
+  }
+
+  // Relative speed-up of the input consumption, e.g. +200e-6 when the source runs 200 ppm fast.
+  // Realtime-safe; takes effect at the next output frame.
+  void setRatioCorrection(float correction) {
+    correction_ = clamp(correction, -kMaxResampleCorrection, kMaxResampleCorrection);
+    const double ratio = static_cast<double>(nominalRatio_) * (1.0 + static_cast<double>(correction_));
+    step_ = static_cast<uint64_t>(std::llround(ratio * 4294967296.0));
+  }
+
+  [[nodiscard]] float inputSampleRate() const { return inputRate_; }
+  [[nodiscard]] float outputSampleRate() const { return outputRate_; }
+  [[nodiscard]] float ratioCorrection() const { return correction_; }
+  // Input samples consumed per output sample, including the correction.
+  [[nodiscard]] float ratio() const { return static_cast<float>(static_cast<double>(step_) / 4294967296.0); }
+
+  // Exactly how many input frames the next outputFrames outputs consume; rendering that many at
+  // the input rate and passing them to process() fills the output block with nothing left over.
+  [[nodiscard]] size_t inputFramesFor(size_t outputFrames) const {
+    if (outputFrames == 0) {
+      return 0;
+    }
+    return need_ + static_cast<size_t>((static_cast<uint64_t>(frac_) + (outputFrames - 1) * step_) >> 32);
+  }
+
+  // Consumes input until it runs out or the output is full. Returns the frames written; consumed
+  // receives the input frames read. Leftover input is the caller's to offer again.
+  size_t process(const float* const* input, size_t inputFrames, float* const* output, size_t outputFrames,
+                 size_t& consumed) {
+    size_t in = 0;
+    size_t out = 0;
+    for (;;) {
+      for (; need_ > 0; --need_) {
+        if (in == inputFrames) {
+          consumed = in;
+          return out;
+        }
+        push(input, in++);
+      }
+      if (out == outputFrames) {
+        break;
+      }
+      render(output, out++);
+      const uint64_t next = static_cast<uint64_t>(frac_) + step_;
+      need_ = static_cast<size_t>(next >> 32);
+      frac_ = static_cast<uint32_t>(next);
+    }
+    consumed = in;
+    return out;
+  }
+
+ private:
+  static constexpr unsigned kPhaseBits = [] {
+    unsigned bits = 0;
+    while ((size_t{1} << bits) < Phases) {
+      ++bits;
+    }
+    return bits;
+  }();
+
+  // cutoff in cycles per input sample. Row p is the kernel at a sub-sample offset of p / Phases,
+  // so row Phases is row 0 moved by one whole sample and interpolation never wraps.
+  void design(double cutoff) {
+    const double half = 0.5 * static_cast<double>(Taps);
+    const double window = resampler_detail::besselI0(kKaiserBeta);
+    for (size_t p = 0; p <= Phases; ++p) {
+      float* row = table_.data() + p * Taps;
+      double sum = 0.0;
+      std::array<double, Taps> coefficients{};
+      for (size_t k = 0; k < Taps; ++k) {
+        const double t = static_cast<double>(k) - half + static_cast<double>(p) / static_cast<double>(Phases);
+        const double x = 2.0 * cutoff * t;
+        const double sinc = std::fabs(x) < 1.0e-12 ? 1.0 : std::sin(static_cast<double>(kPi) * x) / (static_cast<double>(kPi) * x);
+        const double r = t / half;
+        const double w = r * r < 1.0 ? resampler_detail::besselI0(kKaiserBeta * std::sqrt(1.0 - r * r)) / window : 0.0;
+        coefficients[k] = sinc * w;
+        sum += coefficients[k];
+      }
+      // Each row normalized for unity DC gain, so a constant input comes out unchanged.
+      for (size_t k = 0; k < Taps; ++k) {
+        row[k] = static_cast<float>(coefficients[k] / sum);
+      }
+    }
+  }
+
+  void push(const float* const* input, size_t frame) {
+    // Written twice so the taps read one contiguous span, newest first.
+    index_ = index_ == 0 ? Taps - 1 : index_ - 1;
+    for (size_t c = 0; c < Channels; ++c) {
+      history_[c][index_] = input[c][frame];
+      history_[c][index_ + Taps] = input[c][frame];
+    }
+  }
+
+  void render(float* const* output, size_t frame) {
+    const size_t phase = frac_ >> (32 - kPhaseBits);
+    const float blend = static_cast<float>(static_cast<uint32_t>(frac_ << kPhaseBits)) * (1.0f / 4294967296.0f);
+    const float* a = table_.data() + phase * Taps;
+    const float* b = a + Taps;
+    std::array<float, Taps> coefficients;
+    for (size_t k = 0; k < Taps; ++k) {
+      coefficients[k] = a[k] + blend * (b[k] - a[k]);
+    }
+    for (size_t c = 0; c < Channels; ++c) {
+      const float* x = history_[c].data() + index_;
+      float sum = 0.0f;
+      for (size_t k = 0; k < Taps; ++k) {
+        sum += coefficients[k] * x[k];
+      }
+      output[c][frame] = sum;
+    }
+  }
+
+  std::array<float, (Phases + 1) * Taps> table_{};
+  std::array<std::array<float, 2 * Taps>, Channels> history_{};
+  size_t index_ = 0;
+  uint32_t frac_ = 0;  // position of the next output past the centre tap, 0.32
+  size_t need_ = 1;    // input frames to push before the next output
+  uint64_t step_ = uint64_t{1} << 32;
+  float nominalRatio_ = 1.0f;
+  float correction_ = 0.0f;
+  float inputRate_ = kDefaultSampleRate;
+  float outputRate_ = kDefaultSampleRate;
+};
+
+// Keeps a FIFO between two clock domains (an external ADC or S/PDIF stream into the local I2S
+// clock) at a target fill by steering PolyphaseResampler::setRatioCorrection. Call update() once
+// per block with the FIFO's fill in input frames, measured at the same point in every block.
+// A PI loop tuned for critical damping: settleSeconds is its time constant. The fill reading is
+// smoothed first, so block-sized steps in it do not turn into audible pitch wobble.
+class ResampleDriftController {
+ public:
+  void prepare(float sampleRate, float updateRate, float targetFill, float settleSeconds = 1.0f) {
+    sampleRate_ = safeSampleRate(sampleRate);
+    const float tau = std::max(settleSeconds, 0.01f);
+    const float dt = 1.0f / std::max(updateRate, 1.0f);
+    target_ = std::max(targetFill, 0.0f);
+    // Plant: the fill integrates -sampleRate x correction; these gains put both poles at -1/tau.
+    kp_ = 2.0f / (sampleRate_ * tau);
+    ki_ = dt / (sampleRate_ * tau * tau);
+    smoothing_ = std::min(1.0f, 8.0f * dt / tau);
+    reset();
+  }
+
+  void reset() {
+    smoothedFill_ = target_;
+    integral_ = 0.0f;
+    correction_ = 0.0f;
+  }
+
+  // Returns the correction to hand to the resampler.
+  float update(float fill) {
+    smoothedFill_ += smoothing_ * (fill - smoothedFill_);
+    const float error = smoothedFill_ - target_;
+    // Anti-windup: the integral alone may not ask for more than the resampler can apply.
+    integral_ = clamp(integral_ + ki_ * error, -kMaxResampleCorrection, kMaxResampleCorrection);
+    correction_ = clamp(kp_ * error + integral_, -kMaxResampleCorrection, kMaxResampleCorrection);
+    return correction_;
+  }
+
+  [[nodiscard]] float correction() const { return correction_; }
+  // The steady-state estimate of the clock mismatch, e.g. 200e-6 for a source 200 ppm fast.
+  [[nodiscard]] float drift() const { return integral_; }
+  [[nodiscard]] float smoothedFill() const { return smoothedFill_; }
+
+ private:
+  float sampleRate_ = kDefaultSampleRate;
+  float target_ = 0.0f;
+  float kp_ = 0.0f;
+  float ki_ = 0.0f;
+  float smoothing_ = 1.0f;
+  float smoothedFill_ = 0.0f;
+  float integral_ = 0.0f;
+  float correction_ = 0.0f;
+};
+
+}  // namespace rpdsp
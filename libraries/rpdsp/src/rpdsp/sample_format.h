@@ -0,0 +1,201 @@
+#pragma once
+
+#include "algorithm.h"
+#include "realtime.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#endif
+
+namespace rpdsp {
+
+// Output-stage kernels: planar (SoA) float blocks in, interleaved I2S words out, one pass.
+// Results are bit-identical to the scalar toInt24x32 / toInt16 loop on every path; SSE2 and
+// NEON handle four frames per iteration on host builds. On Cortex-M33 the win is the single
+// pass plus one 32-bit store per dithered S16 frame, with SSAT for the saturation.
+
+namespace sample_format_detail {
+
+inline int32_t saturate16(int32_t value) {
+#if defined(__ARM_FEATURE_SAT)
+  return __ssat(value, 16);
+#else
+  return std::max<int32_t>(-32768, std::min<int32_t>(value, 32767));
+#endif
+}
+
+// Two S16 samples in one word, left in the low half: little-endian memory order L, R.
+// Compiles to PKHBT on cores with the DSP extension.
+inline uint32_t packStereo16(int32_t left, int32_t right) {
+  return (static_cast<uint32_t>(left) & 0xffffu) | (static_cast<uint32_t>(right) << 16);
+}
+
+}  // namespace sample_format_detail
+
+inline void interleaveToInt24x32(const float* left, const float* right, int32_t* interleaved, size_t frames) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128 low = _mm_set1_ps(-1.0f);
+  const __m128 high = _mm_set1_ps(1.0f);
+  const __m128 scale = _mm_set1_ps(8388607.0f);
+  for (; i + 4 <= frames; i += 4) {
+    // Operand order reproduces clamp()'s std::min/std::max results exactly.
+    const __m128 l = _mm_max_ps(_mm_min_ps(high, _mm_loadu_ps(left + i)), low);
+    const __m128 r = _mm_max_ps(_mm_min_ps(high, _mm_loadu_ps(right + i)), low);
+    const __m128i li = _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(l, scale)), 8);
+    const __m128i ri = _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(r, scale)), 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(interleaved + 2 * i), _mm_unpacklo_epi32(li, ri));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(interleaved + 2 * i + 4), _mm_unpackhi_epi32(li, ri));
+  }
+#elif defined(__ARM_NEON)
+  const float32x4_t low = vdupq_n_f32(-1.0f);
+  const float32x4_t high = vdupq_n_f32(1.0f);
+  for (; i + 4 <= frames; i += 4) {
+    const float32x4_t l = vmaxq_f32(vminq_f32(vld1q_f32(left + i), high), low);
+    const float32x4_t r = vmaxq_f32(vminq_f32(vld1q_f32(right + i), high), low);
+    int32x4x2_t words;
+    words.val[0] = vshlq_n_s32(vcvtq_s32_f32(vmulq_n_f32(l, 8388607.0f)), 8);
+    words.val[1] = vshlq_n_s32(vcvtq_s32_f32(vmulq_n_f32(r, 8388607.0f)), 8);
+    vst2q_s32(interleaved + 2 * i, words);
+  }
+#endif
+  for (; i < frames; ++i) {
+    interleaved[2 * i] = toInt24x32(left[i]);
+    interleaved[2 * i + 1] = toInt24x32(right[i]);
+  }
+}
+
+// Planar channels -> TDM slots for a 4/8-channel DAC: one 24-in-32 word per slot, slot c of
+// frame i at slots[i * slotsPerFrame + c]. Slots past channelCount are zeroed so unused DAC
+// outputs stay silent. Channel-outer order keeps every source read sequential; the strided
+// stores cost nothing extra on the M33's uncached SRAM.
+inline void interleaveToTdm24x32(const float* const* channels, size_t channelCount, int32_t* slots, size_t frames,
+                                 size_t slotsPerFrame) {
+  channelCount = std::min(channelCount, slotsPerFrame);
+  if (channelCount == 2 && slotsPerFrame == 2) {
+    interleaveToInt24x32(channels[0], channels[1], slots, frames);
+    return;
+  }
+  for (size_t c = 0; c < slotsPerFrame; ++c) {
+    int32_t* out = slots + c;
+    if (c < channelCount) {
+      const float* in = channels[c];
+      for (size_t i = 0; i < frames; ++i) {
+        out[i * slotsPerFrame] = toInt24x32(in[i]);
+      }
+    } else {
+      for (size_t i = 0; i < frames; ++i) {
+        out[i * slotsPerFrame] = 0;
+      }
+    }
+  }
+}
+
+inline void interleaveToInt16(const float* left, const float* right, int16_t* interleaved, size_t frames) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128 low = _mm_set1_ps(-1.0f);
+  const __m128 high = _mm_set1_ps(1.0f);
+  const __m128 scale = _mm_set1_ps(32767.0f);
+  const __m128 bias = _mm_set1_ps(32768.5f);
+  const __m128i unbias = _mm_set1_epi32(32768);
+  for (; i + 4 <= frames; i += 4) {
+    const __m128 l = _mm_max_ps(_mm_min_ps(high, _mm_loadu_ps(left + i)), low);
+    const __m128 r = _mm_max_ps(_mm_min_ps(high, _mm_loadu_ps(right + i)), low);
+    const __m128i li = _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(l, scale), bias)), unbias);
+    const __m128i ri = _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, scale), bias)), unbias);
+    // packs saturates to int16 (a no-op after the clamp); unpack interleaves L, R.
+    const __m128i packed = _mm_packs_epi32(li, ri);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(interleaved + 2 * i),
+                     _mm_unpacklo_epi16(packed, _mm_srli_si128(packed, 8)));
+  }
+#elif defined(__ARM_NEON)
+  const float32x4_t low = vdupq_n_f32(-1.0f);
+  const float32x4_t high = vdupq_n_f32(1.0f);
+  const float32x4_t bias = vdupq_n_f32(32768.5f);
+  const int32x4_t unbias = vdupq_n_s32(32768);
+  for (; i + 4 <= frames; i += 4) {
+    const float32x4_t l = vmaxq_f32(vminq_f32(vld1q_f32(left + i), high), low);
+    const float32x4_t r = vmaxq_f32(vminq_f32(vld1q_f32(right + i), high), low);
+    int16x4x2_t samples;
+    samples.val[0] = vqmovn_s32(vsubq_s32(vcvtq_s32_f32(vmlaq_n_f32(bias, l, 32767.0f)), unbias));
+    samples.val[1] = vqmovn_s32(vsubq_s32(vcvtq_s32_f32(vmlaq_n_f32(bias, r, 32767.0f)), unbias));
+    vst2_s16(interleaved + 2 * i, samples);
+  }
+#endif
+  for (; i < frames; ++i) {
+    interleaved[2 * i] = toInt16(left[i]);
+    interleaved[2 * i + 1] = toInt16(right[i]);
+  }
+}
+
+// Stereo float -> interleaved S16 with optional TPDF dither and first-order noise shaping.
+// TPDF dither (two uniform draws, +-1 LSB) turns the truncation distortion of quiet tails into
+// a constant, signal-independent hiss. Error feedback then shapes that hiss by (1 - z^-1),
+// moving it toward Nyquist where the ear is least sensitive: unchanged at fs/6, about -18 dB
+// at 1 kHz (48 kHz rate), +6 dB at Nyquist.
+class Int16OutputStage {
+ public:
+  explicit Int16OutputStage(std::uint32_t seed = 0x2545f491u) : noise_(seed) {}
+
+  void reset() { error_.fill(0.0f); }
+
+  void setDither(bool enabled) { dither_ = enabled; }
+  void setNoiseShaping(bool enabled) {
+    noiseShaping_ = enabled;
+    reset();
+  }
+
+  [[nodiscard]] bool dither() const { return dither_; }
+  [[nodiscard]] bool noiseShaping() const { return noiseShaping_; }
+
+  void process(const float* left, const float* right, int16_t* interleaved, size_t frames) {
+    if (!dither_ && !noiseShaping_) {
+      interleaveToInt16(left, right, interleaved, frames);
+      return;
+    }
+    for (size_t i = 0; i < frames; ++i) {
+      const int32_t l = quantize(left[i], 0);
+      const int32_t r = quantize(right[i], 1);
+      const uint32_t word = sample_format_detail::packStereo16(l, r);
+      std::memcpy(interleaved + 2 * i, &word, sizeof(word));
+    }
+  }
+
+ private:
+  int32_t quantize(float sample, size_t channel) {
+    float tpdf = 0.0f;
+    if (dither_) {
+      // Same draw as Q15Storage: the two 16-bit halves are the two uniforms (+/-1 LSB).
+      const std::uint32_t r = noise_.nextU32();
+      tpdf = static_cast<float>(static_cast<int32_t>(r & 0xFFFFu) + static_cast<int32_t>(r >> 16) - 65535) *
+             (1.0f / 65536.0f);
+    }
+    const float wanted = clamp(sample, -1.0f, 1.0f) * 32767.0f - error_[channel];
+    const int32_t quantized =
+        sample_format_detail::saturate16(static_cast<int32_t>(wanted + tpdf + 32768.5f) - 32768);
+    if (noiseShaping_) {
+      // Clipping at full scale would otherwise feed back a large error and ring.
+      error_[channel] = clamp(static_cast<float>(quantized) - wanted, -2.0f, 2.0f);
+    }
+    return quantized;
+  }
+
+  XorShift32 noise_;
+  std::array<float, 2> error_{};
+  bool dither_ = true;
+  bool noiseShaping_ = false;
+};
+
+}  // namespace rpdsp
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "algorithm.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace rpdsp {
+
+// Coordinates a runtime sample-rate change between the audio core, the control core and the
+// I2S driver. The graph is never touched by both cores at once and no block is heard at the
+// wrong clock:
+//
+//   control: request(rate)                   audio, every block: action = beginBlock()
+//   audio:   fade out over one block           kRender  -> run the graph
+//   audio:   drainBlocks of silence            kSilence -> skip it
+//   control: graphReleased() -> prepare(rate)  kRetune  -> retune the driver, run the graph
+//   control: graphPrepared()                 then endBlock(channels, ...) applies fades/silence
+//   audio:   kRetune, fade in over one block
+//
+// The drain must cover every block already queued in the driver, so the buffer playing when
+// the driver retunes at its next boundary is silence and the first new-rate block queues
+// behind it. Each phase change is made by one side only, so the phase is a plain atomic.
+class SampleRateSwitch {
+ public:
+  enum class Action : std::uint8_t { kRender, kSilence, kRetune };
+
+  static constexpr float kMinSampleRate = 8000.0f;
+  static constexpr float kMaxSampleRate = 192000.0f;
+
+  void prepare(float sampleRate, size_t drainBlocks) {
+    sampleRate_.store(clamp(sampleRate, kMinSampleRate, kMaxSampleRate), std::memory_order_relaxed);
+    pendingRate_.store(sampleRate_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    drainBlocks_ = drainBlocks;
+    reset();
+  }
+
+  void reset() {
+    silentBlocks_ = 0;
+    fade_ = Fade::kNone;
+    phase_.store(Phase::kRunning, std::memory_order_release);
+  }
+
+  // Control core. False while a switch is already in progress; a request for the current rate
+  // still runs the whole sequence, so the graph can be re-prepared glitch-free on demand.
+  bool request(float sampleRate) {
+    // Only this side leaves kRunning, so the pending rate is never rewritten under the audio core.
+    if (phase_.load(std::memory_order_acquire) != Phase::kRunning) {
+      return false;
+    }
+    pendingRate_.store(clamp(sampleRate, kMinSampleRate, kMaxSampleRate), std::memory_order_relaxed);
+    phase_.store(Phase::kRequested, std::memory_order_release);
+    return true;
+  }
+
+  // Control core: true once the audio core has stopped running the graph; prepare it for
+  // pendingSampleRate() now, then call graphPrepared().
+  [[nodiscard]] bool graphReleased() const { return phase_.load(std::memory_order_acquire) == Phase::kReleased; }
+
+  void graphPrepared() {
+    Phase expected = Phase::kReleased;
+    phase_.compare_exchange_strong(expected, Phase::kPrepared, std::memory_order_acq_rel);
+  }
+
+  [[nodiscard]] bool switching() const { return phase_.load(std::memory_order_acquire) != Phase::kRunning; }
+  [[nodiscard]] float pendingSampleRate() const { return pendingRate_.load(std::memory_order_relaxed); }
+
+  // The rate the graph is prepared for; changes on the block that returns kRetune.
+  [[nodiscard]] float sampleRate() const { return sampleRate_.load(std::memory_order_relaxed); }
+
+  // Audio core, at the top of every block.
+  Action beginBlock() {
+    switch (phase_.load(std::memory_order_acquire)) {
+      case Phase::kRequested:
+        fade_ = Fade::kOut;
+        phase_.store(Phase::kDraining, std::memory_order_relaxed);
+        silentBlocks_ = 0;
+        return Action::kRender;
+      case Phase::kDraining:
+        fade_ = Fade::kSilent;
+        if (++silentBlocks_ >= drainBlocks_) {
+          // Release after this block's silence is written; endBlock no longer reads the graph.
+          phase_.store(Phase::kReleased, std::memory_order_release);
+        }
+        return Action::kSilence;
+      case Phase::kReleased:
+        fade_ = Fade::kSilent;
+        return Action::kSilence;
+      case Phase::kPrepared:
+        sampleRate_.store(pendingRate_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        fade_ = Fade::kIn;
+        phase_.store(Phase::kRunning, std::memory_order_release);
+        return Action::kRetune;
+      case Phase::kRunning:
+      default:
+        fade_ = Fade::kNone;
+        return Action::kRender;
+    }
+  }
+
+  // Audio core, after the graph wrote its block (or did not run, for kSilence).
+  void endBlock(float* const* channels, size_t channelCount, size_t frames) {
+    if (fade_ == Fade::kNone || frames == 0) {
+      return;
+    }
+    for (size_t c = 0; c < channelCount; ++c) {
+      float* samples = channels[c];
+      if (fade_ == Fade::kSilent) {
+        for (size_t i = 0; i < frames; ++i) {
+          samples[i] = 0.0f;
+        }
+        continue;
+      }
+      // Linear over the block, reaching exactly 0 (out) or starting exactly at 0 (in).
+      const float step = 1.0f / static_cast<float>(frames);
+      for (size_t i = 0; i < frames; ++i) {
+        const float ramp = static_cast<float>(i + 1) * step;
+        samples[i] *= fade_ == Fade::kOut ? 1.0f - ramp : ramp - step;
+      }
+    }
+  }
+
+ private:
+  enum class Phase : std::uint8_t { kRunning, kRequested, kDraining, kReleased, kPrepared };
+  enum class Fade : std::uint8_t { kNone, kOut, kSilent, kIn };
+
+  std::atomic<Phase> phase_{Phase::kRunning};
+  std::atomic<float> sampleRate_{kDefaultSampleRate};
+  std::atomic<float> pendingRate_{kDefaultSampleRate};
+  size_t drainBlocks_ = 4;
+  size_t silentBlocks_ = 0;
+  Fade fade_ = Fade::kNone;
+};
+
+}  // namespace rpdsp
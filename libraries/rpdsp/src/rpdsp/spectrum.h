@@ -0,0 +1,167 @@
+#pragma once
+
+#include "config.h"
+#include "fft.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace rpdsp {
+
+enum class WindowShape { Rectangular, Hann, Hamming, Blackman };
+
+// Analysis window of N points as a constexpr table (flash on RP2350). Periodic form, so a
+// Hann window at 50% hop sums to a constant.
+template <size_t N, WindowShape Shape = WindowShape::Hann>
+class Window {
+  static constexpr std::array<float, N> makeTable() {
+    std::array<float, N> table{};
+    for (size_t i = 0; i < N; ++i) {
+      const double c1 = fft_detail::unitCos(i, N);
+      const double c2 = fft_detail::unitCos(2 * i, N);
+      double w = 1.0;
+      if (Shape == WindowShape::Hann) {
+        w = 0.5 - 0.5 * c1;
+      } else if (Shape == WindowShape::Hamming) {
+        w = 0.54 - 0.46 * c1;
+      } else if (Shape == WindowShape::Blackman) {
+        w = 0.42 - 0.5 * c1 + 0.08 * c2;
+      }
+      table[i] = static_cast<float>(w);
+    }
+    return table;
+  }
+
+  static constexpr float makeCoherentGain() {
+    float sum = 0.0f;
+    for (float w : kTable) {
+      sum += w;
+    }
+    return sum / static_cast<float>(N);
+  }
+
+ public:
+  static constexpr std::array<float, N> kTable = makeTable();
+  // Mean window value; divide a bin magnitude by N * coherentGain to read sine amplitude.
+  static constexpr float kCoherentGain = makeCoherentGain();
+
+  static void apply(float* data) {
+    for (size_t i = 0; i < N; ++i) {
+      data[i] *= kTable[i];
+    }
+  }
+};
+
+// |X[k]|^2 for k = 0..N/2 from a RealFft packed spectrum; out needs N/2 + 1 entries.
+template <size_t N>
+void powerSpectrum(const float* packed, float* out) {
+  out[0] = packed[0] * packed[0];
+  out[N / 2] = packed[1] * packed[1];
+  for (size_t k = 1; k < N / 2; ++k) {
+    out[k] = packed[2 * k] * packed[2 * k] + packed[2 * k + 1] * packed[2 * k + 1];
+  }
+}
+
+// Streams audio-core blocks into overlapping STFT frames for the control core.
+//
+// The audio side calls push() with each block: a copy into a sample ring and one atomic
+// store, no waiting. The control side calls nextFrame() whenever it has time; each call
+// returns the next hop's frame (windowed and transformed, packed layout). If the control
+// side falls so far behind that the ring was overwritten during a copy, the frame is
+// dropped and counted rather than returned torn. Ring samples are relaxed atomics (a plain
+// word load or store on Cortex-M33) fenced the way Seqlock fences its words, so the tear
+// check holds on weakly ordered cores and the copy is free of data races on the host.
+template <size_t N, size_t Hop = N / 2, WindowShape Shape = WindowShape::Hann, size_t RingSize = 4 * N>
+class StftFrameBuilder {
+  static_assert(Hop >= 1 && Hop <= N, "StftFrameBuilder hop must be in [1, N]");
+  static_assert(RingSize >= N + Hop + kDefaultBlockSize && (RingSize & (RingSize - 1)) == 0,
+                "StftFrameBuilder ring must be a power of two holding a frame, a hop and a block");
+  static_assert(std::atomic<float>::is_always_lock_free, "StftFrameBuilder ring samples must be lock-free");
+
+ public:
+  static constexpr size_t kFrameSize = N;
+  static constexpr size_t kHop = Hop;
+
+  // Control side, with the audio side not pushing.
+  void reset() {
+    for (auto& sample : ring_) {
+      sample.store(0.0f, std::memory_order_relaxed);
+    }
+    written_.store(0, std::memory_order_relaxed);
+    nextFrameEnd_ = N;
+    lastFrameEnd_ = 0;
+    dropped_ = 0;
+  }
+
+  // Audio side. Publishes every kDefaultBlockSize samples so the reader can bound how far
+  // an unpublished write may reach.
+  void push(const float* samples, size_t count) {
+    std::uint32_t position = written_.load(std::memory_order_relaxed);
+    while (count > 0) {
+      const size_t chunk = count < kDefaultBlockSize ? count : kDefaultBlockSize;
+      // Keeps the previous publish ahead of these stores, so a reader that sees one of them
+      // also sees how far the writer had got.
+      std::atomic_thread_fence(std::memory_order_release);
+      for (size_t i = 0; i < chunk; ++i) {
+        ring_[(position + i) & (RingSize - 1)].store(samples[i], std::memory_order_relaxed);
+      }
+      position += static_cast<std::uint32_t>(chunk);
+      written_.store(position, std::memory_order_release);
+      samples += chunk;
+      count -= chunk;
+    }
+  }
+
+  // Control side. frame must hold N floats. Returns false when no new hop is ready.
+  bool nextFrame(float* frame) {
+    for (;;) {
+      const std::uint32_t written = written_.load(std::memory_order_acquire);
+      if (static_cast<std::int32_t>(written - nextFrameEnd_) < 0) {
+        return false;
+      }
+      // Skip ahead if the writer already lapped the frame we wanted.
+      if (written - nextFrameEnd_ > RingSize - N - kDefaultBlockSize) {
+        const std::uint32_t lag = written - nextFrameEnd_;
+        const std::uint32_t skipped = (lag + Hop - 1) / Hop;
+        dropped_ += skipped;
+        nextFrameEnd_ += skipped * Hop;
+        continue;
+      }
+      const std::uint32_t start = nextFrameEnd_ - N;
+      for (size_t i = 0; i < N; ++i) {
+        frame[i] = ring_[(start + i) & (RingSize - 1)].load(std::memory_order_relaxed);
+      }
+      // Validate after the copy: if the writer (plus one unpublished chunk) reached our
+      // span meanwhile, the copy may be torn. The fence keeps the copy's loads ahead of the
+      // recheck; an acquire load alone only orders what follows it.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const std::uint32_t after = written_.load(std::memory_order_relaxed);
+      if (after - start + kDefaultBlockSize > RingSize) {
+        ++dropped_;
+        nextFrameEnd_ += Hop;
+        continue;
+      }
+      lastFrameEnd_ = nextFrameEnd_;
+      nextFrameEnd_ += Hop;
+      Window<N, Shape>::apply(frame);
+      RealFft<N>::forward(frame);
+      return true;
+    }
+  }
+
+  [[nodiscard]] std::uint32_t droppedFrames() const { return dropped_; }
+
+  // Pushed-sample index one past the last frame returned by nextFrame(), for timestamping.
+  [[nodiscard]] std::uint32_t lastFrameEnd() const { return lastFrameEnd_; }
+
+ private:
+  std::array<std::atomic<float>, RingSize> ring_{};
+  std::atomic<std::uint32_t> written_{0};
+  std::uint32_t nextFrameEnd_ = N;
+  std::uint32_t lastFrameEnd_ = 0;
+  std::uint32_t dropped_ = 0;
+};
+
+}  // namespace rpdsp
@@ -39,6 +39,16 @@ struct VoiceFilterSettings {
   float velocityToCutoff = 0.35f;
 };
 
+// The part of a voice's sound a control core changes while notes play: everything in the preset
+// but the oscillator recipe. Publish it whole through a ParameterSnapshot and applyPatch() it on
+// the audio core when update() reports a change, so cutoff and envelope never arrive half-set.
+struct VoicePatch {
+  VoiceFilterSettings filter{};
+  VoiceEnvelopeSettings ampEnvelope{};
+  float noiseLevel = 0.0f;
+  float gain = 0.25f;
+};
+
 template <size_t MaxOscillators>
 struct TriggeredSynthVoicePreset {
   // Fixed-capacity presets avoid allocation while still allowing compact synth recipes.
@@ -118,6 +128,22 @@ class TriggeredSynthVoice {
                      preset_.ampEnvelope.sustain, preset_.ampEnvelope.releaseSeconds);
   }
 
+  // Realtime-safe but not free: besides the clamps, the filter redesign calls std::tan and the
+  // amp envelope converts all four stage times to sample counts. Call it when the snapshot
+  // reports a change, at most once per block, not per sample.
+  void applyPatch(const VoicePatch& patch) {
+    preset_.filter.resonance = clamp(patch.filter.resonance, 0.0f, 0.98f);
+    preset_.filter.velocityToCutoff = clamp(patch.filter.velocityToCutoff, 0.0f, 4.0f);
+    setFilterCutoff(patch.filter.cutoffHz);
+    setNoiseLevel(patch.noiseLevel);
+    setGain(patch.gain);
+    setAmpEnvelope(patch.ampEnvelope);
+  }
+
+  [[nodiscard]] VoicePatch patch() const {
+    return {preset_.filter, preset_.ampEnvelope, preset_.noiseLevel, preset_.gain};
+  }
+
   void noteOn(int midiNote, float velocity = 1.0f, int channel = 0) {
     noteOn({midiNote, velocity, channel});
   }
@@ -0,0 +1,81 @@
+// Host timing for the master-bus dynamics: the 3-band LR4 split alone and the full stereo
+// MultibandCompressor<3>, per sample and per 32-frame block. Not part of ctest; run
+// rpdsp_bench_dynamics by hand and compare with the estimates in Docs/algorithm_catalog.md.
+
+#include <rpdsp/crossover.h>
+#include <rpdsp/dynamics.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+volatile float gSink = 0.0f;
+
+constexpr size_t kBlock = rpdsp::kDefaultBlockSize;
+constexpr int kBlocks = 200000;
+
+void fill(float* left, float* right, int block) {
+  for (size_t i = 0; i < kBlock; ++i) {
+    const float t = static_cast<float>(block * static_cast<int>(kBlock) + static_cast<int>(i));
+    left[i] = 0.5f * std::sin(0.013f * t) + 0.1f * std::sin(0.9f * t);
+    right[i] = 0.5f * std::sin(0.011f * t) + 0.1f * std::sin(1.1f * t);
+  }
+}
+
+double nsPerFrame(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration<double, std::nano>(end - start).count() / (static_cast<double>(kBlocks) * kBlock);
+}
+
+}  // namespace
+
+int main() {
+  static float left[kBlock];
+  static float right[kBlock];
+
+  // Input generation is timed separately so it can be subtracted.
+  auto start = std::chrono::steady_clock::now();
+  for (int b = 0; b < kBlocks; ++b) {
+    fill(left, right, b);
+    gSink = gSink + left[3];
+  }
+  const double fillNs = nsPerFrame(start, std::chrono::steady_clock::now());
+
+  static rpdsp::BandSplitter<3> splitLeft;
+  static rpdsp::BandSplitter<3> splitRight;
+  splitLeft.prepare(48000.0f);
+  splitRight.prepare(48000.0f);
+  std::array<float, 3> bands{};
+  start = std::chrono::steady_clock::now();
+  for (int b = 0; b < kBlocks; ++b) {
+    fill(left, right, b);
+    for (size_t i = 0; i < kBlock; ++i) {
+      splitLeft.process(left[i], bands);
+      gSink = gSink + bands[1];
+      splitRight.process(right[i], bands);
+      gSink = gSink + bands[2];
+    }
+  }
+  const double splitNs = nsPerFrame(start, std::chrono::steady_clock::now()) - fillNs;
+
+  static rpdsp::MultibandCompressor<3> compressor;
+  compressor.prepare(48000.0f);
+  for (size_t band = 0; band < 3; ++band) {
+    compressor.setThresholdDb(band, -24.0f);
+    compressor.setRatio(band, 3.0f);
+  }
+  start = std::chrono::steady_clock::now();
+  for (int b = 0; b < kBlocks; ++b) {
+    fill(left, right, b);
+    compressor.process(left, right, kBlock);
+    gSink = gSink + left[5];
+  }
+  const double compressorNs = nsPerFrame(start, std::chrono::steady_clock::now()) - fillNs;
+
+  std::printf("3-band stereo split       %6.1f ns/frame  %8.1f ns/block\n", splitNs, splitNs * kBlock);
+  std::printf("MultibandCompressor<3>    %6.1f ns/frame  %8.1f ns/block\n", compressorNs,
+              compressorNs * kBlock);
+  return 0;
+}
@@ -0,0 +1,107 @@
+// Host timing for the spectrum path: RealFft<N>::forward, a full StftFrameBuilder frame
+// (copy + window + FFT), and the chord-following stages built on it. Not part of ctest; run rpdsp_bench_fft by hand and scale the
+// numbers with the cycle model in Docs/algorithm_catalog.md before trusting them on RP2350.
+
+#include <rpdsp/chroma.h>
+#include <rpdsp/decimator.h>
+#include <rpdsp/spectrum.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+volatile float gSink = 0.0f;
+
+template <size_t N>
+void benchmark() {
+  constexpr int kIterations = 20000;
+  static float data[N];
+  for (size_t i = 0; i < N; ++i) {
+    data[i] = std::sin(0.37f * static_cast<float>(i));
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    rpdsp::RealFft<N>::forward(data);
+    data[0] *= 0.5f;
+    gSink = gSink + data[3];
+  }
+  const auto fftEnd = std::chrono::steady_clock::now();
+
+  static rpdsp::StftFrameBuilder<N> builder;
+  builder.reset();
+  static float block[rpdsp::kDefaultBlockSize];
+  static float frame[N];
+  int frames = 0;
+  const auto stftStart = std::chrono::steady_clock::now();
+  while (frames < kIterations) {
+    builder.push(block, rpdsp::kDefaultBlockSize);
+    while (builder.nextFrame(frame)) {
+      gSink = gSink + frame[1];
+      ++frames;
+    }
+  }
+  const auto stftEnd = std::chrono::steady_clock::now();
+
+  const double fftNs =
+      std::chrono::duration<double, std::nano>(fftEnd - start).count() / kIterations;
+  const double stftNs =
+      std::chrono::duration<double, std::nano>(stftEnd - stftStart).count() / frames;
+  std::printf("N=%4zu  fft %8.1f ns  stft frame %8.1f ns  model %6zu cycles\n", N, fftNs, stftNs,
+              rpdsp::RealFft<N>::estimatedCycles());
+}
+
+// Audio side per block (4x decimate + push) and control side per frame (chroma + match).
+void benchmarkChordFollowing() {
+  constexpr int kBlocks = 200000;
+  constexpr size_t kN = 2048;
+  static rpdsp::Decimator<4> decimator;
+  static rpdsp::StftFrameBuilder<kN> builder;
+  static rpdsp::Chromagram<kN> chromagram;
+  rpdsp::ChordTemplateMatcher matcher;
+  decimator.prepare(48000.0f);
+  builder.reset();
+  chromagram.prepare(12000.0f);
+
+  static float block[rpdsp::kDefaultBlockSize];
+  float decimated[rpdsp::kDefaultBlockSize];
+  for (size_t i = 0; i < rpdsp::kDefaultBlockSize; ++i) {
+    block[i] = std::sin(0.05f * static_cast<float>(i));
+  }
+  const auto pushStart = std::chrono::steady_clock::now();
+  for (int b = 0; b < kBlocks; ++b) {
+    const size_t written = decimator.process(block, rpdsp::kDefaultBlockSize, decimated);
+    builder.push(decimated, written);
+  }
+  const auto pushEnd = std::chrono::steady_clock::now();
+
+  static float frame[kN];
+  for (size_t i = 0; i < kN; ++i) {
+    frame[i] = std::sin(0.11f * static_cast<float>(i)) + 0.5f * std::sin(0.37f * static_cast<float>(i));
+  }
+  rpdsp::RealFft<kN>::forward(frame);
+  constexpr int kFrames = 20000;
+  const auto matchStart = std::chrono::steady_clock::now();
+  for (int f = 0; f < kFrames; ++f) {
+    chromagram.process(frame);
+    gSink = gSink + matcher.process(chromagram.chroma()).score;
+  }
+  const auto matchEnd = std::chrono::steady_clock::now();
+
+  std::printf("chord follow: decimate+push %6.1f ns/block  chroma+match (N=%zu) %8.1f ns/frame\n",
+              std::chrono::duration<double, std::nano>(pushEnd - pushStart).count() / kBlocks, kN,
+              std::chrono::duration<double, std::nano>(matchEnd - matchStart).count() / kFrames);
+}
+
+}  // namespace
+
+int main() {
+  benchmark<256>();
+  benchmark<512>();
+  benchmark<1024>();
+  benchmark<2048>();
+  benchmarkChordFollowing();
+  return 0;
+}
@@ -0,0 +1,80 @@
+// Host timing for the output stage: the per-sample toInt24x32 / toInt16 loop every example
+// used to write, against the interleave kernels and the dithered S16 stage. Not part of
+// ctest; run rpdsp_bench_output by hand.
+
+#include <rpdsp/algorithm.h>
+#include <rpdsp/sample_format.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+constexpr size_t kBlock = rpdsp::kDefaultBlockSize;
+constexpr int kBlocks = 2000000;
+
+volatile int32_t gSink = 0;
+
+template <typename Body>
+double nsPerBlock(Body body) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int b = 0; b < kBlocks; ++b) {
+    body(b);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kBlocks;
+}
+
+}  // namespace
+
+int main() {
+  static float left[kBlock];
+  static float right[kBlock];
+  static int32_t words[2 * kBlock];
+  static int16_t samples[2 * kBlock];
+  for (size_t i = 0; i < kBlock; ++i) {
+    left[i] = 1.2f * std::sin(0.05f * static_cast<float>(i));
+    right[i] = 0.7f * std::cos(0.03f * static_cast<float>(i));
+  }
+
+  const double scalar32 = nsPerBlock([&](int b) {
+    left[b & (kBlock - 1)] += 1.0e-7f;
+    for (size_t i = 0; i < kBlock; ++i) {
+      words[2 * i] = rpdsp::toInt24x32(left[i]);
+      words[2 * i + 1] = rpdsp::toInt24x32(right[i]);
+    }
+    gSink = gSink + words[b & (2 * kBlock - 1)];
+  });
+  const double kernel32 = nsPerBlock([&](int b) {
+    left[b & (kBlock - 1)] += 1.0e-7f;
+    rpdsp::interleaveToInt24x32(left, right, words, kBlock);
+    gSink = gSink + words[b & (2 * kBlock - 1)];
+  });
+  const double scalar16 = nsPerBlock([&](int b) {
+    left[b & (kBlock - 1)] += 1.0e-7f;
+    for (size_t i = 0; i < kBlock; ++i) {
+      samples[2 * i] = rpdsp::toInt16(left[i]);
+      samples[2 * i + 1] = rpdsp::toInt16(right[i]);
+    }
+    gSink = gSink + samples[b & (2 * kBlock - 1)];
+  });
+  const double kernel16 = nsPerBlock([&](int b) {
+    left[b & (kBlock - 1)] += 1.0e-7f;
+    rpdsp::interleaveToInt16(left, right, samples, kBlock);
+    gSink = gSink + samples[b & (2 * kBlock - 1)];
+  });
+  rpdsp::Int16OutputStage stage;
+  stage.setNoiseShaping(true);
+  const double dithered16 = nsPerBlock([&](int b) {
+    left[b & (kBlock - 1)] += 1.0e-7f;
+    stage.process(left, right, samples, kBlock);
+    gSink = gSink + samples[b & (2 * kBlock - 1)];
+  });
+
+  std::printf("%zu-frame stereo block     scalar loop    kernel\n", kBlock);
+  std::printf("S32 (24-in-32)           %8.1f ns  %8.1f ns\n", scalar32, kernel32);
+  std::printf("S16                      %8.1f ns  %8.1f ns\n", scalar16, kernel16);
+  std::printf("S16 TPDF + shaping                     %8.1f ns\n", dithered16);
+  return 0;
+}
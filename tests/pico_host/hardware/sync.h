@@ -0,0 +1,4 @@
+// The host build uses the lock-free queues (PICO_AUDIO_LOCK_FREE_QUEUES), so no spin locks.
+#pragma once
+
+#include "../pico.h"
@@ -0,0 +1,14 @@
+#include "pico.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+extern "C" void panic(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    std::vfprintf(stderr, fmt, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+    std::abort();
+}
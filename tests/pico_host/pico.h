@@ -0,0 +1,29 @@
+// Host stand-in for the Pico SDK's pico.h: just enough for pico_audio_i2s/audio.cpp to build and
+// run on the host, so its buffer pools and connections can be tested without a board.
+#pragma once
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+#define __packed __attribute__((packed))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Prints and aborts, like the SDK's.
+void panic(const char *fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+static inline void __mem_fence_acquire(void) { __atomic_thread_fence(__ATOMIC_ACQUIRE); }
+static inline void __mem_fence_release(void) { __atomic_thread_fence(__ATOMIC_RELEASE); }
+// No event register on the host; a blocking take spins instead of sleeping.
+static inline void __sev(void) {}
+static inline void __wfe(void) {}
@@ -0,0 +1,198 @@
+#include <rpdsp/analysis.h>
+#include <rpdsp/decimator.h>
+#include <rpdsp/dynamics.h>
+#include <rpdsp/fft.h>
+
+#include "doctest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+float sawSample(float frequency, size_t n) {
+    const float phase = std::fmod(frequency * static_cast<float>(n) / 48000.0f, 1.0f);
+    return 0.6f * (2.0f * phase - 1.0f) + 0.2f * std::sin(rpdsp::kTwoPi * 3.0f * frequency * n / 48000.0f);
+}
+
+}  // namespace
+
+TEST_CASE("RealFft steps reproduce forward and inverse") {
+    constexpr size_t kN = 128;
+    float whole[kN];
+    float stepped[kN];
+    for (size_t i = 0; i < kN; ++i) {
+        whole[i] = stepped[i] = std::sin(0.3f * static_cast<float>(i)) + 0.01f * static_cast<float>(i);
+    }
+    rpdsp::RealFft<kN>::forward(whole);
+    for (size_t s = 0; s < rpdsp::RealFft<kN>::kSteps; ++s) {
+        rpdsp::RealFft<kN>::forwardStep(stepped, s);
+    }
+    for (size_t i = 0; i < kN; ++i) {
+        CHECK(stepped[i] == whole[i]);
+    }
+    rpdsp::RealFft<kN>::inverse(whole);
+    for (size_t s = 0; s < rpdsp::RealFft<kN>::kSteps; ++s) {
+        rpdsp::RealFft<kN>::inverseStep(stepped, s);
+    }
+    for (size_t i = 0; i < kN; ++i) {
+        CHECK(stepped[i] == whole[i]);
+    }
+}
+
+TEST_CASE("IncrementalYinPitchDetector agrees with the direct YIN") {
+    rpdsp::YinPitchDetector<1024, 512> direct;
+    rpdsp::IncrementalYinPitchDetector<1024, 512> incremental;
+    direct.prepare(48000.0f);
+    incremental.prepare(48000.0f);
+    incremental.setStepsPerBlock(4);
+
+    for (float frequency : {98.0f, 220.0f, 443.0f, 1250.0f}) {
+        direct.reset();
+        incremental.reset();
+        std::vector<float> block(rpdsp::kDefaultBlockSize);
+        size_t n = 0;
+        for (int b = 0; b < 200; ++b) {
+            for (float& sample : block) {
+                sample = sawSample(frequency, n++);
+                direct.process(sample);
+            }
+            incremental.process(block.data(), block.size());
+        }
+        REQUIRE(direct.hasPitch());
+        REQUIRE(incremental.hasPitch());
+        CHECK(incremental.frequencyHz() == doctest::Approx(frequency).epsilon(0.005));
+        CHECK(incremental.frequencyHz() == doctest::Approx(direct.frequencyHz()).epsilon(0.002));
+        CHECK(incremental.confidence() > 0.8f);
+    }
+}
+
+TEST_CASE("IncrementalYinPitchDetector spreads one analysis over several blocks") {
+    rpdsp::IncrementalYinPitchDetector<512, 256> yin;
+    yin.prepare(48000.0f);
+    yin.setUpdateIntervalSamples(1);
+    yin.setStepsPerBlock(1);
+    constexpr size_t kSteps = rpdsp::IncrementalYinPitchDetector<512, 256>::analysisSteps();
+    // Snapshot, 2 x (log2(512) + 2) FFT steps, power spectrum and pick.
+    CHECK(kSteps == 1 + 11 + 1 + 11 + 1);
+
+    std::vector<float> block(rpdsp::kDefaultBlockSize);
+    size_t n = 0;
+    auto feed = [&] {
+        for (float& sample : block) {
+            sample = sawSample(300.0f, n++);
+        }
+        yin.process(block.data(), block.size());
+    };
+    while (n < 512) {
+        feed();
+    }
+    // The first analysis snapshots on the block that fills the window; its last step runs
+    // kSteps - 1 blocks later.
+    for (size_t b = 1; b + 1 < kSteps; ++b) {
+        feed();
+        CHECK_FALSE(yin.hasPitch());
+    }
+    feed();
+    CHECK(yin.hasPitch());
+    CHECK(yin.frequencyHz() == doctest::Approx(300.0f).epsilon(0.005));
+}
+
+TEST_CASE("IncrementalYinPitchDetector reports nothing for silence") {
+    rpdsp::IncrementalYinPitchDetector<256, 128> yin;
+    yin.prepare(48000.0f);
+    yin.setStepsPerBlock(yin.analysisSteps());
+    std::vector<float> block(rpdsp::kDefaultBlockSize, 0.0f);
+    for (int b = 0; b < 64; ++b) {
+        yin.process(block.data(), block.size());
+    }
+    CHECK_FALSE(yin.hasPitch());
+    CHECK(yin.frequencyHz() == 0.0f);
+}
+
+namespace {
+
+// Output amplitude (from RMS) of a Decimator<Factor> fed a unit sine, after the filter settles.
+template <size_t Factor>
+float decimatedSineGain(double frequency) {
+    rpdsp::Decimator<Factor> decimator;
+    decimator.prepare(48000.0f);
+    double sumSquares = 0.0;
+    size_t count = 0;
+    for (size_t n = 0; n < 48000; ++n) {
+        // Wrap the phase in double so float argument error does not masquerade as leakage.
+        const double phase = std::fmod(frequency * static_cast<double>(n), 48000.0) / 48000.0;
+        float out = 0.0f;
+        if (decimator.process(static_cast<float>(std::sin(2.0 * 3.141592653589793 * phase)), out) && n > 4800) {
+            sumSquares += static_cast<double>(out) * out;
+            ++count;
+        }
+    }
+    return static_cast<float>(std::sqrt(2.0 * sumSquares / static_cast<double>(count)));
+}
+
+}  // namespace
+
+TEST_CASE("Decimator passes the analysis band and rejects what would alias into it") {
+    CHECK(decimatedSineGain<2>(3000.0) == doctest::Approx(1.0f).epsilon(0.002));
+    CHECK(decimatedSineGain<4>(2000.0) == doctest::Approx(1.0f).epsilon(0.002));
+    CHECK(decimatedSineGain<8>(1000.0) == doctest::Approx(1.0f).epsilon(0.002));
+    // 11 kHz would fold to 1 kHz at a 12 kHz output rate.
+    CHECK(decimatedSineGain<4>(11000.0) < 0.001f);
+    CHECK(decimatedSineGain<2>(20000.0) < 0.001f);
+    CHECK(rpdsp::Decimator<4>::kLatencySamples == 33);
+}
+
+TEST_CASE("Decimator block processing matches per-sample processing") {
+    rpdsp::Decimator<8> perSample;
+    rpdsp::Decimator<8> block;
+    perSample.prepare(48000.0f);
+    block.prepare(48000.0f);
+    CHECK(block.outputSampleRate() == doctest::Approx(6000.0f));
+
+    std::vector<float> input(1000);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = sawSample(330.0f, i);
+    }
+    std::vector<float> expected;
+    for (float x : input) {
+        float out = 0.0f;
+        if (perSample.process(x, out)) {
+            expected.push_back(out);
+        }
+    }
+    std::vector<float> actual(input.size());
+    size_t written = 0;
+    // Odd chunk sizes cross the decimation phase.
+    for (size_t offset = 0; offset < input.size(); offset += 37) {
+        const size_t frames = std::min<size_t>(37, input.size() - offset);
+        written += block.process(input.data() + offset, frames, actual.data() + written);
+    }
+    REQUIRE(written == expected.size());
+    for (size_t i = 0; i < written; ++i) {
+        CHECK(actual[i] == expected[i]);
+    }
+}
+
+TEST_CASE("DecimatedAnalyzer runs pitch and envelope trackers at the reduced rate") {
+    rpdsp::DecimatedAnalyzer<rpdsp::YinPitchDetector<256, 128>, 4> yin;
+    yin.prepare(48000.0f);
+    CHECK(yin.analysisSampleRate() == doctest::Approx(12000.0f));
+    rpdsp::DecimatedAnalyzer<rpdsp::ZeroCrossingPitchDetector, 4> zeroCrossing;
+    zeroCrossing.prepare(48000.0f);
+    rpdsp::DecimatedAnalyzer<rpdsp::EnvelopeFollower, 8> envelope;
+    envelope.prepare(48000.0f);
+    envelope.analyzer().setAttackRelease(1.0f, 50.0f);
+
+    for (size_t n = 0; n < 24000; ++n) {
+        const float x = sawSample(147.0f, n);
+        yin.process(x);
+        zeroCrossing.process(std::sin(rpdsp::kTwoPi * 147.0f * static_cast<float>(n) / 48000.0f));
+        envelope.process(0.5f * std::sin(rpdsp::kTwoPi * 200.0f * static_cast<float>(n) / 48000.0f));
+    }
+    REQUIRE(yin.analyzer().hasPitch());
+    CHECK(yin.analyzer().frequencyHz() == doctest::Approx(147.0f).epsilon(0.01));
+    CHECK(zeroCrossing.analyzer().frequencyHz() == doctest::Approx(147.0f).epsilon(0.01));
+    CHECK(envelope.analyzer().value() == doctest::Approx(0.5f).epsilon(0.1));
+}
@@ -0,0 +1,87 @@
+#include "../Examples/Shared/AudioChordFollower.h"
+
+#include "doctest.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// A soft synth chord: each tone gets a few decaying harmonics, like a keyboard patch.
+void renderChord(const int* midi, int count, size_t start, size_t frames, float* out) {
+    for (size_t i = 0; i < frames; ++i) {
+        const double t = static_cast<double>(start + i) / 48000.0;
+        double sample = 0.0;
+        for (int n = 0; n < count; ++n) {
+            const double hz = 440.0 * std::pow(2.0, (midi[n] - 69) / 12.0);
+            for (int h = 1; h <= 3; ++h) {
+                sample += 0.12 / h * std::sin(2.0 * 3.141592653589793 * hz * h * t);
+            }
+        }
+        out[i] = static_cast<float>(sample);
+    }
+}
+
+}  // namespace
+
+TEST_CASE("ChordTemplateMatcher names clean chroma vectors") {
+    rpdsp::ChordTemplateMatcher matcher;
+    rpdsp::ChromaVector chroma{};
+    chroma[9] = 1.0f;   // A
+    chroma[0] = 0.8f;   // C
+    chroma[4] = 0.9f;   // E
+    chroma[7] = 0.7f;   // G
+    const rpdsp::ChordMatch match = matcher.process(chroma);
+    REQUIRE(match.valid);
+    CHECK(match.root == 9);
+    CHECK(match.shape == rpdsp::ChordShape::Minor7);
+    CHECK(match.mask == rpdsp::ChordTemplateMatcher::rotate(0x489, 9));
+
+    rpdsp::ChromaVector flat{};
+    flat.fill(1.0f);
+    CHECK_FALSE(matcher.process(flat).valid);
+}
+
+TEST_CASE("AudioChordFollower follows a rendered progression into HarmonyEngine chords") {
+    harmony_examples::AudioChordFollower<> follower;
+    follower.prepare(48000.0f);
+
+    const int cMajor[] = {48, 52, 55, 60};
+    const int aMinor[] = {45, 52, 57, 60};
+    const int g7[] = {43, 50, 53, 59};
+    const int* progression[] = {cMajor, aMinor, g7};
+    const HarmonyEngine::ChordType expectedType[] = {
+        HarmonyEngine::ChordType::Major, HarmonyEngine::ChordType::Minor, HarmonyEngine::ChordType::Dominant7};
+    const int expectedRoot[] = {0, 9, 7};
+
+    std::vector<float> block(rpdsp::kDefaultBlockSize);
+    size_t n = 0;
+    for (int c = 0; c < 3; ++c) {
+        int changes = 0;
+        // One second per chord, with the control core polling every block.
+        for (size_t b = 0; b < 48000 / rpdsp::kDefaultBlockSize; ++b) {
+            renderChord(progression[c], 4, n, block.size(), block.data());
+            n += block.size();
+            follower.push(block.data(), block.size());
+            if (follower.update()) {
+                ++changes;
+            }
+        }
+        const HarmonyEngine::Chord chord = follower.chord();
+        CHECK(follower.match().valid);
+        CHECK(chord.type == expectedType[c]);
+        CHECK(chord.rootNote == expectedRoot[c]);
+        CHECK(chord.isValid());
+        // Hysteresis keeps the reading from chattering within a held chord.
+        CHECK(changes <= 3);
+    }
+    CHECK(follower.droppedFrames() == 0);
+
+    // Silence releases the chord.
+    std::fill(block.begin(), block.end(), 0.0f);
+    for (int b = 0; b < 1000; ++b) {
+        follower.push(block.data(), block.size());
+        follower.update();
+    }
+    CHECK_FALSE(follower.match().valid);
+}
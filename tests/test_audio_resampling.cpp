@@ -0,0 +1,163 @@
+// The driver's resampling connection, run on the host: audio.cpp is built against the SDK
+// stand-ins in pico_host/, and buffers go through the same give/take calls a sketch and the I2S
+// consumer make.
+#define PICO_RP2350 1
+#define ARDUINO_ARCH_RP2040 1
+#include <pico_audio_i2s/audio.h>
+
+#include "doctest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kInputRate = 44100;
+constexpr uint32_t kOutputRate = 48000;
+constexpr int kFrames = 256;
+constexpr double kPi = 3.14159265358979323846;
+
+AUDIO_BUFFER_POOL_STORAGE(producerStorage, 4, kFrames, 8);
+AUDIO_BUFFER_POOL_STORAGE(consumerStorage, 2, kFrames, 8);
+audio_resampling_connection_t connection;
+
+struct S16 {
+  using Sample = int16_t;
+  static constexpr uint16_t kFormat = AUDIO_BUFFER_FORMAT_PCM_S16;
+  static constexpr double kFullScale = 32768.0;
+  static Sample encode(double x) { return static_cast<Sample>(std::lround(x * 32767.0)); }
+};
+
+// 24-in-32: the top 24 bits carry the sample, the low byte stays zero.
+struct S32 {
+  using Sample = int32_t;
+  static constexpr uint16_t kFormat = AUDIO_BUFFER_FORMAT_PCM_S32;
+  static constexpr double kFullScale = 2147483648.0;
+  static Sample encode(double x) { return static_cast<Sample>(std::lround(x * 8388607.0) * 256); }
+};
+
+struct Run {
+  std::vector<double> left;  // consumer output, full scale 1
+  size_t produced = 0;       // frames handed to the producer pool
+  int shortBuffers = 0;
+  int unmirrored = 0;        // frames where right != -left (the producer writes a mirrored pair)
+  int lowBytes = 0;          // S32 frames with bits below the 24-bit sample set
+};
+
+// Keeps the producer pool full of a tone at kInputRate and takes consumer buffers the way the
+// I2S DMA handler does, non-blocking.
+template <typename Format>
+Run runConnection(double frequency, double amplitude, int consumerBuffers) {
+  static audio_format_t producerFormat;
+  static audio_format_t consumerFormat;
+  static audio_buffer_format_t producerBufferFormat;
+  static audio_buffer_format_t consumerBufferFormat;
+  producerFormat = {kInputRate, Format::kFormat, 2};
+  consumerFormat = {kOutputRate, Format::kFormat, 2};
+  producerBufferFormat = {&producerFormat, 2 * sizeof(typename Format::Sample)};
+  consumerBufferFormat = {&consumerFormat, 2 * sizeof(typename Format::Sample)};
+  audio_buffer_pool_t* producer = audio_init_producer_pool(&producerStorage, &producerBufferFormat, 4, kFrames);
+  audio_buffer_pool_t* consumer = audio_init_consumer_pool(&consumerStorage, &consumerBufferFormat, 2, kFrames);
+  audio_resampling_connection_init(&connection, kInputRate, kOutputRate);
+  audio_complete_connection(&connection.copy.core, producer, consumer);
+
+  Run run;
+  for (int b = 0; b < consumerBuffers; ++b) {
+    while (audio_buffer_t* buffer = take_audio_buffer(producer, false)) {
+      auto* samples = reinterpret_cast<typename Format::Sample*>(buffer->buffer->bytes);
+      for (uint32_t i = 0; i < buffer->max_sample_count; ++i, ++run.produced) {
+        const double x = amplitude * std::sin(2.0 * kPi * frequency * static_cast<double>(run.produced) / kInputRate);
+        samples[2 * i] = Format::encode(x);
+        samples[2 * i + 1] = Format::encode(-x);
+      }
+      buffer->sample_count = buffer->max_sample_count;
+      give_audio_buffer(producer, buffer);
+    }
+    audio_buffer_t* buffer = take_audio_buffer(consumer, false);
+    REQUIRE(buffer != nullptr);
+    run.shortBuffers += buffer->sample_count != buffer->max_sample_count ? 1 : 0;
+    const auto* samples = reinterpret_cast<const typename Format::Sample*>(buffer->buffer->bytes);
+    for (uint32_t i = 0; i < buffer->sample_count; ++i) {
+      const int64_t left = samples[2 * i];
+      const int64_t right = samples[2 * i + 1];
+      // The filter runs in float, so allow one step of the 24-bit sample either way.
+      run.unmirrored += std::llabs(left + right) > (sizeof(typename Format::Sample) == 4 ? 256 : 1) ? 1 : 0;
+      run.lowBytes += sizeof(typename Format::Sample) == 4 && (left & 0xff) != 0 ? 1 : 0;
+      run.left.push_back(static_cast<double>(left) / Format::kFullScale);
+    }
+    give_audio_buffer(consumer, buffer);
+  }
+  return run;
+}
+
+struct ToneFit {
+  double gainDb;
+  double residualDb;  // everything that is not the tone, relative to a full-scale sine
+};
+
+// Least-squares sine and cosine at the expected output frequency, past the start-up transient.
+ToneFit fitTone(const std::vector<double>& output, double frequency, double amplitude) {
+  const double w = 2.0 * kPi * frequency / kOutputRate;
+  double ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0;
+  const size_t begin = 200;
+  for (size_t i = begin; i < output.size(); ++i) {
+    const double s = std::sin(w * static_cast<double>(i));
+    const double c = std::cos(w * static_cast<double>(i));
+    ss += s * s;
+    cc += c * c;
+    sc += s * c;
+    ys += output[i] * s;
+    yc += output[i] * c;
+  }
+  const double det = ss * cc - sc * sc;
+  const double a = (ys * cc - yc * sc) / det;
+  const double b = (yc * ss - ys * sc) / det;
+  double error = 0.0;
+  for (size_t i = begin; i < output.size(); ++i) {
+    const double d = output[i] - a * std::sin(w * static_cast<double>(i)) - b * std::cos(w * static_cast<double>(i));
+    error += d * d;
+  }
+  return {20.0 * std::log10(std::sqrt(a * a + b * b) / amplitude),
+          10.0 * std::log10(2.0 * error / static_cast<double>(output.size() - begin) + 1.0e-30)};
+}
+
+}  // namespace
+
+TEST_CASE("Resampling connection plays a 44.1 kHz producer at 48 kHz in full consumer buffers") {
+    constexpr int kBuffers = 200;
+
+    SUBCASE("S32") {
+        const Run run = runConnection<S32>(1000.0, 0.5, kBuffers);
+        CHECK(run.shortBuffers == 0);
+        REQUIRE(run.left.size() == static_cast<size_t>(kBuffers * kFrames));
+        CHECK(run.unmirrored == 0);
+        CHECK(run.lowBytes == 0);
+        // The producer is only ever topped up, so it runs at most its 4 buffers ahead of what
+        // 51200 output frames consume at 44.1/48.
+        const double consumed = static_cast<double>(run.left.size()) * kInputRate / kOutputRate;
+        CHECK(static_cast<double>(run.produced) >= consumed);
+        CHECK(static_cast<double>(run.produced) <= consumed + 4 * kFrames + PICO_AUDIO_RESAMPLER_TAPS);
+        // A 1 kHz input comes out as 1 kHz at the 48 kHz rate, at the same level.
+        const ToneFit fit = fitTone(run.left, 1000.0, 0.5);
+        CHECK(std::fabs(fit.gainDb) < 0.01);
+        CHECK(fit.residualDb < -90.0);
+    }
+    SUBCASE("S16") {
+        const Run run = runConnection<S16>(1000.0, 0.5, kBuffers);
+        CHECK(run.shortBuffers == 0);
+        REQUIRE(run.left.size() == static_cast<size_t>(kBuffers * kFrames));
+        CHECK(run.unmirrored == 0);
+        const ToneFit fit = fitTone(run.left, 1000.0, 0.5);
+        CHECK(std::fabs(fit.gainDb) < 0.01);
+        // 16-bit quantization, twice: about -98 dBFS before the filter's own error.
+        CHECK(fit.residualDb < -85.0);
+    }
+    SUBCASE("A tone near the top of the 44.1 kHz passband keeps its level") {
+        const Run run = runConnection<S32>(14000.0, 0.5, kBuffers);
+        CHECK(run.shortBuffers == 0);
+        const ToneFit fit = fitTone(run.left, 14000.0, 0.5);
+        CHECK(std::fabs(fit.gainDb) < 0.05);
+        CHECK(fit.residualDb < -75.0);
+    }
+}
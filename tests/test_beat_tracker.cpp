@@ -0,0 +1,249 @@
+#include <rpdsp/beat_tracker.h>
+#include <rpdsp/clock_tracker.h>
+#include <rpdsp/decimator.h>
+#include <rpdsp/realtime.h>
+#include <rpdsp/spectrum.h>
+
+#include "doctest.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Drum-machine style pulse: a decaying noise burst on every beat plus a quieter off-beat hat.
+float clickTrack(size_t n, double samplesPerBeat, rpdsp::XorShift32& noise) {
+    const double beatPosition = std::fmod(static_cast<double>(n), samplesPerBeat);
+    const double offbeatPosition = std::fmod(static_cast<double>(n) + 0.5 * samplesPerBeat, samplesPerBeat);
+    const float kick = static_cast<float>(std::exp(-beatPosition / 1200.0)) * 0.8f;
+    const float hat = static_cast<float>(std::exp(-offbeatPosition / 300.0)) * 0.15f;
+    return (kick + hat) * noise.nextBipolar() + 0.02f * noise.nextBipolar();
+}
+
+}  // namespace
+
+TEST_CASE("Seqlock readers never see a torn value") {
+    struct Pair {
+        std::uint32_t a;
+        std::uint32_t b;
+        float c;
+    };
+    rpdsp::Seqlock<Pair> lock;
+    std::atomic<bool> running{true};
+    std::thread writer([&] {
+        for (std::uint32_t i = 1; i < 200000; ++i) {
+            lock.store(Pair{i, ~i, static_cast<float>(i & 0xffff)});
+        }
+        running.store(false);
+    });
+    size_t torn = 0;
+    size_t reads = 0;
+    while (running.load() || reads < 1000) {
+        const Pair value = lock.load();
+        if (value.b != ~value.a && !(value.a == 0 && value.b == 0)) {
+            ++torn;
+        }
+        if (value.a != 0 && value.c != static_cast<float>(value.a & 0xffff)) {
+            ++torn;
+        }
+        ++reads;
+    }
+    writer.join();
+    CHECK(torn == 0);
+    CHECK(lock.version() == 200000);
+}
+
+TEST_CASE("ClockTracker alignToBeat snaps to the nearest quarter") {
+    rpdsp::ClockTracker clock;
+    clock.prepare(48000.0f, 120.0f, 96, 8, 4);
+    for (int i = 0; i < 100; ++i) {
+        clock.advanceTick();
+    }
+    CHECK(clock.alignToBeat() == -4);
+    CHECK(clock.tick() == 96);
+    for (int i = 0; i < 90; ++i) {
+        clock.advanceTick();
+    }
+    CHECK(clock.alignToBeat() == 6);
+    CHECK(clock.tick() == 192);
+}
+
+TEST_CASE("SpectralFluxOnsetDetector keeps many bands inside a small frame") {
+    constexpr size_t kN = 32;
+    std::array<float, 2 * kN> packed{};
+    std::fill(packed.begin(), packed.begin() + kN, 0.25f);
+
+    rpdsp::SpectralFluxOnsetDetector<kN, 15> detector;
+    SUBCASE("Widening past the top bin") {
+        // 3 kHz starts on bin 2, so 15 one-bin-wide bands would end on bin 17 of 16.
+        detector.prepare(48000.0f, kN / 2, 3000.0f, 8000.0f);
+    }
+    SUBCASE("Top edges collapsing below Nyquist") {
+        // 6 kHz to the 22.5 kHz cap spans bins 4..15; the top edges pile up there and widen on.
+        detector.prepare(48000.0f, kN / 2, 6000.0f, 24000.0f);
+    }
+    detector.process(packed.data());
+    // Bin 4 jumps; anything read past the N packed floats jumps far more.
+    packed[8] = 4.0f;
+    std::fill(packed.begin() + kN, packed.end(), 1000.0f);
+    const float novelty = detector.process(packed.data());
+    CHECK(novelty > 2.0f);
+    CHECK(novelty < 3.0f);
+}
+
+TEST_CASE("BeatTracker locks to a click track and BeatClockSync follows it") {
+    constexpr size_t kN = 1024;
+    constexpr size_t kHop = 512;
+    constexpr double kBpm = 128.0;
+    const double samplesPerBeat = 48000.0 * 60.0 / kBpm;
+
+    rpdsp::StftFrameBuilder<kN, kHop> frames;
+    frames.reset();
+    static rpdsp::BeatTracker<kN, kHop> tracker;
+    tracker.prepare(48000.0f);
+    rpdsp::ClockTracker clock;
+    clock.prepare(48000.0f, 100.0f, 96, 8, 4);
+    rpdsp::BeatClockSync sync;
+    sync.reset();
+
+    rpdsp::XorShift32 noise(7);
+    std::vector<float> block(rpdsp::kDefaultBlockSize);
+    float frame[kN];
+    size_t n = 0;
+    std::vector<int> beatTickOffsets;
+    const size_t total = 48000 * 16;
+    while (n < total) {
+        for (float& sample : block) {
+            sample = clickTrack(n++, samplesPerBeat, noise);
+        }
+        // Audio core: push for analysis, then run the clock from the last published tempo.
+        frames.push(block.data(), block.size());
+        sync.process(tracker.published(), clock, block.size());
+        // Control core: consume whatever frames are ready.
+        while (frames.nextFrame(frame)) {
+            tracker.process(frame, frames.lastFrameEnd());
+        }
+        // In the last few seconds, check where the clock sits at each true beat.
+        const size_t blockStart = n - block.size();
+        const double beatIndex = std::ceil(static_cast<double>(blockStart) / samplesPerBeat);
+        if (n > 48000 * 12 && beatIndex * samplesPerBeat < static_cast<double>(n)) {
+            int offset = clock.tick() % 96;
+            beatTickOffsets.push_back(offset > 48 ? offset - 96 : offset);
+        }
+    }
+
+    const rpdsp::TempoEstimate estimate = tracker.published().load();
+    CHECK(estimate.bpm == doctest::Approx(kBpm).epsilon(0.01));
+    CHECK(estimate.confidence > 0.3f);
+    CHECK(clock.bpm() == doctest::Approx(kBpm).epsilon(0.01));
+
+    // The published beat lands within ~12 ms of a true beat.
+    const double phase = std::fmod(static_cast<double>(estimate.beatSample), samplesPerBeat);
+    const double error = std::min(phase, samplesPerBeat - phase);
+    CHECK(error < 600.0);
+
+    // And the clock's ticks sit on a quarter at every true beat (one block of slack).
+    REQUIRE(beatTickOffsets.size() >= 6);
+    for (int offset : beatTickOffsets) {
+        CHECK(std::abs(offset) <= 4);
+    }
+}
+
+TEST_CASE("BeatClockSync never reports negative ticks when it snaps back") {
+    // 120 BPM at 96 PPQ: 250 samples per tick.
+    rpdsp::ClockTracker clock;
+    clock.prepare(48000.0f, 120.0f, 96, 8, 4);
+    for (int i = 0; i < 40; ++i) {
+        clock.advanceTick();
+    }
+    // A beat at sample 0 of the first block finds the clock 40 ticks ahead.
+    rpdsp::Seqlock<rpdsp::TempoEstimate> tempo;
+    tempo.store(rpdsp::TempoEstimate{120.0f, 24000.0f, 1.0f, 0});
+    rpdsp::BeatClockSync sync;
+    sync.reset();
+    CHECK(sync.process(tempo, clock, 32) == 0);
+    CHECK(clock.tick() == 0);
+    // The clock then runs on from the beat.
+    int ticks = 0;
+    for (int block = 0; block < 25; ++block) {
+        const int advanced = sync.process(tempo, clock, 32);
+        CHECK(advanced >= 0);
+        ticks += advanced;
+    }
+    CHECK(ticks == 3);
+}
+
+TEST_CASE("BeatTracker on a decimated click track publishes the true beat phase") {
+    constexpr size_t kFactor = 4;
+    constexpr size_t kN = 512;
+    constexpr size_t kHop = 256;
+    constexpr size_t kSamplesPerBeat = 24000;  // 120 BPM
+    constexpr size_t kFirstBeat = 9000;
+    constexpr size_t kLatency = rpdsp::Decimator<kFactor>::kLatencySamples;
+
+    rpdsp::Decimator<kFactor> decimator;
+    decimator.prepare(48000.0f);
+    rpdsp::StftFrameBuilder<kN, kHop> frames;
+    frames.reset();
+    // The same frames go to a tracker that knows the decimator's delay and one that does not.
+    static rpdsp::BeatTracker<kN, kHop> tracker;
+    static rpdsp::BeatTracker<kN, kHop> uncompensated;
+    tracker.prepare(decimator.outputSampleRate(), kFactor, kLatency);
+    uncompensated.prepare(decimator.outputSampleRate(), kFactor);
+    rpdsp::ClockTracker clock;
+    clock.prepare(48000.0f, 100.0f, 96, 8, 4);
+    rpdsp::BeatClockSync sync;
+    sync.reset();
+
+    rpdsp::XorShift32 noise(11);
+    std::vector<float> block(rpdsp::kDefaultBlockSize);
+    std::vector<float> decimated(rpdsp::kDefaultBlockSize / kFactor);
+    float frame[kN];
+    std::vector<int> beatTickOffsets;
+    size_t n = 0;
+    bool negative = false;
+    while (n < 48000 * 16) {
+        const size_t blockStart = n;
+        for (float& sample : block) {
+            // Beats fall on n = kFirstBeat + k * kSamplesPerBeat.
+            sample = clickTrack(n++ + kSamplesPerBeat - kFirstBeat, static_cast<double>(kSamplesPerBeat), noise);
+        }
+        const size_t written = decimator.process(block.data(), block.size(), decimated.data());
+        frames.push(decimated.data(), written);
+        negative = negative || sync.process(tracker.published(), clock, block.size()) < 0;
+        while (frames.nextFrame(frame)) {
+            tracker.process(frame, frames.lastFrameEnd());
+            uncompensated.process(frame, frames.lastFrameEnd());
+        }
+        // In the last few seconds, check where the clock sits at each true beat.
+        const size_t beat = kFirstBeat + (blockStart + kSamplesPerBeat - kFirstBeat) / kSamplesPerBeat * kSamplesPerBeat;
+        if (n > 48000 * 12 && beat < n) {
+            const int offset = clock.tick() % 96;
+            beatTickOffsets.push_back(offset > 48 ? offset - 96 : offset);
+        }
+    }
+
+    const rpdsp::TempoEstimate estimate = tracker.published().load();
+    CHECK(estimate.bpm == doctest::Approx(120.0f).epsilon(0.01));
+    CHECK_FALSE(negative);
+
+    // The decimator's delay comes off the published beat exactly...
+    CHECK(uncompensated.published().load().beatSample - estimate.beatSample == kLatency);
+    // ...and the beat lands on the known phase, not on the off-beat hat, within one analysis
+    // hop (1024 samples, 21 ms).
+    const std::int32_t drift = static_cast<std::int32_t>((estimate.beatSample + kSamplesPerBeat - kFirstBeat) %
+                                                         kSamplesPerBeat);
+    const std::int32_t error = std::min<std::int32_t>(drift, static_cast<std::int32_t>(kSamplesPerBeat) - drift);
+    CHECK(error < static_cast<std::int32_t>(kFactor * kHop));
+
+    // So the clock's quarters follow the true beats to within the same hop (4 ticks of 250).
+    REQUIRE(beatTickOffsets.size() >= 6);
+    for (int offset : beatTickOffsets) {
+        CHECK(std::abs(offset) <= 4);
+    }
+}
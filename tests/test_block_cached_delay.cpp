@@ -0,0 +1,220 @@
+#include <rpdsp/block_cached_delay.h>
+#include <rpdsp/delay_line.h>
+
+#include "doctest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Set on the thread that plays the audio side, so a transfer made from there is caught even
+// while service() runs concurrently.
+thread_local bool onAudioSide = false;
+std::atomic<int> audioSideTransfers{0};
+
+// Stand-in for QSPI PSRAM: a malloc'd region whose transfers can be made to take real time
+// and are counted, so tests can prove the audio side never touches it.
+class SlowHostBacking {
+ public:
+  SlowHostBacking() = default;
+  SlowHostBacking(float* base, size_t samples, std::chrono::microseconds latency, std::atomic<int>* transfers)
+      : region_(base, samples), latency_(latency), transfers_(transfers) {}
+
+  [[nodiscard]] size_t size() const { return region_.size(); }
+  void read(size_t offset, float* destination, size_t count) const {
+    stall();
+    region_.read(offset, destination, count);
+  }
+  void write(size_t offset, const float* source, size_t count) {
+    stall();
+    region_.write(offset, source, count);
+  }
+
+ private:
+  void stall() const {
+    if (transfers_ != nullptr) {
+      transfers_->fetch_add(1);
+    }
+    if (onAudioSide) {
+      audioSideTransfers.fetch_add(1);
+    }
+    if (latency_.count() > 0) {
+      std::this_thread::sleep_for(latency_);
+    }
+  }
+
+  rpdsp::MemoryRegionBacking region_;
+  std::chrono::microseconds latency_{0};
+  std::atomic<int>* transfers_ = nullptr;
+};
+
+constexpr size_t kBlock = 32;
+constexpr size_t kRegionSamples = 48000;
+
+float inputAt(size_t n) {
+    return static_cast<float>(n % 1000) * 0.001f;
+}
+
+}  // namespace
+
+TEST_CASE("BlockCachedDelay reproduces a long delay when serviced every block") {
+    float* region = static_cast<float*>(std::malloc(kRegionSamples * sizeof(float)));
+    REQUIRE(region != nullptr);
+    std::atomic<int> transfers{0};
+
+    static rpdsp::BlockCachedDelay<kBlock, 4, SlowHostBacking> delay;
+    delay.prepare(48000.0f, SlowHostBacking(region, kRegionSamples, std::chrono::microseconds(0), &transfers));
+    delay.setDelaySamples(30000);
+    delay.setFeedback(0.0f);
+    delay.setMix(1.0f);
+    CHECK(delay.delaySamples() == 30000);
+
+    bool exact = true;
+    float block[kBlock];
+    for (size_t b = 0; b < 3000; ++b) {
+        for (size_t i = 0; i < kBlock; ++i) {
+            block[i] = inputAt(b * kBlock + i);
+        }
+        // Only the audio side runs here, so no transfer may happen inside process().
+        const int before = transfers.load();
+        delay.process(block, block, kBlock);
+        exact = exact && transfers.load() == before;
+        for (size_t i = 0; i < kBlock; ++i) {
+            const size_t n = b * kBlock + i;
+            const float expected = n >= 30000 ? inputAt(n - 30000) : 0.0f;
+            exact = exact && std::fabs(block[i] - expected) < 1.0e-6f;
+        }
+        delay.service();
+    }
+    CHECK(exact);
+    CHECK(delay.underruns() == 0);
+    CHECK(delay.overruns() == 0);
+    std::free(region);
+}
+
+TEST_CASE("BlockCachedDelay clamps delay to the cache and region limits") {
+    static float region[4096];
+    static rpdsp::BlockCachedDelay<kBlock, 4> delay;
+    delay.prepare(48000.0f, rpdsp::MemoryRegionBacking(region, 4096));
+    delay.setDelaySamples(1);
+    CHECK(delay.delaySamples() == delay.minDelaySamples());
+    delay.setDelaySamples(1000000);
+    CHECK(delay.delaySamples() == delay.maxDelaySamples());
+    CHECK(delay.maxDelaySamples() < 4096);
+}
+
+TEST_CASE("BlockCachedDelay silences exactly the blocks a lagging service loses") {
+    float* region = static_cast<float*>(std::malloc(kRegionSamples * sizeof(float)));
+    REQUIRE(region != nullptr);
+
+    // 4000 samples is exactly 125 blocks, so a block written at b is read back at b + 125.
+    static rpdsp::BlockCachedDelay<kBlock, 4, SlowHostBacking> delay;
+    delay.prepare(48000.0f, SlowHostBacking(region, kRegionSamples, std::chrono::microseconds(0), nullptr));
+    delay.setDelaySamples(4000);
+    delay.setFeedback(0.0f);
+    delay.setMix(1.0f);
+
+    // service() is skipped after blocks 200..205, so 200..206 all run on the state it left
+    // after block 199.
+    std::vector<size_t> silentBlocks;
+    size_t wrong = 0;
+    float block[kBlock];
+    for (size_t b = 0; b < 400; ++b) {
+        for (size_t i = 0; i < kBlock; ++i) {
+            block[i] = 0.5f + inputAt(b * kBlock + i);
+        }
+        delay.process(block, block, kBlock);
+        size_t silent = 0;
+        for (size_t i = 0; i < kBlock; ++i) {
+            const size_t n = b * kBlock + i;
+            const float expected = n >= 4000 ? 0.5f + inputAt(n - 4000) : 0.0f;
+            if (block[i] == 0.0f && expected != 0.0f) {
+                ++silent;
+            } else if (std::fabs(block[i] - expected) > 1.0e-6f) {
+                ++wrong;
+            }
+        }
+        if (silent > 0) {
+            CHECK(silent == kBlock);
+            silentBlocks.push_back(b);
+        }
+        if (b < 200 || b > 205) {
+            delay.service();
+        }
+    }
+
+    CHECK(wrong == 0);
+    // Blocks 200..203 fill the four write-behind slots; 204..206 find none free and are dropped.
+    CHECK(delay.overruns() == 3);
+    // The read-ahead ring held the blocks for outputs 199..202; 203..206 find theirs missing.
+    CHECK(delay.underruns() == 4 * kBlock);
+    // The dropped blocks replay as silence 125 blocks later. Blocks 200..202 shared their slots
+    // with dropped ones but were written in full, so outputs 325..327 must replay intact.
+    const std::vector<size_t> expectedSilent = {203, 204, 205, 206, 329, 330, 331};
+    CHECK(silentBlocks == expectedSilent);
+    std::free(region);
+}
+
+TEST_CASE("BlockCachedDelay matches a DelayLine while a second thread services slow memory") {
+    float* region = static_cast<float*>(std::malloc(kRegionSamples * sizeof(float)));
+    REQUIRE(region != nullptr);
+    std::atomic<int> transfers{0};
+
+    // 200 us per transfer, so flushing and fetching one block takes most of the 667 us a
+    // 32-sample block lasts at 48 kHz; the 16-block cache rides out scheduler jitter.
+    constexpr size_t kDelay = 4000;
+    static rpdsp::BlockCachedDelay<kBlock, 16, SlowHostBacking> delay;
+    delay.prepare(48000.0f, SlowHostBacking(region, kRegionSamples, std::chrono::microseconds(200), &transfers));
+    delay.setDelaySamples(kDelay);
+    delay.setFeedback(0.5f);
+    delay.setMix(0.5f);
+    static rpdsp::DelayLine<8192> reference;
+    reference.reset();
+
+    std::atomic<bool> running{true};
+    std::thread service([&] {
+        while (running.load()) {
+            if (delay.service() == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    });
+
+    onAudioSide = true;
+    audioSideTransfers.store(0);
+    const int transfersAfterPrepare = transfers.load();
+    size_t wrong = 0;
+    float block[kBlock];
+    for (size_t b = 0; b < 600; ++b) {
+        for (size_t i = 0; i < kBlock; ++i) {
+            block[i] = 0.5f + inputAt(b * kBlock + i);
+        }
+        float expected[kBlock];
+        for (size_t i = 0; i < kBlock; ++i) {
+            const float delayed = reference.read(kDelay - 1);
+            reference.push(block[i] + delayed * 0.5f);
+            expected[i] = rpdsp::lerp(block[i], delayed, 0.5f);
+        }
+        delay.process(block, block, kBlock);
+        for (size_t i = 0; i < kBlock; ++i) {
+            wrong += std::fabs(block[i] - expected[i]) > 1.0e-6f ? 1 : 0;
+        }
+        // One block period, not a catch-up deadline, so a late wake never bursts blocks.
+        std::this_thread::sleep_for(std::chrono::microseconds(667));
+    }
+    onAudioSide = false;
+    running.store(false);
+    service.join();
+
+    CHECK(audioSideTransfers.load() == 0);
+    CHECK(transfers.load() > transfersAfterPrepare);
+    CHECK(delay.underruns() == 0);
+    CHECK(delay.overruns() == 0);
+    CHECK(wrong == 0);
+    std::free(region);
+}
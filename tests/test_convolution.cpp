@@ -0,0 +1,71 @@
+#include <rpdsp/convolution.h>
+#include <rpdsp/fft.h>
+#include <rpdsp/realtime.h>
+
+#include "doctest.h"
+
+#include <cmath>
+#include <vector>
+
+TEST_CASE("RealFft finds a sinusoid in its bin and round-trips") {
+    constexpr size_t kN = 64;
+    float data[kN];
+    float original[kN];
+    for (size_t i = 0; i < kN; ++i) {
+        original[i] = data[i] = std::cos(rpdsp::kTwoPi * 5.0f * static_cast<float>(i) / kN) + 0.25f;
+    }
+    rpdsp::RealFft<kN>::forward(data);
+    CHECK(data[0] == doctest::Approx(0.25f * kN).epsilon(1e-4));
+    CHECK(data[2 * 5] == doctest::Approx(kN / 2.0f).epsilon(1e-4));
+    CHECK(std::fabs(data[2 * 5 + 1]) < 1e-3f);
+    CHECK(std::fabs(data[2 * 6]) < 1e-3f);
+
+    rpdsp::RealFft<kN>::inverse(data);
+    for (size_t i = 0; i < kN; ++i) {
+        CHECK(data[i] == doctest::Approx(original[i]).epsilon(1e-4));
+    }
+}
+
+TEST_CASE("PartitionedConvolver matches direct convolution with zero latency") {
+    constexpr size_t kBlock = 32;
+    constexpr size_t kTaps = 200;  // 7 partitions, the last one partial
+    std::vector<float> ir(kTaps);
+    rpdsp::XorShift32 rng(7);
+    for (size_t i = 0; i < kTaps; ++i) {
+        ir[i] = rng.nextBipolar() * std::exp(-0.02f * static_cast<float>(i));
+    }
+
+    static rpdsp::PartitionedConvolver<8, kBlock> convolver;
+    convolver.setImpulseResponse(ir.data(), ir.size());
+    CHECK(convolver.partitions() == 7);
+
+    std::vector<float> input(kBlock * 20);
+    for (auto& x : input) {
+        x = rng.nextBipolar();
+    }
+
+    float maxError = 0.0f;
+    for (size_t b = 0; b < 20; ++b) {
+        float block[kBlock];
+        for (size_t i = 0; i < kBlock; ++i) {
+            block[i] = input[b * kBlock + i];
+        }
+        convolver.process(block, block);
+        for (size_t i = 0; i < kBlock; ++i) {
+            const size_t n = b * kBlock + i;
+            float expected = 0.0f;
+            for (size_t k = 0; k < kTaps && k <= n; ++k) {
+                expected += ir[k] * input[n - k];
+            }
+            maxError = std::max(maxError, std::fabs(block[i] - expected));
+        }
+    }
+    CHECK(maxError < 1e-4f);
+}
+
+TEST_CASE("PartitionedConvolver cost model fits a useful IR in the 0.333 ms budget") {
+    // 0.333 ms at 200 MHz is ~66k cycles per 32-frame block.
+    using Convolver = rpdsp::PartitionedConvolver<64, 32>;
+    CHECK(Convolver::estimatedCyclesPerBlock(64) < 66000);
+    CHECK(Convolver::estimatedCyclesPerBlock(1) < Convolver::estimatedCyclesPerBlock(2));
+}
@@ -0,0 +1,222 @@
+#include <rpdsp/audio_arena.h>
+#include <rpdsp/delay_line.h>
+#include <rpdsp/effects.h>
+
+#include "doctest.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+TEST_CASE("DelayLine integer reads return the pushed history") {
+    rpdsp::DelayLine<8> line;
+    for (int i = 1; i <= 10; ++i) {
+        line.push(static_cast<float>(i));
+    }
+    CHECK(line.read(0) == doctest::Approx(10.0f));
+    CHECK(line.read(3) == doctest::Approx(7.0f));
+    CHECK(line.read(7) == doctest::Approx(3.0f));
+    CHECK(line.readLinear(1.5f) == doctest::Approx(8.5f));
+}
+
+TEST_CASE("16-bit storage policies halve delay memory") {
+    CHECK(sizeof(rpdsp::DelayLine<48000, rpdsp::Q15Storage>) < sizeof(rpdsp::DelayLine<48000>) / 2 + 64);
+    CHECK(sizeof(rpdsp::DelayLine<48000, rpdsp::BFloat16Storage>) < sizeof(rpdsp::DelayLine<48000>) / 2 + 64);
+}
+
+TEST_CASE("Q15Storage round-trips within dither error and clips at full scale") {
+    rpdsp::DelayLine<64, rpdsp::Q15Storage> line;
+    float maxError = 0.0f;
+    for (int i = 0; i < 64; ++i) {
+        const float value = 0.9f * std::sin(0.1f * static_cast<float>(i));
+        line.push(value);
+        maxError = std::max(maxError, std::fabs(line.read(0) - value));
+    }
+    // Rounding plus +/-1 LSB triangular dither stays within 1.5 LSB.
+    CHECK(maxError <= 1.5f / 32768.0f);
+
+    line.push(4.0f);
+    CHECK(line.read(0) <= 1.0f);
+    line.push(-4.0f);
+    CHECK(line.read(0) == doctest::Approx(-1.0f));
+}
+
+TEST_CASE("Q15Storage lines dither independently") {
+    rpdsp::DelayLine<64, rpdsp::Q15Storage> lines[2];
+    int differing = 0;
+    for (int i = 0; i < 256; ++i) {
+        lines[0].push(0.3f);
+        lines[1].push(0.3f);
+        differing += lines[0].read(0) != lines[1].read(0) ? 1 : 0;
+    }
+    // With +/-1 LSB of dither, 0.3 lands on one of three codes. Identical seeds would match on
+    // every push; independent ones disagree on roughly half of them.
+    CHECK(differing > 64);
+}
+
+TEST_CASE("Float delay lines carry no storage padding") {
+    CHECK(sizeof(rpdsp::DelayLine<64>) == sizeof(std::array<float, 64>) + sizeof(size_t));
+    // Q15Storage carries its dither state; the empty float policy must not cost the same.
+    CHECK(sizeof(rpdsp::DelayLineView<>) < sizeof(rpdsp::DelayLineView<rpdsp::Q15Storage>));
+}
+
+TEST_CASE("BFloat16Storage keeps headroom with relative precision") {
+    rpdsp::DelayLine<4, rpdsp::BFloat16Storage> line;
+    for (float value : {0.001f, -0.37f, 3.5f, 100.0f}) {
+        line.push(value);
+        CHECK(line.read(0) == doctest::Approx(value).epsilon(1.0f / 256.0f));
+    }
+}
+
+TEST_CASE("Effects accept a storage policy") {
+    rpdsp::Delay<4800, rpdsp::Q15Storage> echo;
+    echo.prepare(48000.0f);
+    echo.setDelaySamples(10.0f);
+    echo.setMix(1.0f);
+    float peak = 0.0f;
+    for (int i = 0; i < 20; ++i) {
+        const float out = echo.process(i == 0 ? 0.5f : 0.0f);
+        peak = std::max(peak, std::fabs(out));
+    }
+    CHECK(peak == doctest::Approx(0.5f).epsilon(0.001f));
+    CHECK(sizeof(rpdsp::DattorroPlateReverb<48000, 1024, rpdsp::Q15Storage>) <
+          sizeof(rpdsp::DattorroPlateReverb<48000>) / 2 + 1024);
+}
+
+TEST_CASE("Power-of-two DelayLine matches the compare-and-branch line") {
+    rpdsp::DelayLine<64> masked;
+    rpdsp::DelayLine<65> wrapped;
+    static_assert(rpdsp::DelayLine<64>::kMasked, "64 should take the masked path");
+    static_assert(!rpdsp::DelayLine<65>::kMasked, "65 should take the wrapping path");
+    bool same = true;
+    for (int i = 0; i < 300; ++i) {
+        const float x = std::sin(0.37f * static_cast<float>(i));
+        masked.push(x);
+        wrapped.push(x);
+        for (float d : {0.0f, 0.4f, 1.3f, 17.75f, 61.5f, 63.0f}) {
+            same = same && masked.readCubic(d) == doctest::Approx(wrapped.readCubic(d));
+        }
+    }
+    CHECK(same);
+}
+
+TEST_CASE("DelayLine block write/read matches per-sample push/read") {
+    rpdsp::DelayLine<32> block;
+    rpdsp::DelayLine<32> single;
+    float input[20];
+    bool same = true;
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 20; ++i) {
+            input[i] = static_cast<float>(round * 20 + i);
+            single.push(input[i]);
+        }
+        block.write(input, 20);
+        float out[12];
+        block.read(out, 12, 5);
+        for (int i = 0; i < 12; ++i) {
+            same = same && out[i] == single.read(static_cast<size_t>(5 + 11 - i));
+        }
+    }
+    CHECK(same);
+}
+
+TEST_CASE("MultiTap reads weighted taps in one pass") {
+    rpdsp::DelayLine<16> line;
+    for (int i = 1; i <= 16; ++i) {
+        line.push(static_cast<float>(i));
+    }
+    rpdsp::MultiTap<3> taps;
+    taps.setTap(0, 0, 1.0f);
+    taps.setTap(1, 4, 0.5f);
+    taps.setTap(2, 15, -1.0f);
+    const auto values = taps.read(line);
+    CHECK(values[0] == doctest::Approx(16.0f));
+    CHECK(values[1] == doctest::Approx(12.0f));
+    CHECK(values[2] == doctest::Approx(1.0f));
+    CHECK(taps.mix(line) == doctest::Approx(16.0f + 6.0f - 1.0f));
+}
+
+TEST_CASE("Comb and allpass block forms match per-sample processing") {
+    for (size_t delay : {3u, 40u, 200u}) {
+        rpdsp::CombFilter<256> combA;
+        rpdsp::CombFilter<256> combB;
+        rpdsp::AllpassFilter<256> allpassA;
+        rpdsp::AllpassFilter<256> allpassB;
+        combA.setDelaySamples(delay);
+        combB.setDelaySamples(delay);
+        allpassA.setDelaySamples(delay);
+        allpassB.setDelaySamples(delay);
+
+        bool same = true;
+        float comb[32];
+        float allpass[32];
+        for (int block = 0; block < 40; ++block) {
+            for (int i = 0; i < 32; ++i) {
+                comb[i] = allpass[i] = std::sin(0.05f * static_cast<float>(block * 32 + i));
+            }
+            float expectComb[32];
+            float expectAllpass[32];
+            for (int i = 0; i < 32; ++i) {
+                expectComb[i] = combA.process(comb[i]);
+                expectAllpass[i] = allpassA.process(allpass[i]);
+            }
+            combB.process(comb, 32);
+            allpassB.process(allpass, 32);
+            for (int i = 0; i < 32; ++i) {
+                same = same && comb[i] == doctest::Approx(expectComb[i]) &&
+                       allpass[i] == doctest::Approx(expectAllpass[i]);
+            }
+        }
+        CHECK(same);
+    }
+}
+
+TEST_CASE("AudioArena hands out aligned buffers until exhausted") {
+    static rpdsp::AudioArena<1024> arena;
+    arena.reset();
+    std::int16_t* a = arena.allocate<std::int16_t>(3);
+    float* b = arena.allocate<float>(10);
+    REQUIRE(a != nullptr);
+    REQUIRE(b != nullptr);
+    CHECK(reinterpret_cast<std::uintptr_t>(b) % alignof(float) == 0);
+    CHECK(arena.used() == 48);
+    CHECK(arena.allocate<float>(1000) == nullptr);
+    CHECK(arena.used() == 48);
+
+    const auto generation = arena.generation();
+    arena.reset();
+    CHECK(arena.used() == 0);
+    CHECK(arena.generation() != generation);
+}
+
+TEST_CASE("DelayLineView sized at prepare time behaves like DelayLine") {
+    static rpdsp::AudioArena<4096> arena;
+    arena.reset();
+    rpdsp::DelayLineView<> view;
+    rpdsp::DelayLine<100> fixed;
+    REQUIRE(view.prepare(arena, 100));
+    CHECK(view.capacity() == 100);
+
+    bool same = true;
+    for (int i = 0; i < 250; ++i) {
+        const float x = std::sin(0.21f * static_cast<float>(i));
+        view.push(x);
+        fixed.push(x);
+        same = same && view.read(37) == fixed.read(37) &&
+               view.readCubic(12.25f) == doctest::Approx(fixed.readCubic(12.25f));
+    }
+    CHECK(same);
+
+    // A patch that asks for more than the arena holds fails in prepare, not in the callback.
+    rpdsp::DelayLineView<> tooLong;
+    CHECK_FALSE(tooLong.prepare(arena, 100000));
+    CHECK(tooLong.read(0) == 0.0f);
+
+    // After a reset the view must be prepared again (debug builds assert otherwise), and it
+    // comes back silent on the reused memory.
+    arena.reset();
+    REQUIRE(view.prepare(arena, 64));
+    view.push(1.0f);
+    CHECK(view.read(0) == 1.0f);
+    CHECK(view.read(1) == 0.0f);
+}
@@ -0,0 +1,258 @@
+#include <rpdsp/crossover.h>
+#include <rpdsp/dynamics.h>
+#include <rpdsp/realtime.h>
+
+#include "doctest.h"
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+constexpr double kTwoPiD = 2.0 * 3.14159265358979323846;
+
+// Magnitude in dB of an impulse response at one frequency.
+double responseDb(const std::vector<float>& impulse, double hz) {
+    std::complex<double> sum = 0.0;
+    for (size_t n = 0; n < impulse.size(); ++n) {
+        sum += static_cast<double>(impulse[n]) * std::polar(1.0, -kTwoPiD * hz * static_cast<double>(n) / kSampleRate);
+    }
+    return 20.0 * std::log10(std::abs(sum));
+}
+
+template <size_t Bands>
+std::array<std::vector<float>, Bands> splitImpulse(rpdsp::BandSplitter<Bands>& splitter, size_t length) {
+    std::array<std::vector<float>, Bands> responses;
+    for (auto& response : responses) {
+        response.resize(length);
+    }
+    std::array<float, Bands> bands{};
+    for (size_t n = 0; n < length; ++n) {
+        splitter.process(n == 0 ? 1.0f : 0.0f, bands);
+        for (size_t b = 0; b < Bands; ++b) {
+            responses[b][n] = bands[b];
+        }
+    }
+    return responses;
+}
+
+template <size_t Bands>
+void checkFlatSum() {
+    rpdsp::BandSplitter<Bands> splitter;
+    splitter.prepare(kSampleRate);
+    const auto responses = splitImpulse(splitter, 16384);
+    std::vector<float> sum(responses[0].size(), 0.0f);
+    for (const auto& response : responses) {
+        for (size_t n = 0; n < sum.size(); ++n) {
+            sum[n] += response[n];
+        }
+    }
+    for (double hz : {30.0, 120.0, 200.0, 500.0, 800.0, 1000.0, 2000.0, 5000.0, 12000.0}) {
+        CHECK(std::fabs(responseDb(sum, hz)) < 0.01);
+    }
+}
+
+void renderSine(std::vector<float>& out, double hz, float amplitude, double& phase) {
+    for (float& sample : out) {
+        sample = amplitude * static_cast<float>(std::sin(phase));
+        phase = std::fmod(phase + kTwoPiD * hz / kSampleRate, kTwoPiD);
+    }
+}
+
+float rms(const std::vector<float>& samples, size_t from) {
+    double sum = 0.0;
+    for (size_t i = from; i < samples.size(); ++i) {
+        sum += static_cast<double>(samples[i]) * samples[i];
+    }
+    return static_cast<float>(std::sqrt(sum / static_cast<double>(samples.size() - from)));
+}
+
+}  // namespace
+
+TEST_CASE("LinkwitzRileyCrossover bands are -6 dB at the crossover and 24 dB/oct outside") {
+    rpdsp::BandSplitter<2> splitter;
+    splitter.prepare(kSampleRate);
+    CHECK(splitter.crossover(0) == doctest::Approx(1000.0f));
+    const auto responses = splitImpulse(splitter, 16384);
+    CHECK(responseDb(responses[0], 1000.0) == doctest::Approx(-6.02).epsilon(0.01));
+    CHECK(responseDb(responses[1], 1000.0) == doctest::Approx(-6.02).epsilon(0.01));
+    CHECK(responseDb(responses[0], 4000.0) < -46.0);
+    CHECK(responseDb(responses[1], 250.0) < -46.0);
+}
+
+TEST_CASE("BandSplitter bands sum back flat") {
+    checkFlatSum<2>();
+    checkFlatSum<3>();
+    checkFlatSum<4>();
+}
+
+TEST_CASE("MultibandCompressor leaves quiet material at unity level") {
+    rpdsp::MultibandCompressor<3> compressor;
+    compressor.prepare(kSampleRate);
+    std::vector<float> left(48000);
+    double phase = 0.0;
+    renderSine(left, 440.0, 0.01f, phase);
+    std::vector<float> right = left;
+    const float inputRms = rms(left, 24000);
+    for (size_t offset = 0; offset < left.size(); offset += rpdsp::kDefaultBlockSize) {
+        compressor.process(left.data() + offset, right.data() + offset, rpdsp::kDefaultBlockSize);
+    }
+    CHECK(rms(left, 24000) == doctest::Approx(inputRms).epsilon(0.002));
+    CHECK(rms(right, 24000) == doctest::Approx(inputRms).epsilon(0.002));
+    for (size_t b = 0; b < 3; ++b) {
+        CHECK(compressor.gainReductionDb(b) == doctest::Approx(0.0f));
+    }
+}
+
+TEST_CASE("MultibandCompressor only compresses the band that crosses its threshold") {
+    rpdsp::MultibandCompressor<3> compressor;
+    compressor.prepare(kSampleRate);
+    for (size_t b = 0; b < 3; ++b) {
+        compressor.setThresholdDb(b, -20.0f);
+        compressor.setRatio(b, 4.0f);
+        compressor.setAttackRelease(b, 1.0f, 50.0f);
+    }
+
+    // Loud bass at 0 dBFS peak, quiet treble at -40 dBFS.
+    std::vector<float> bass(96000);
+    std::vector<float> treble(96000);
+    double bassPhase = 0.0;
+    double treblePhase = 0.0;
+    renderSine(bass, 60.0, 1.0f, bassPhase);
+    renderSine(treble, 8000.0, 0.01f, treblePhase);
+    std::vector<float> left(bass.size());
+    for (size_t i = 0; i < left.size(); ++i) {
+        left[i] = bass[i] + treble[i];
+    }
+    std::vector<float> right = left;
+    for (size_t offset = 0; offset < left.size(); offset += rpdsp::kDefaultBlockSize) {
+        compressor.process(left.data() + offset, right.data() + offset, rpdsp::kDefaultBlockSize);
+    }
+
+    // 20 dB over a 4:1 threshold wants 15 dB of reduction; the peak detector rides slightly under.
+    CHECK(compressor.gainReductionDb(0) < -12.0f);
+    CHECK(compressor.gainReductionDb(0) > -15.5f);
+    CHECK(compressor.gainReductionDb(1) == doctest::Approx(0.0f));
+    CHECK(compressor.gainReductionDb(2) == doctest::Approx(0.0f));
+    CHECK(rms(left, 48000) < 0.25f);
+
+    // The treble passes at unity: its 8 kHz component is untouched.
+    rpdsp::BandSplitter<3> probe;
+    probe.prepare(kSampleRate);
+    std::array<float, 3> bands{};
+    std::vector<float> high(left.size());
+    for (size_t i = 0; i < left.size(); ++i) {
+        probe.process(left[i], bands);
+        high[i] = bands[2];
+    }
+    CHECK(rms(high, 48000) == doctest::Approx(0.01f / std::sqrt(2.0f)).epsilon(0.03));
+}
+
+TEST_CASE("SlidingMaximum matches a brute-force window maximum") {
+    rpdsp::SlidingMaximum<32> maximum;
+    maximum.setWindow(17);
+    rpdsp::XorShift32 noise(3);
+    std::vector<float> history;
+    for (size_t n = 0; n < 5000; ++n) {
+        const float value = noise.nextBipolar();
+        history.push_back(value);
+        const size_t first = history.size() > 17 ? history.size() - 17 : 0;
+        float expected = history[first];
+        for (size_t i = first; i < history.size(); ++i) {
+            expected = std::max(expected, history[i]);
+        }
+        CHECK(maximum.process(value) == expected);
+    }
+}
+
+TEST_CASE("LookaheadLimiter is transparent below the ceiling") {
+    rpdsp::LookaheadLimiter<> limiter;
+    limiter.prepare(kSampleRate);
+    const size_t latency = limiter.latencySamples();
+    CHECK(latency == 48);
+
+    std::vector<float> input(4096);
+    double phase = 0.0;
+    renderSine(input, 440.0, 0.9f, phase);
+    std::vector<float> left = input;
+    std::vector<float> right = input;
+    limiter.process(left.data(), right.data(), left.size());
+    for (size_t n = latency; n < input.size(); ++n) {
+        CHECK(left[n] == input[n - latency]);
+    }
+    CHECK(limiter.gainReductionDb() == doctest::Approx(0.0f));
+}
+
+TEST_CASE("LookaheadLimiter passes audio at unity before prepare") {
+    rpdsp::LookaheadLimiter<> limiter;
+    const size_t latency = limiter.latencySamples();
+    for (size_t n = 0; n < 64; ++n) {
+        float left = 0.5f;
+        float right = -0.5f;
+        limiter.process(left, right);
+        if (n >= latency) {
+            CHECK(left == 0.5f);
+            CHECK(right == -0.5f);
+        }
+    }
+    CHECK(limiter.gainReductionDb() == doctest::Approx(0.0f));
+}
+
+TEST_CASE("LookaheadLimiter never exceeds the ceiling and ramps its gain") {
+    rpdsp::LookaheadLimiter<> limiter;
+    limiter.prepare(kSampleRate);
+    limiter.setCeilingDb(-1.0f);
+    const float ceiling = rpdsp::dbToGain(-1.0f);
+
+    // Quiet noise with loud isolated spikes and a loud burst: the worst case for a limiter.
+    rpdsp::XorShift32 noise(11);
+    std::vector<float> left(48000);
+    std::vector<float> right(48000);
+    for (size_t n = 0; n < left.size(); ++n) {
+        const float level = (n > 20000 && n < 30000) ? 3.0f : 0.3f;
+        left[n] = level * noise.nextBipolar();
+        right[n] = level * noise.nextBipolar();
+        if (n % 4999 == 0) {
+            left[n] = 8.0f;
+        }
+    }
+
+    float maxStep = 0.0f;
+    float previousGain = 1.0f;
+    float loudest = 0.0f;
+    for (size_t n = 0; n < left.size(); ++n) {
+        limiter.process(left[n], right[n]);
+        loudest = std::max(loudest, std::max(std::fabs(left[n]), std::fabs(right[n])));
+        const float gain = rpdsp::dbToGain(limiter.gainReductionDb());
+        maxStep = std::max(maxStep, std::fabs(gain - previousGain));
+        previousGain = gain;
+    }
+    CHECK(loudest <= ceiling * 1.00001f);
+    // The attack is spread over the 48-sample lookahead rather than landing in one step.
+    CHECK(maxStep < 1.0f / 48.0f);
+}
+
+TEST_CASE("LookaheadLimiter fused 24-in-32 output matches limit-then-pack") {
+    rpdsp::LookaheadLimiter<> fused;
+    rpdsp::LookaheadLimiter<> separate;
+    fused.prepare(kSampleRate);
+    separate.prepare(kSampleRate);
+
+    std::vector<float> mix(512);
+    double phase = 0.0;
+    renderSine(mix, 220.0, 1.7f, phase);
+    std::vector<int32_t> packed(2 * mix.size());
+    fused.processToInt24x32(mix.data(), mix.data(), packed.data(), mix.size());
+
+    std::vector<float> left = mix;
+    std::vector<float> right = mix;
+    separate.process(left.data(), right.data(), left.size());
+    for (size_t n = 0; n < mix.size(); ++n) {
+        CHECK(packed[2 * n] == rpdsp::toInt24x32(left[n]));
+        CHECK(packed[2 * n + 1] == rpdsp::toInt24x32(right[n]));
+    }
+}
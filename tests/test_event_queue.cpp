@@ -0,0 +1,171 @@
+#include <rpdsp/event_queue.h>
+
+#include "doctest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using rpdsp::Event;
+
+constexpr size_t kFrames = 32;
+
+// Records what process() asked for: the render spans and the offset each event landed on.
+struct Trace {
+  std::vector<std::pair<size_t, size_t>> spans;
+  std::vector<std::pair<size_t, Event>> applied;
+  size_t position = 0;
+
+  template <size_t Capacity>
+  void block(rpdsp::EventQueue<Capacity>& queue) {
+    spans.clear();
+    applied.clear();
+    position = 0;
+    queue.process(
+        kFrames, [&](const Event& event) { applied.emplace_back(position, event); },
+        [&](size_t offset, size_t count) {
+          CHECK(offset == position);
+          spans.emplace_back(offset, count);
+          position += count;
+        });
+    CHECK(position == kFrames);
+  }
+};
+
+}  // namespace
+
+TEST_CASE("EventQueue splits the block at each event's sample offset") {
+    rpdsp::EventQueue<8> queue;
+    queue.reset(1000);
+    REQUIRE(queue.push(Event::noteOn(1005, 60, 0.8f)));
+    REQUIRE(queue.push(Event::parameter(1020, 3, 0.25f)));
+    REQUIRE(queue.push(Event::noteOff(1040, 60)));
+    CHECK(queue.size() == 3);
+
+    Trace trace;
+    trace.block(queue);
+    REQUIRE(trace.spans.size() == 3);
+    CHECK(trace.spans[0] == std::make_pair<size_t, size_t>(0, 5));
+    CHECK(trace.spans[1] == std::make_pair<size_t, size_t>(5, 15));
+    CHECK(trace.spans[2] == std::make_pair<size_t, size_t>(20, 12));
+    REQUIRE(trace.applied.size() == 2);
+    CHECK(trace.applied[0].first == 5);
+    CHECK(trace.applied[0].second.type == Event::Type::kNoteOn);
+    CHECK(trace.applied[0].second.note() == 60);
+    CHECK(trace.applied[0].second.value == 0.8f);
+    CHECK(trace.applied[1].first == 20);
+    CHECK(trace.applied[1].second.number == 3);
+    CHECK(queue.now() == 1032);
+    CHECK(queue.size() == 1);
+
+    // The note-off is 8 frames into the next block.
+    trace.block(queue);
+    REQUIRE(trace.applied.size() == 1);
+    CHECK(trace.applied[0].first == 8);
+    CHECK(trace.applied[0].second.type == Event::Type::kNoteOff);
+    CHECK(queue.size() == 0);
+
+    // An empty queue renders the block in one span.
+    trace.block(queue);
+    REQUIRE(trace.spans.size() == 1);
+    CHECK(trace.spans[0].second == kFrames);
+}
+
+TEST_CASE("EventQueue applies late and out-of-order events without going backwards") {
+    rpdsp::EventQueue<4> queue;
+    queue.reset(100);
+    REQUIRE(queue.push(Event::noteOn(90, 64, 1.0f)));  // already late
+    REQUIRE(queue.push(Event::controlChange(110, 74, 0.5f, 2)));
+    REQUIRE(queue.push(Event::noteOff(105)));  // earlier than the event before it
+    REQUIRE(queue.push(Event::noteOn(100, 67, 0.5f)));
+    CHECK_FALSE(queue.push(Event::noteOn(120, 69, 0.5f)));  // full: dropped, nothing overwritten
+
+    Trace trace;
+    trace.block(queue);
+    REQUIRE(trace.applied.size() == 4);
+    CHECK(trace.applied[0].first == 0);
+    CHECK(trace.applied[1].first == 10);
+    CHECK(trace.applied[1].second.channel == 2);
+    CHECK(trace.applied[2].first == 10);
+    CHECK(trace.applied[2].second.note() == -1);
+    CHECK(trace.applied[3].first == 10);
+    CHECK(trace.applied[3].second.note() == 67);
+}
+
+TEST_CASE("EventQueue handles the frame clock wrapping around") {
+    rpdsp::EventQueue<4> queue;
+    queue.reset(0xfffffff0u);
+    REQUIRE(queue.push(Event::noteOn(0xfffffff8u, 60, 1.0f)));
+    REQUIRE(queue.push(Event::noteOff(4, 60)));
+
+    Trace trace;
+    trace.block(queue);
+    REQUIRE(trace.applied.size() == 2);
+    CHECK(trace.applied[0].first == 8);
+    CHECK(trace.applied[1].first == 20);
+    CHECK(queue.now() == 0x10u);
+}
+
+TEST_CASE("EventQueue delivers every event intact and in order across threads") {
+    constexpr int kEvents = 20000;
+    constexpr std::uint32_t kLatency = 4 * kFrames;
+    rpdsp::EventQueue<16> queue;
+    queue.reset();
+    std::atomic<bool> done{false};
+
+    // The host audio thread is not paced by a DAC, so some events arrive late; those must land
+    // on the block start, and every other one on its exact frame.
+    std::vector<float> values;
+    values.reserve(kEvents);
+    int misplaced = 0;
+    int late = 0;
+    std::thread audio([&] {
+        std::uint32_t lastTime = 0;
+        while (!done.load() || queue.size() != 0) {
+            const std::uint32_t start = queue.now();
+            std::uint32_t position = 0;
+            queue.process(
+                kFrames,
+                [&](const Event& event) {
+                    const bool isLate = static_cast<std::int32_t>(event.time - start) < 0;
+                    late += isLate ? 1 : 0;
+                    if (start + position != (isLate ? start : event.time) ||
+                        (!values.empty() && event.time <= lastTime)) {
+                        ++misplaced;
+                    }
+                    lastTime = event.time;
+                    values.push_back(event.value);
+                },
+                [&](size_t offset, size_t count) { position = static_cast<std::uint32_t>(offset + count); });
+            std::this_thread::yield();
+        }
+    });
+
+    // Each event is stamped a fixed latency ahead of the audio clock, in strictly rising order.
+    std::uint32_t last = 0;
+    for (int i = 0; i < kEvents; ++i) {
+        const std::uint32_t time = std::max(queue.now() + kLatency + static_cast<std::uint32_t>(i % 7), last + 1);
+        last = time;
+        while (!queue.push(Event::parameter(time, 1, static_cast<float>(i)))) {
+            std::this_thread::yield();
+        }
+    }
+    done.store(true);
+    audio.join();
+
+    CHECK(misplaced == 0);
+    CHECK(late < kEvents);
+    REQUIRE(values.size() == static_cast<size_t>(kEvents));
+    int mismatches = 0;
+    for (int i = 0; i < kEvents; ++i) {
+        if (values[static_cast<size_t>(i)] != static_cast<float>(i)) {
+            ++mismatches;
+        }
+    }
+    CHECK(mismatches == 0);
+}
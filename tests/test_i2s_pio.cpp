@@ -0,0 +1,263 @@
+// Bitstream checks for the I2S/TDM PIO programs, run on the host by a small cycle-level model
+// of the state machine. The generated header is target-only; with PICO_NO_HARDWARE it reduces
+// to the instruction arrays and wrap/entry constants, which is all the model needs.
+#include <cstdint>
+
+#define PICO_RP2350 1
+#define PICO_NO_HARDWARE 1
+#include <pico_audio_i2s/audio_i2s.pio.h>
+
+#include <rpdsp/realtime.h>
+#include <rpdsp/sample_format.h>
+
+#include "doctest.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+struct Program {
+  const uint16_t* code;
+  unsigned wrapTarget;
+  unsigned wrap;
+  unsigned entry;
+  bool swapped;  // side-set bit 1 is BCLK instead of bit 0
+};
+
+#define PIO_PROGRAM(name, swapped) \
+  Program { name##_program_instructions, name##_wrap_target, name##_wrap, name##_offset_entry_point, swapped }
+
+// One BCLK rising edge: what a receiver samples.
+struct Edge {
+  uint64_t cycle;
+  bool frame;  // LRCLK or FSYNC
+  bool data;
+};
+
+struct Capture {
+  std::vector<Edge> edges;
+  std::vector<uint32_t> received;  // RX FIFO words, duplex programs only
+  uint64_t highCycles = 0;
+};
+
+// Runs from the entry point until an autopull finds the TX FIFO empty. Supports the subset the
+// audio programs use: out pins/null, in pins, jmp always/x--, set x, mov x,y, 2-bit side-set,
+// delay, and autopull/autopush at 32 bits shifting left. The input pin is looped back from the
+// data output.
+Capture run(const Program& program, const std::vector<uint32_t>& tx, uint32_t y = 0) {
+    Capture capture;
+    uint32_t osr = 0;
+    unsigned osrCount = 32;
+    uint32_t isr = 0;
+    unsigned isrCount = 0;
+    uint32_t x = 0;
+    size_t next = 0;
+    unsigned pc = program.entry;
+    bool data = false;
+    bool bclk = false;
+    uint64_t cycle = 0;
+    for (;;) {
+        const uint16_t instr = program.code[pc];
+        const unsigned side = (instr >> 11) & 3u;
+        const unsigned delay = (instr >> 8) & 7u;
+        const unsigned arg = (instr >> 5) & 7u;
+        unsigned target = pc == program.wrap ? program.wrapTarget : pc + 1;
+        switch (instr >> 13) {
+            case 0: {  // jmp
+                const bool taken = arg == 0 || (arg == 2 && x-- != 0);
+                REQUIRE((arg == 0 || arg == 2));
+                if (taken) {
+                    target = instr & 31u;
+                }
+                break;
+            }
+            case 2:  // in pins
+                REQUIRE(arg == 0);
+                isr = (isr << 1) | (data ? 1u : 0u);
+                if (++isrCount == 32) {
+                    capture.received.push_back(isr);
+                    isrCount = 0;
+                }
+                break;
+            case 3:  // out pins / null
+                REQUIRE((arg == 0 || arg == 3));
+                if (osrCount == 32) {
+                    if (next == tx.size()) {
+                        return capture;
+                    }
+                    osr = tx[next++];
+                    osrCount = 0;
+                }
+                if (arg == 0) {
+                    data = (osr >> 31) != 0;
+                }
+                osr <<= 1;
+                ++osrCount;
+                break;
+            case 5:  // mov x, y
+                REQUIRE(instr == (0xa022u | (instr & 0x1f00u)));
+                x = y;
+                break;
+            case 7:  // set x
+                REQUIRE(arg == 1);
+                x = instr & 31u;
+                break;
+            default:
+                FAIL("unsupported instruction");
+        }
+        const bool newBclk = ((side >> (program.swapped ? 1 : 0)) & 1u) != 0;
+        const bool frame = ((side >> (program.swapped ? 0 : 1)) & 1u) != 0;
+        if (newBclk && !bclk) {
+            capture.edges.push_back({cycle, frame, data});
+        }
+        bclk = newBclk;
+        capture.highCycles += bclk ? delay + 1 : 0;
+        cycle += delay + 1;
+        pc = target;
+    }
+}
+
+// The serial stream the receiver should see: a leading edge from the entry instruction, then
+// every FIFO word MSB first. The frame signal for the bit at stream position n is the one
+// that belongs to bit n + 1, i.e. it leads the data by one BCLK.
+std::vector<bool> referenceData(const std::vector<uint32_t>& words) {
+    std::vector<bool> bits{false};
+    for (uint32_t word : words) {
+        for (int b = 31; b >= 0; --b) {
+            bits.push_back(((word >> b) & 1u) != 0);
+        }
+    }
+    return bits;
+}
+
+// I2S: LRCLK high for the first slot after entry, flipping every slotBits.
+bool referenceLrclk(size_t n, size_t slotBits) {
+    return ((n / slotBits) & 1u) == 0;
+}
+
+// TDM: a one-bit FSYNC pulse on the last bit of each frame.
+bool referenceFsync(size_t n, size_t frameBits) {
+    return n % frameBits == 0;
+}
+
+std::vector<uint32_t> testWords(size_t count) {
+    rpdsp::XorShift32 noise(0x1234u);
+    std::vector<uint32_t> words(count);
+    for (uint32_t& word : words) {
+        word = noise.nextU32();
+    }
+    words[0] = 0x80000001u;  // MSB and LSB of the first slot are both set
+    return words;
+}
+
+void checkBclk(const Capture& capture, unsigned cyclesPerBit) {
+    REQUIRE(capture.edges.size() > 2);
+    // The entry instruction only holds BCLK high for one cycle, so spacing starts at edge 1.
+    bool even = true;
+    for (size_t i = 2; i < capture.edges.size(); ++i) {
+        even = even && capture.edges[i].cycle - capture.edges[i - 1].cycle == cyclesPerBit;
+    }
+    CHECK(even);
+    const uint64_t span = capture.edges.back().cycle - capture.edges[1].cycle;
+    CHECK(capture.highCycles >= span / 2);
+    CHECK(capture.highCycles <= span / 2 + cyclesPerBit);
+}
+
+}  // namespace
+
+TEST_CASE("I2S programs clock each word MSB first with LRCLK one bit ahead") {
+    const std::vector<uint32_t> words = testWords(12);
+    const std::vector<bool> bits = referenceData(words);
+    struct Case {
+        Program program;
+        size_t slotBits;
+        unsigned cyclesPerBit;
+    };
+    const Case cases[] = {
+        {PIO_PROGRAM(audio_i2s, false), 16, 2},
+        {PIO_PROGRAM(audio_i2s_swapped, true), 16, 2},
+        {PIO_PROGRAM(audio_i2s_32, false), 32, 2},
+        {PIO_PROGRAM(audio_i2s_32_swapped, true), 32, 2},
+        {PIO_PROGRAM(audio_i2s_duplex, false), 16, 4},
+        {PIO_PROGRAM(audio_i2s_duplex_swapped, true), 16, 4},
+        {PIO_PROGRAM(audio_i2s_32_duplex, false), 32, 4},
+        {PIO_PROGRAM(audio_i2s_32_duplex_swapped, true), 32, 4},
+    };
+    for (const Case& c : cases) {
+        const Capture capture = run(c.program, words);
+        REQUIRE(capture.edges.size() == bits.size());
+        bool match = true;
+        for (size_t n = 0; n < bits.size(); ++n) {
+            match = match && capture.edges[n].data == bits[n] && capture.edges[n].frame == referenceLrclk(n, c.slotBits);
+        }
+        CHECK(match);
+        checkBclk(capture, c.cyclesPerBit);
+        // Duplex programs sample the data pin on the rising edge: loopback returns the TX words.
+        if (c.cyclesPerBit == 4) {
+            CHECK(capture.received == words);
+        } else {
+            CHECK(capture.received.empty());
+        }
+    }
+}
+
+TEST_CASE("TDM programs send back-to-back 32-bit slots after a one-bit frame sync") {
+    const std::vector<uint32_t> words = testWords(8 * 3);
+    const std::vector<bool> bits = referenceData(words);
+    for (uint32_t slots : {4u, 8u}) {
+        for (const Program& program : {PIO_PROGRAM(audio_tdm, false), PIO_PROGRAM(audio_tdm_swapped, true)}) {
+            // audio_tdm_program_init loads Y with the frame length minus 2.
+            const Capture capture = run(program, words, slots * 32u - 2u);
+            REQUIRE(capture.edges.size() == bits.size());
+            bool match = true;
+            size_t pulses = 0;
+            for (size_t n = 0; n < bits.size(); ++n) {
+                match = match && capture.edges[n].data == bits[n] && capture.edges[n].frame == referenceFsync(n, slots * 32u);
+                pulses += capture.edges[n].frame ? 1 : 0;
+            }
+            CHECK(match);
+            // One ahead of every frame, including the frame the next pull would start.
+            CHECK(pulses == words.size() / slots + 1);
+            checkBclk(capture, 2);
+        }
+    }
+}
+
+TEST_CASE("TDM8 bitstream carries the interleaved channels in slot order") {
+    constexpr size_t kSlots = 8;
+    constexpr size_t kChannels = 6;
+    constexpr size_t kFrames = 5;
+    std::vector<std::vector<float>> planar(kChannels, std::vector<float>(kFrames));
+    std::vector<const float*> channels;
+    rpdsp::XorShift32 noise(77);
+    for (auto& channel : planar) {
+        for (float& sample : channel) {
+            sample = noise.nextBipolar();
+        }
+        channels.push_back(channel.data());
+    }
+    std::vector<int32_t> slots(kSlots * kFrames);
+    rpdsp::interleaveToTdm24x32(channels.data(), kChannels, slots.data(), kFrames, kSlots);
+    const std::vector<uint32_t> words(slots.begin(), slots.end());
+
+    const Capture capture = run(PIO_PROGRAM(audio_tdm, false), words, kSlots * 32u - 2u);
+    // Decode like a DAC: the edge after each FSYNC pulse is slot 0's MSB.
+    size_t frame = 0;
+    for (size_t n = 0; n + 1 < capture.edges.size(); ++n) {
+        if (!capture.edges[n].frame) {
+            continue;
+        }
+        REQUIRE(n + kSlots * 32 < capture.edges.size());
+        for (size_t slot = 0; slot < kSlots; ++slot) {
+            uint32_t word = 0;
+            for (size_t b = 0; b < 32; ++b) {
+                word = (word << 1) | (capture.edges[n + 1 + 32 * slot + b].data ? 1u : 0u);
+            }
+            const int32_t expected = slot < kChannels ? rpdsp::toInt24x32(planar[slot][frame]) : 0;
+            CHECK(static_cast<int32_t>(word) == expected);
+        }
+        ++frame;
+    }
+    CHECK(frame == kFrames);
+}
@@ -0,0 +1,180 @@
+#include <rpdsp/metering.h>
+#include <rpdsp/realtime.h>
+
+#include "doctest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+
+// Phase is kept in double so long renders do not pick up float phase error.
+void renderSine(std::vector<float>& out, double hz, float amplitude, double& phase) {
+    const double increment = 2.0 * 3.14159265358979323846 * hz / kSampleRate;
+    for (float& sample : out) {
+        sample = amplitude * static_cast<float>(std::sin(phase));
+        phase = std::fmod(phase + increment, 2.0 * 3.14159265358979323846);
+    }
+}
+
+void runLoudness(rpdsp::LoudnessMeter& meter, double seconds, float amplitude, double& phase) {
+    std::vector<float> block(rpdsp::kDefaultBlockSize);
+    const size_t blocks = static_cast<size_t>(seconds * kSampleRate) / block.size();
+    for (size_t b = 0; b < blocks; ++b) {
+        renderSine(block, 1000.0, amplitude, phase);
+        meter.process(block.data(), block.data(), block.size());
+    }
+}
+
+}  // namespace
+
+TEST_CASE("WindowedRmsMeter tracks a sliding window and forgets old signal") {
+    rpdsp::WindowedRmsMeter<> meter;
+    meter.prepare(kSampleRate, 0.1f);
+    CHECK(meter.windowSamples() == 4800);
+
+    std::vector<float> block(rpdsp::kDefaultBlockSize);
+    double phase = 0.0;
+    for (size_t i = 0; i < 20; ++i) {
+        renderSine(block, 1000.0, 0.5f, phase);
+        meter.process(block.data(), block.size());
+    }
+    // 640 samples into a 4800 sample window, the rest still counts as silence.
+    CHECK(meter.rms() == doctest::Approx(0.5f / std::sqrt(2.0f) * std::sqrt(640.0f / 4800.0f)).epsilon(0.01));
+
+    for (size_t i = 0; i < 300; ++i) {
+        renderSine(block, 1000.0, 0.5f, phase);
+        meter.process(block.data(), block.size());
+    }
+    CHECK(meter.rms() == doctest::Approx(0.5f / std::sqrt(2.0f)).epsilon(0.005));
+
+    std::fill(block.begin(), block.end(), 0.0f);
+    for (size_t i = 0; i < 150; ++i) {
+        meter.process(block.data(), block.size());
+    }
+    CHECK(meter.rms() == 0.0f);
+}
+
+TEST_CASE("WindowedRmsMeter resync removes running-sum drift") {
+    rpdsp::WindowedRmsMeter<> meter;
+    meter.prepare(kSampleRate, 0.3f);
+    rpdsp::XorShift32 noise(7);
+    // A minute of loud noise leaves rounding residue far above the quiet signal's energy.
+    for (size_t i = 0; i < 60 * 48000; ++i) {
+        meter.process(noise.nextBipolar());
+    }
+    for (size_t i = 0; i < 2 * meter.windowSamples(); ++i) {
+        meter.process(1.0e-3f);
+    }
+    CHECK(meter.rms() == doctest::Approx(1.0e-3f).epsilon(1.0e-3));
+    CHECK(meter.rmsDb() == doctest::Approx(-60.0f).epsilon(0.001));
+}
+
+TEST_CASE("TruePeakDetector finds the inter-sample peak of a quarter-rate sine") {
+    rpdsp::TruePeakDetector detector;
+    detector.reset();
+    float samplePeak = 0.0f;
+    for (size_t n = 0; n < 256; ++n) {
+        // fs/4 at 45 degrees: every sample lands at +-0.707 while the waveform reaches 1.0.
+        const float x = std::sin(static_cast<float>(n) * 0.5f * rpdsp::kPi + 0.25f * rpdsp::kPi);
+        samplePeak = std::max(samplePeak, std::fabs(x));
+        detector.process(x);
+    }
+    CHECK(rpdsp::gainToDb(samplePeak) == doctest::Approx(-3.01f).epsilon(0.01));
+    CHECK(detector.truePeakDb() > -0.3f);
+    CHECK(detector.truePeakDb() < 0.1f);
+
+    detector.resetPeak();
+    CHECK(detector.truePeak() == 0.0f);
+}
+
+TEST_CASE("K-weighting coefficients match BS.1770 at 48 kHz") {
+    const rpdsp::BiquadCoefficients shelf = rpdsp::LoudnessMeter::kWeightingShelf(48000.0f);
+    CHECK(shelf.b0 == doctest::Approx(1.53512486f).epsilon(1e-5));
+    CHECK(shelf.b1 == doctest::Approx(-2.69169619f).epsilon(1e-5));
+    CHECK(shelf.b2 == doctest::Approx(1.19839281f).epsilon(1e-5));
+    CHECK(shelf.a1 == doctest::Approx(-1.69065929f).epsilon(1e-5));
+    CHECK(shelf.a2 == doctest::Approx(0.73248077f).epsilon(1e-5));
+
+    const rpdsp::BiquadCoefficients highPass = rpdsp::LoudnessMeter::kWeightingHighPass(48000.0f);
+    CHECK(highPass.a1 == doctest::Approx(-1.99004745f).epsilon(1e-5));
+    CHECK(highPass.a2 == doctest::Approx(0.99007225f).epsilon(1e-5));
+}
+
+TEST_CASE("LoudnessMeter reads a -20 dBFS stereo 1 kHz sine as -20 LUFS") {
+    rpdsp::LoudnessMeter meter;
+    meter.prepare(kSampleRate);
+    CHECK(meter.momentaryLufs() == rpdsp::LoudnessMeter::kSilenceLufs);
+
+    double phase = 0.0;
+    runLoudness(meter, 4.0, 0.1f, phase);
+    CHECK(meter.momentaryLufs() == doctest::Approx(-20.0f).epsilon(0.005));
+    CHECK(meter.shortTermLufs() == doctest::Approx(-20.0f).epsilon(0.005));
+    CHECK(meter.integratedLufs() == doctest::Approx(-20.0f).epsilon(0.005));
+}
+
+TEST_CASE("LoudnessMeter integrated loudness applies both gates") {
+    rpdsp::LoudnessMeter meter;
+    meter.prepare(kSampleRate);
+    double phase = 0.0;
+
+    // Silence never passes the -70 LUFS absolute gate.
+    runLoudness(meter, 5.0, 0.0f, phase);
+    CHECK(meter.integratedLufs() == rpdsp::LoudnessMeter::kSilenceLufs);
+    runLoudness(meter, 5.0, 0.1f, phase);
+    CHECK(meter.integratedLufs() == doctest::Approx(-20.0f).epsilon(0.005));
+
+    // -40 LUFS sits more than 10 LU under the ungated mean, so the relative gate drops it.
+    runLoudness(meter, 5.0, 0.01f, phase);
+    CHECK(meter.momentaryLufs() == doctest::Approx(-40.0f).epsilon(0.005));
+    CHECK(meter.integratedLufs() == doctest::Approx(-20.0f).epsilon(0.01));
+
+    meter.resetIntegrated();
+    runLoudness(meter, 2.0, 0.01f, phase);
+    CHECK(meter.integratedLufs() == doctest::Approx(-40.0f).epsilon(0.005));
+}
+
+TEST_CASE("StereoMeter publishes whole readings to another thread") {
+    rpdsp::StereoMeter<> meter;
+    meter.prepare(kSampleRate, 0.3f, 0.01f);
+    const std::uint32_t initialVersion = meter.readings().version();
+
+    std::atomic<bool> running{true};
+    std::thread audio([&] {
+        std::vector<float> left(rpdsp::kDefaultBlockSize);
+        std::vector<float> right(rpdsp::kDefaultBlockSize);
+        double phase = 0.0;
+        for (size_t b = 0; b < 3 * 48000 / rpdsp::kDefaultBlockSize; ++b) {
+            // Both channels share a level that toggles every 50 blocks, so a torn read would disagree.
+            const float level = 0.05f + 0.05f * static_cast<float>((b / 50) % 2);
+            renderSine(left, 1000.0, level, phase);
+            right = left;
+            meter.process(left.data(), right.data(), left.size());
+        }
+        running.store(false);
+    });
+
+    size_t torn = 0;
+    size_t reads = 0;
+    while (running.load() || reads < 1000) {
+        const rpdsp::MeterReadings readings = meter.readings().load();
+        if (readings.rmsLeftDb != readings.rmsRightDb) {
+            ++torn;
+        }
+        ++reads;
+    }
+    audio.join();
+    CHECK(torn == 0);
+    CHECK(meter.readings().version() == initialVersion + 300);
+
+    const rpdsp::MeterReadings last = meter.readings().load();
+    CHECK(last.truePeakDb == doctest::Approx(-20.0f).epsilon(0.01));
+    CHECK(last.momentaryLufs < -20.0f);
+    CHECK(last.momentaryLufs > -27.0f);
+}
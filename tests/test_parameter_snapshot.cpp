@@ -0,0 +1,175 @@
+#include <rpdsp/realtime.h>
+#include <rpdsp/voice.h>
+
+#include "doctest.h"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+namespace {
+
+// Every word derived from one counter, so a value mixed from two publishes is easy to spot.
+struct Wide {
+  std::array<std::uint32_t, 15> words{};
+  float scaled = 0.0f;
+
+  static Wide make(std::uint32_t i) {
+    Wide value;
+    for (size_t w = 0; w < value.words.size(); ++w) {
+      value.words[w] = i * 2654435761u + static_cast<std::uint32_t>(w);
+    }
+    value.scaled = static_cast<float>(i & 0xffff);
+    return value;
+  }
+
+  [[nodiscard]] std::uint32_t counter() const { return static_cast<std::uint32_t>(words[0] * 244002641u); }
+
+  [[nodiscard]] bool consistent() const { return *this == make(counter()) || counter() == 0; }
+
+  bool operator==(const Wide& other) const { return words == other.words && scaled == other.scaled; }
+};
+
+rpdsp::VoicePatch patchFor(std::uint32_t i) {
+  const float f = static_cast<float>(i & 0xfff);
+  rpdsp::VoicePatch patch;
+  patch.filter = {100.0f + f, f / 8192.0f, f / 4096.0f};
+  patch.ampEnvelope = {f * 1.0e-5f, f * 2.0e-5f, f / 4096.0f, f * 3.0e-5f};
+  patch.noiseLevel = f / 4096.0f;
+  patch.gain = f / 2048.0f;
+  return patch;
+}
+
+bool samePatchFamily(const rpdsp::VoicePatch& patch) {
+  const float f = patch.filter.cutoffHz - 100.0f;
+  const rpdsp::VoicePatch expected = patchFor(static_cast<std::uint32_t>(f));
+  return patch.filter.resonance == expected.filter.resonance &&
+         patch.filter.velocityToCutoff == expected.filter.velocityToCutoff &&
+         patch.ampEnvelope.attackSeconds == expected.ampEnvelope.attackSeconds &&
+         patch.ampEnvelope.decaySeconds == expected.ampEnvelope.decaySeconds &&
+         patch.ampEnvelope.sustain == expected.ampEnvelope.sustain &&
+         patch.ampEnvelope.releaseSeconds == expected.ampEnvelope.releaseSeconds &&
+         patch.noiseLevel == expected.noiseLevel && patch.gain == expected.gain;
+}
+
+}  // namespace
+
+TEST_CASE("ParameterSnapshot hands over only the newest value and keeps the reader's stable") {
+    rpdsp::ParameterSnapshot<Wide> snapshot(Wide::make(1));
+    CHECK(snapshot.current() == Wide::make(1));
+    CHECK_FALSE(snapshot.update());
+
+    snapshot.publish(Wide::make(2));
+    snapshot.publish(Wide::make(3));
+    CHECK(snapshot.current() == Wide::make(1));  // nothing changes until update()
+    CHECK(snapshot.update());
+    CHECK(snapshot.current() == Wide::make(3));
+    CHECK_FALSE(snapshot.update());
+
+    // Writes after update() never touch the slot the reader holds.
+    const Wide* held = &snapshot.current();
+    for (std::uint32_t i = 4; i < 10; ++i) {
+        snapshot.publish(Wide::make(i));
+    }
+    CHECK(*held == Wide::make(3));
+    CHECK(snapshot.update());
+    CHECK(snapshot.current() == Wide::make(9));
+}
+
+TEST_CASE("ParameterSnapshot readers never see a torn value or go back in time across threads") {
+    constexpr std::uint32_t kPublishes = 300000;
+    // The checks below only mean something if a value mixed from two publishes is caught.
+    Wide mixed = Wide::make(7);
+    mixed.words[9] = Wide::make(8).words[9];
+    REQUIRE_FALSE(mixed.consistent());
+    REQUIRE(Wide::make(kPublishes).counter() == kPublishes);
+
+    rpdsp::ParameterSnapshot<Wide> snapshot;
+    std::atomic<bool> running{true};
+    std::thread writer([&] {
+        for (std::uint32_t i = 1; i <= kPublishes; ++i) {
+            snapshot.publish(Wide::make(i));
+        }
+        running.store(false);
+    });
+
+    size_t torn = 0;
+    size_t backwards = 0;
+    size_t updates = 0;
+    std::uint32_t last = 0;
+    while (running.load() || updates < 1000) {
+        if (snapshot.update()) {
+            ++updates;
+        }
+        // One read of the whole struct per "block", as the audio core would.
+        const Wide value = snapshot.current();
+        if (!value.consistent()) {
+            ++torn;
+        }
+        if (value.counter() < last) {
+            ++backwards;
+        }
+        last = value.counter();
+        if (!running.load() && last == kPublishes) {
+            break;
+        }
+    }
+    writer.join();
+    snapshot.update();
+    CHECK(torn == 0);
+    CHECK(backwards == 0);
+    CHECK(updates > 0);
+    CHECK(snapshot.current().counter() == kPublishes);
+}
+
+TEST_CASE("VoicePatch crosses cores whole and applies to a voice") {
+    rpdsp::ParameterSnapshot<rpdsp::VoicePatch> snapshot(patchFor(0));
+    rpdsp::TriggeredSynthVoice<3> voice;
+    voice.prepare(48000.0f);
+    voice.applyPreset(rpdsp::classicThreeSawSubtractivePreset());
+    voice.noteOn(57, 0.8f);
+
+    std::atomic<bool> running{true};
+    std::thread control([&] {
+        for (std::uint32_t i = 1; i < 4096; ++i) {
+            snapshot.publish(patchFor(i));
+        }
+        running.store(false);
+    });
+
+    size_t mixed = 0;
+    float sum = 0.0f;
+    while (running.load()) {
+        if (snapshot.update()) {
+            if (!samePatchFamily(snapshot.current())) {
+                ++mixed;
+            }
+            voice.applyPatch(snapshot.current());
+        }
+        for (int i = 0; i < 32; ++i) {
+            sum += voice.process();
+        }
+    }
+    control.join();
+    CHECK(mixed == 0);
+    CHECK(std::isfinite(sum));
+
+    snapshot.update();
+    voice.applyPatch(snapshot.current());
+    const rpdsp::VoicePatch applied = voice.patch();
+    CHECK(applied.filter.cutoffHz == doctest::Approx(100.0f + 4095.0f));
+    CHECK(applied.filter.resonance == doctest::Approx(4095.0f / 8192.0f));
+    CHECK(applied.gain == doctest::Approx(4095.0f / 2048.0f));
+    CHECK(applied.ampEnvelope.sustain == doctest::Approx(4095.0f / 4096.0f));
+
+    rpdsp::VoicePatch wild = patchFor(1);
+    wild.filter.resonance = 5.0f;
+    wild.gain = -1.0f;
+    wild.ampEnvelope.sustain = 2.0f;
+    voice.applyPatch(wild);
+    CHECK(voice.patch().filter.resonance == 0.98f);
+    CHECK(voice.patch().gain == 0.0f);
+    CHECK(voice.patch().ampEnvelope.sustain == 1.0f);
+}
@@ -0,0 +1,193 @@
+#include <rpdsp/resampler.h>
+
+#include "doctest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+struct ToneFit {
+  double gainDb;
+  double residualDb;  // everything that is not the tone: aliases, images, interpolation spurs
+};
+
+// Least-squares fit of a sine and cosine at the expected output frequency, skipping the
+// start-up transient. The residual is relative to a full-scale sine.
+ToneFit fitTone(const std::vector<float>& output, double frequency, double sampleRate) {
+    const double w = 2.0 * 3.14159265358979323846 * frequency / sampleRate;
+    double ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0;
+    const size_t begin = 200;
+    const size_t end = output.size() - 200;
+    for (size_t i = begin; i < end; ++i) {
+        const double s = std::sin(w * static_cast<double>(i));
+        const double c = std::cos(w * static_cast<double>(i));
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        ys += output[i] * s;
+        yc += output[i] * c;
+    }
+    const double det = ss * cc - sc * sc;
+    const double a = (ys * cc - yc * sc) / det;
+    const double b = (yc * ss - ys * sc) / det;
+    double error = 0.0;
+    for (size_t i = begin; i < end; ++i) {
+        const double d = output[i] - a * std::sin(w * static_cast<double>(i)) - b * std::cos(w * static_cast<double>(i));
+        error += d * d;
+    }
+    return {20.0 * std::log10(std::sqrt(a * a + b * b)),
+            10.0 * std::log10(2.0 * error / static_cast<double>(end - begin) + 1.0e-30)};
+}
+
+template <typename Resampler>
+std::vector<float> resampleTone(Resampler& resampler, double frequency, size_t inputFrames) {
+    std::vector<float> input(inputFrames);
+    for (size_t i = 0; i < inputFrames; ++i) {
+        input[i] = static_cast<float>(
+            std::sin(2.0 * 3.14159265358979323846 * frequency * static_cast<double>(i) / resampler.inputSampleRate()));
+    }
+    std::vector<float> output(inputFrames * 2);
+    const float* in[] = {input.data()};
+    float* out[] = {output.data()};
+    size_t consumed = 0;
+    output.resize(resampler.process(in, inputFrames, out, output.size(), consumed));
+    CHECK(consumed == inputFrames);
+    return output;
+}
+
+}  // namespace
+
+TEST_CASE("PolyphaseResampler passes DC and fills blocks exactly from inputFramesFor") {
+    rpdsp::PolyphaseResampler<2> resampler;
+    resampler.prepare(32000.0f, 48000.0f);
+    std::vector<float> left(64, 0.5f);
+    std::vector<float> right(64, -0.25f);
+    std::vector<float> outLeft(32);
+    std::vector<float> outRight(32);
+    const float* in[] = {left.data(), right.data()};
+    float* out[] = {outLeft.data(), outRight.data()};
+
+    size_t totalIn = 0;
+    for (int block = 0; block < 300; ++block) {
+        const size_t needed = resampler.inputFramesFor(32);
+        REQUIRE(needed <= left.size());
+        size_t consumed = 0;
+        CHECK(resampler.process(in, needed, out, 32, consumed) == 32);
+        CHECK(consumed == needed);
+        totalIn += consumed;
+    }
+    CHECK(outLeft[31] == doctest::Approx(0.5f).epsilon(1e-5));
+    CHECK(outRight[0] == doctest::Approx(-0.25f).epsilon(1e-5));
+    // 300 blocks of 32 at 48 kHz take two thirds as many frames at 32 kHz.
+    CHECK(totalIn == 6400);
+    CHECK(resampler.ratio() == doctest::Approx(2.0f / 3.0f));
+}
+
+TEST_CASE("PolyphaseResampler converts 44.1 to 48 kHz cleanly") {
+    rpdsp::PolyphaseResampler<1> resampler;
+    resampler.prepare(44100.0f, 48000.0f);
+    const ToneFit low = fitTone(resampleTone(resampler, 1000.0, 20000), 1000.0, 48000.0);
+    CHECK(std::fabs(low.gainDb) < 0.01);
+    CHECK(low.residualDb < -80.0);
+
+    resampler.reset();
+    // Near the 0.34 fs passband edge.
+    const ToneFit high = fitTone(resampleTone(resampler, 14000.0, 20000), 14000.0, 48000.0);
+    CHECK(std::fabs(high.gainDb) < 0.1);
+    CHECK(high.residualDb < -65.0);
+}
+
+TEST_CASE("PolyphaseResampler rejects aliases and images below the lower Nyquist") {
+    SUBCASE("48 -> 44.1 kHz: a 23 kHz tone has no place to go") {
+        rpdsp::PolyphaseResampler<1> resampler;
+        resampler.prepare(48000.0f, 44100.0f);
+        const std::vector<float> output = resampleTone(resampler, 23000.0, 20000);
+        double power = 0.0;
+        for (size_t i = 200; i < output.size(); ++i) {
+            power += static_cast<double>(output[i]) * output[i];
+        }
+        CHECK(10.0 * std::log10(2.0 * power / static_cast<double>(output.size() - 200)) < -80.0);
+    }
+    SUBCASE("32 -> 48 kHz: the 22 kHz image of a 10 kHz tone is removed") {
+        rpdsp::PolyphaseResampler<1> resampler;
+        resampler.prepare(32000.0f, 48000.0f);
+        const ToneFit fit = fitTone(resampleTone(resampler, 10000.0, 20000), 10000.0, 48000.0);
+        CHECK(std::fabs(fit.gainDb) < 0.1);
+        CHECK(fit.residualDb < -65.0);
+    }
+    SUBCASE("96 -> 48 kHz with 64 taps stays flat to 16 kHz") {
+        rpdsp::PolyphaseResampler<1, 64> resampler;
+        resampler.prepare(96000.0f, 48000.0f);
+        const ToneFit fit = fitTone(resampleTone(resampler, 16000.0, 20000), 16000.0, 48000.0);
+        CHECK(std::fabs(fit.gainDb) < 0.1);
+        CHECK(fit.residualDb < -100.0);
+    }
+}
+
+TEST_CASE("PolyphaseResampler ratio correction is exact over a long stream and clamped") {
+    rpdsp::PolyphaseResampler<1, 8> resampler;
+    resampler.prepare(48000.0f, 48000.0f);
+    resampler.setRatioCorrection(0.5f);
+    CHECK(resampler.ratioCorrection() == rpdsp::kMaxResampleCorrection);
+    resampler.setRatioCorrection(250.0e-6f);
+
+    std::vector<float> input(1024, 0.0f);
+    std::vector<float> output(1024);
+    const float* in[] = {input.data()};
+    float* out[] = {output.data()};
+    size_t totalIn = 0;
+    size_t totalOut = 0;
+    for (int block = 0; block < 4000; ++block) {
+        size_t consumed = 0;
+        totalOut += resampler.process(in, 1000, out, output.size(), consumed);
+        totalIn += consumed;
+    }
+    const double measured = static_cast<double>(totalIn) / static_cast<double>(totalOut);
+    CHECK(measured == doctest::Approx(1.00025).epsilon(1e-6));
+}
+
+TEST_CASE("ResampleDriftController locks a FIFO between two clocks") {
+    constexpr float kRate = 48000.0f;
+    constexpr size_t kBlock = 32;
+    constexpr double kSourcePpm = 300.0;
+    constexpr float kTarget = 256.0f;
+
+    rpdsp::PolyphaseResampler<1, 8> resampler;
+    resampler.prepare(kRate, kRate);
+    rpdsp::ResampleDriftController controller;
+    controller.prepare(kRate, kRate / kBlock, kTarget, 1.0f);
+
+    std::vector<float> scratch(kBlock * 2, 0.0f);
+    std::vector<float> output(kBlock);
+    const float* in[] = {scratch.data()};
+    float* out[] = {output.data()};
+
+    // The source writes at its own clock; the sink reads what the resampler asks for.
+    double sourceFrames = 0.0;
+    double fill = kTarget;
+    double minFill = fill;
+    double worstLate = 0.0;
+    const int blocks = static_cast<int>(40.0f * kRate / kBlock);
+    for (int block = 0; block < blocks; ++block) {
+        sourceFrames += kBlock * (1.0 + kSourcePpm * 1.0e-6);
+        const double written = std::floor(sourceFrames);
+        sourceFrames -= written;
+        fill += written;
+
+        resampler.setRatioCorrection(controller.update(static_cast<float>(fill)));
+        const size_t needed = resampler.inputFramesFor(kBlock);
+        size_t consumed = 0;
+        resampler.process(in, needed, out, kBlock, consumed);
+        fill -= static_cast<double>(consumed);
+        minFill = std::min(minFill, fill);
+        if (block > blocks / 2) {
+            worstLate = std::max(worstLate, std::fabs(fill - kTarget));
+        }
+    }
+    CHECK(minFill > 0.0);
+    CHECK(controller.drift() == doctest::Approx(kSourcePpm * 1.0e-6).epsilon(0.05));
+    // Settled: within a couple of blocks of the target, no slow wander.
+    CHECK(worstLate < 2.0 * kBlock);
+}
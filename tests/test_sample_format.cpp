@@ -0,0 +1,154 @@
+#include <rpdsp/algorithm.h>
+#include <rpdsp/realtime.h>
+#include <rpdsp/sample_format.h>
+
+#include "doctest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Odd length so the SIMD body and the scalar tail both run; values reach past full scale.
+std::vector<float> testSignal(std::uint32_t seed, size_t frames) {
+    rpdsp::XorShift32 noise(seed);
+    std::vector<float> samples(frames);
+    for (float& sample : samples) {
+        sample = 1.5f * noise.nextBipolar();
+    }
+    samples[3] = 1.0f;
+    samples[4] = -1.0f;
+    samples[5] = 0.0f;
+    return samples;
+}
+
+double noisePower(const std::vector<int16_t>& interleaved, size_t window) {
+    // Power after a moving sum over `window` left samples: a crude low-pass.
+    double power = 0.0;
+    const size_t frames = interleaved.size() / 2;
+    for (size_t n = window; n < frames; ++n) {
+        double sum = 0.0;
+        for (size_t k = 0; k < window; ++k) {
+            sum += interleaved[2 * (n - k)];
+        }
+        power += sum * sum;
+    }
+    return power / static_cast<double>(frames - window);
+}
+
+}  // namespace
+
+TEST_CASE("toInt16 rounds to nearest and clamps") {
+    CHECK(rpdsp::toInt16(0.0f) == 0);
+    CHECK(rpdsp::toInt16(1.0f) == 32767);
+    CHECK(rpdsp::toInt16(-1.0f) == -32767);
+    CHECK(rpdsp::toInt16(4.0f) == 32767);
+    CHECK(rpdsp::toInt16(-4.0f) == -32767);
+    CHECK(rpdsp::toInt16(0.6f / 32767.0f) == 1);
+    CHECK(rpdsp::toInt16(-0.6f / 32767.0f) == -1);
+    CHECK(rpdsp::toInt16(0.4f / 32767.0f) == 0);
+    CHECK(rpdsp::toInt16(-0.4f / 32767.0f) == 0);
+}
+
+TEST_CASE("interleave kernels match the scalar per-sample loop") {
+    const std::vector<float> left = testSignal(1, 67);
+    const std::vector<float> right = testSignal(2, 67);
+
+    std::vector<int32_t> words(2 * left.size());
+    rpdsp::interleaveToInt24x32(left.data(), right.data(), words.data(), left.size());
+    std::vector<int16_t> samples(2 * left.size());
+    rpdsp::interleaveToInt16(left.data(), right.data(), samples.data(), left.size());
+
+    for (size_t i = 0; i < left.size(); ++i) {
+        CHECK(words[2 * i] == rpdsp::toInt24x32(left[i]));
+        CHECK(words[2 * i + 1] == rpdsp::toInt24x32(right[i]));
+        CHECK(samples[2 * i] == rpdsp::toInt16(left[i]));
+        CHECK(samples[2 * i + 1] == rpdsp::toInt16(right[i]));
+    }
+}
+
+TEST_CASE("TDM interleaver places each channel in its slot and silences the rest") {
+    const std::vector<float> a = testSignal(5, 19);
+    const std::vector<float> b = testSignal(6, 19);
+    const std::vector<float> c = testSignal(7, 19);
+    const float* channels[] = {a.data(), b.data(), c.data()};
+
+    std::vector<int32_t> slots(4 * a.size(), 12345);
+    rpdsp::interleaveToTdm24x32(channels, 3, slots.data(), a.size(), 4);
+    for (size_t i = 0; i < a.size(); ++i) {
+        CHECK(slots[4 * i] == rpdsp::toInt24x32(a[i]));
+        CHECK(slots[4 * i + 1] == rpdsp::toInt24x32(b[i]));
+        CHECK(slots[4 * i + 2] == rpdsp::toInt24x32(c[i]));
+        CHECK(slots[4 * i + 3] == 0);
+    }
+
+    // More channels than slots: the extras are dropped, not written past the frame.
+    std::vector<int32_t> pair(2 * a.size() + 1, 7);
+    rpdsp::interleaveToTdm24x32(channels, 3, pair.data(), a.size(), 2);
+    std::vector<int32_t> stereo(2 * a.size());
+    rpdsp::interleaveToInt24x32(a.data(), b.data(), stereo.data(), a.size());
+    CHECK(std::vector<int32_t>(pair.begin(), pair.end() - 1) == stereo);
+    CHECK(pair.back() == 7);
+}
+
+TEST_CASE("Int16OutputStage without dither is the plain kernel") {
+    const std::vector<float> left = testSignal(3, 33);
+    const std::vector<float> right = testSignal(4, 33);
+    rpdsp::Int16OutputStage stage;
+    stage.setDither(false);
+    std::vector<int16_t> staged(2 * left.size());
+    std::vector<int16_t> plain(2 * left.size());
+    stage.process(left.data(), right.data(), staged.data(), left.size());
+    rpdsp::interleaveToInt16(left.data(), right.data(), plain.data(), left.size());
+    CHECK(staged == plain);
+}
+
+TEST_CASE("TPDF dither keeps a sub-LSB tone instead of truncating it away") {
+    constexpr size_t kFrames = 48000;
+    std::vector<float> tone(kFrames);
+    for (size_t n = 0; n < kFrames; ++n) {
+        // 0.4 LSB peak: rounding alone outputs nothing but zeros.
+        tone[n] = 0.4f / 32767.0f * std::sin(2.0f * rpdsp::kPi * 441.0f * static_cast<float>(n) / 48000.0f);
+    }
+    std::vector<int16_t> plain(2 * kFrames);
+    rpdsp::interleaveToInt16(tone.data(), tone.data(), plain.data(), kFrames);
+    bool allZero = true;
+    for (int16_t sample : plain) {
+        allZero = allZero && sample == 0;
+    }
+    CHECK(allZero);
+
+    rpdsp::Int16OutputStage stage;
+    std::vector<int16_t> dithered(2 * kFrames);
+    stage.process(tone.data(), tone.data(), dithered.data(), kFrames);
+    double correlation = 0.0;
+    double toneEnergy = 0.0;
+    double mean = 0.0;
+    for (size_t n = 0; n < kFrames; ++n) {
+        const double reference = tone[n] * 32767.0;
+        correlation += dithered[2 * n] * reference;
+        toneEnergy += reference * reference;
+        mean += dithered[2 * n + 1];
+    }
+    // Dither is unbiased: the tone survives at its own level and the output has no DC.
+    CHECK(correlation / toneEnergy == doctest::Approx(1.0).epsilon(0.1));
+    CHECK(std::fabs(mean / kFrames) < 0.02);
+}
+
+TEST_CASE("Noise shaping moves dither noise out of the low band") {
+    constexpr size_t kFrames = 48000;
+    const std::vector<float> silence(kFrames, 0.0f);
+    std::vector<int16_t> flat(2 * kFrames);
+    std::vector<int16_t> shaped(2 * kFrames);
+
+    rpdsp::Int16OutputStage flatStage(9);
+    flatStage.process(silence.data(), silence.data(), flat.data(), kFrames);
+    rpdsp::Int16OutputStage shapedStage(9);
+    shapedStage.setNoiseShaping(true);
+    CHECK(shapedStage.noiseShaping());
+    shapedStage.process(silence.data(), silence.data(), shaped.data(), kFrames);
+
+    // An 8-sample moving sum passes roughly the bottom 3 kHz.
+    CHECK(noisePower(shaped, 8) < 0.5 * noisePower(flat, 8));
+}
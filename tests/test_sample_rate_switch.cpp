@@ -0,0 +1,164 @@
+#include <rpdsp/sample_rate_switch.h>
+
+#include "doctest.h"
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Action = rpdsp::SampleRateSwitch::Action;
+
+constexpr size_t kFrames = 32;
+
+// One audio-core block: a graph that writes constant 1.0 into both channels when allowed to run.
+struct Block {
+  std::array<float, kFrames> left{};
+  std::array<float, kFrames> right{};
+
+  Action run(rpdsp::SampleRateSwitch& sw) {
+    const Action action = sw.beginBlock();
+    if (action != Action::kSilence) {
+      left.fill(1.0f);
+      right.fill(1.0f);
+    } else {
+      left.fill(0.5f);  // stale data the switch must overwrite
+      right.fill(0.5f);
+    }
+    float* channels[] = {left.data(), right.data()};
+    sw.endBlock(channels, 2, kFrames);
+    return action;
+  }
+};
+
+}  // namespace
+
+TEST_CASE("SampleRateSwitch fades out, drains, waits for the graph and retunes once") {
+    rpdsp::SampleRateSwitch sw;
+    sw.prepare(48000.0f, 3);
+    Block block;
+
+    CHECK(block.run(sw) == Action::kRender);
+    CHECK(block.left[0] == 1.0f);
+    CHECK_FALSE(sw.switching());
+
+    REQUIRE(sw.request(96000.0f));
+    CHECK(sw.switching());
+    CHECK(sw.pendingSampleRate() == 96000.0f);
+
+    // Fade-out block: starts just below unity, ends at exactly zero.
+    CHECK(block.run(sw) == Action::kRender);
+    CHECK(block.left[0] == doctest::Approx(1.0f - 1.0f / kFrames));
+    CHECK(block.left[kFrames - 1] == 0.0f);
+    CHECK(block.right[kFrames / 2 - 1] == doctest::Approx(0.5f));
+    CHECK_FALSE(sw.graphReleased());
+
+    for (int i = 0; i < 3; ++i) {
+        CHECK_FALSE(sw.graphReleased());
+        CHECK(block.run(sw) == Action::kSilence);
+        CHECK(block.left[0] == 0.0f);
+        CHECK(block.right[kFrames - 1] == 0.0f);
+    }
+    CHECK(sw.graphReleased());
+
+    // The control core is slow to prepare: silence continues, no retune yet.
+    CHECK(block.run(sw) == Action::kSilence);
+    CHECK(sw.sampleRate() == 48000.0f);
+    CHECK_FALSE(sw.request(44100.0f));
+    CHECK(sw.pendingSampleRate() == 96000.0f);
+
+    sw.graphPrepared();
+    CHECK_FALSE(sw.graphReleased());
+    CHECK(block.run(sw) == Action::kRetune);
+    CHECK(sw.sampleRate() == 96000.0f);
+    CHECK(block.left[0] == 0.0f);
+    CHECK(block.left[kFrames - 1] == doctest::Approx(1.0f - 1.0f / kFrames));
+    CHECK_FALSE(sw.switching());
+
+    CHECK(block.run(sw) == Action::kRender);
+    CHECK(block.left[0] == 1.0f);
+    CHECK(block.right[kFrames - 1] == 1.0f);
+}
+
+TEST_CASE("SampleRateSwitch ignores graphPrepared outside the released phase and clamps rates") {
+    rpdsp::SampleRateSwitch sw;
+    sw.prepare(1.0f, 0);
+    CHECK(sw.sampleRate() == rpdsp::SampleRateSwitch::kMinSampleRate);
+
+    sw.graphPrepared();
+    Block block;
+    CHECK(block.run(sw) == Action::kRender);
+
+    REQUIRE(sw.request(1.0e6f));
+    CHECK(sw.pendingSampleRate() == rpdsp::SampleRateSwitch::kMaxSampleRate);
+    sw.graphPrepared();  // too early: the graph is still running
+    CHECK(block.run(sw) == Action::kRender);
+    // Zero drain blocks still writes one silent block before releasing.
+    CHECK(block.run(sw) == Action::kSilence);
+    CHECK(sw.graphReleased());
+
+    sw.reset();
+    CHECK_FALSE(sw.switching());
+    CHECK(block.run(sw) == Action::kRender);
+    CHECK(block.left[0] == 1.0f);
+}
+
+TEST_CASE("SampleRateSwitch never lets both cores own the graph") {
+    rpdsp::SampleRateSwitch sw;
+    sw.prepare(48000.0f, 2);
+    std::atomic<int> owners{0};
+    std::atomic<bool> overlap{false};
+    std::atomic<bool> done{false};
+    float graphRate = 48000.0f;  // written by the control side only while it owns the graph
+
+    std::vector<float> retunes;
+    std::thread audio([&] {
+        Block block;
+        while (!done.load()) {
+            const Action action = sw.beginBlock();
+            if (action != Action::kSilence) {
+                if (owners.fetch_add(1) != 0) {
+                    overlap.store(true);
+                }
+                if (graphRate != sw.sampleRate()) {
+                    overlap.store(true);
+                }
+                owners.fetch_sub(1);
+            }
+            if (action == Action::kRetune) {
+                retunes.push_back(sw.sampleRate());
+            }
+            float* channels[] = {block.left.data(), block.right.data()};
+            sw.endBlock(channels, 2, kFrames);
+        }
+    });
+
+    const float rates[] = {44100.0f, 96000.0f, 32000.0f, 48000.0f};
+    for (int round = 0; round < 200; ++round) {
+        const float rate = rates[round % 4];
+        while (!sw.request(rate)) {
+            std::this_thread::yield();
+        }
+        while (!sw.graphReleased()) {
+            std::this_thread::yield();
+        }
+        if (owners.fetch_add(1) != 0) {
+            overlap.store(true);
+        }
+        graphRate = rate;
+        owners.fetch_sub(1);
+        sw.graphPrepared();
+    }
+    while (sw.switching()) {
+        std::this_thread::yield();
+    }
+    done.store(true);
+    audio.join();
+
+    CHECK_FALSE(overlap.load());
+    REQUIRE(retunes.size() == 200);
+    CHECK(retunes.back() == 48000.0f);
+    CHECK(retunes[1] == 96000.0f);
+}
@@ -0,0 +1,176 @@
+#include <rpdsp/spectrum.h>
+
+#include "doctest.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Windows overlap-add and report coherent gain") {
+    constexpr size_t kN = 256;
+    using Hann = rpdsp::Window<kN, rpdsp::WindowShape::Hann>;
+    for (size_t i = 0; i < kN / 2; ++i) {
+        CHECK(Hann::kTable[i] + Hann::kTable[i + kN / 2] == doctest::Approx(1.0f).epsilon(1e-5));
+    }
+    CHECK(Hann::kCoherentGain == doctest::Approx(0.5f).epsilon(1e-4));
+    CHECK(rpdsp::Window<kN, rpdsp::WindowShape::Blackman>::kCoherentGain ==
+          doctest::Approx(0.42f).epsilon(1e-3));
+    CHECK(rpdsp::Window<kN, rpdsp::WindowShape::Rectangular>::kTable[17] == 1.0f);
+}
+
+TEST_CASE("powerSpectrum peaks at a windowed sinusoid's bin") {
+    constexpr size_t kN = 512;
+    float frame[kN];
+    for (size_t i = 0; i < kN; ++i) {
+        frame[i] = 0.5f * std::sin(rpdsp::kTwoPi * 20.0f * static_cast<float>(i) / kN);
+    }
+    rpdsp::Window<kN>::apply(frame);
+    rpdsp::RealFft<kN>::forward(frame);
+    float power[kN / 2 + 1];
+    rpdsp::powerSpectrum<kN>(frame, power);
+
+    size_t peak = 0;
+    for (size_t k = 1; k <= kN / 2; ++k) {
+        if (power[k] > power[peak]) {
+            peak = k;
+        }
+    }
+    CHECK(peak == 20);
+    const float amplitude = std::sqrt(power[peak]) * 2.0f / (kN * rpdsp::Window<kN>::kCoherentGain);
+    CHECK(amplitude == doctest::Approx(0.5f).epsilon(1e-3));
+}
+
+TEST_CASE("StftFrameBuilder emits one frame per hop from streamed blocks") {
+    constexpr size_t kN = 256;
+    rpdsp::StftFrameBuilder<kN> builder;
+    builder.reset();
+    float frame[kN];
+    float block[rpdsp::kDefaultBlockSize];
+
+    CHECK_FALSE(builder.nextFrame(frame));
+    size_t frames = 0;
+    size_t pushed = 0;
+    for (int b = 0; b < 64; ++b) {
+        for (size_t i = 0; i < rpdsp::kDefaultBlockSize; ++i, ++pushed) {
+            block[i] = std::sin(rpdsp::kTwoPi * 8.0f * static_cast<float>(pushed) / kN);
+        }
+        builder.push(block, rpdsp::kDefaultBlockSize);
+        while (builder.nextFrame(frame)) {
+            ++frames;
+            float power[kN / 2 + 1];
+            rpdsp::powerSpectrum<kN>(frame, power);
+            CHECK(power[8] > 100.0f * power[20]);
+        }
+    }
+    CHECK(frames == (pushed - kN) / (kN / 2) + 1);
+    CHECK(builder.droppedFrames() == 0);
+}
+
+TEST_CASE("StftFrameBuilder drops frames instead of returning stale ones when the reader lags") {
+    constexpr size_t kN = 64;
+    rpdsp::StftFrameBuilder<kN, 32, rpdsp::WindowShape::Rectangular, 256> builder;
+    builder.reset();
+    std::vector<float> ramp(1024);
+    for (size_t i = 0; i < ramp.size(); ++i) {
+        ramp[i] = static_cast<float>(i);
+    }
+    builder.push(ramp.data(), ramp.size());
+    float frame[kN];
+    REQUIRE(builder.nextFrame(frame));
+    CHECK(builder.droppedFrames() > 0);
+    // The DC bin is the sum of the frame, which must be a recent, contiguous span.
+    const float first = frame[0] / kN - (kN - 1) / 2.0f;
+    CHECK(first >= static_cast<float>(1024 - 256));
+}
+
+TEST_CASE("StftFrameBuilder frames stay contiguous across threads") {
+    constexpr size_t kN = 128;
+    rpdsp::StftFrameBuilder<kN, 64, rpdsp::WindowShape::Rectangular> builder;
+    builder.reset();
+    constexpr size_t kTotal = 1 << 16;
+
+    std::thread audio([&builder] {
+        float block[rpdsp::kDefaultBlockSize];
+        for (size_t n = 0; n < kTotal; n += rpdsp::kDefaultBlockSize) {
+            for (size_t i = 0; i < rpdsp::kDefaultBlockSize; ++i) {
+                // Small integers stay exact through the DC sum.
+                block[i] = static_cast<float>((n + i) & 0xff);
+            }
+            builder.push(block, rpdsp::kDefaultBlockSize);
+            std::this_thread::yield();
+        }
+    });
+
+    size_t frames = 0;
+    bool allValid = true;
+    float frame[kN];
+    while (frames + builder.droppedFrames() < (kTotal - kN) / 64 + 1) {
+        if (!builder.nextFrame(frame)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ++frames;
+        // A contiguous span of the 0..255 ramp has a DC sum of kN * start + kN(kN-1)/2 modulo
+        // wrap; every valid span is one of 256 known sums.
+        bool matched = false;
+        for (size_t start = 0; start < 256 && !matched; ++start) {
+            float sum = 0.0f;
+            for (size_t i = 0; i < kN; ++i) {
+                sum += static_cast<float>((start + i) & 0xff);
+            }
+            matched = std::fabs(sum - frame[0]) < 0.5f;
+        }
+        allValid = allValid && matched;
+    }
+    audio.join();
+    CHECK(allValid);
+    CHECK(frames > 0);
+}
+
+TEST_CASE("StftFrameBuilder never returns a torn frame to a racing reader") {
+    constexpr size_t kN = 128;
+    constexpr size_t kHop = 32;
+    // The smallest ring the builder accepts, so the writer laps the reader's copy often.
+    rpdsp::StftFrameBuilder<kN, kHop, rpdsp::WindowShape::Rectangular, 256> builder;
+    builder.reset();
+    std::atomic<bool> stop{false};
+
+    std::thread audio([&builder, &stop] {
+        float block[rpdsp::kDefaultBlockSize];
+        for (uint32_t n = 0; !stop.load(std::memory_order_relaxed); n += rpdsp::kDefaultBlockSize) {
+            for (size_t i = 0; i < rpdsp::kDefaultBlockSize; ++i) {
+                // Each sample carries its own index (mod 4096, exact through the FFT round trip).
+                block[i] = static_cast<float>((n + i) & 0xfff);
+            }
+            builder.push(block, rpdsp::kDefaultBlockSize);
+            if ((n & 0xff) == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    size_t frames = 0;
+    size_t tornFrames = 0;
+    float frame[kN];
+    while (frames < 2000) {
+        if (!builder.nextFrame(frame)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ++frames;
+        rpdsp::RealFft<kN>::inverse(frame);
+        const uint32_t start = builder.lastFrameEnd() - kN;
+        bool torn = false;
+        for (size_t i = 0; i < kN; ++i) {
+            torn = torn || std::lround(frame[i]) != static_cast<long>((start + i) & 0xfff);
+        }
+        tornFrames += torn ? 1 : 0;
+    }
+    stop.store(true);
+    audio.join();
+    // The writer never waits, so most hops are dropped; every frame that does come back must
+    // be exactly the span lastFrameEnd() names.
+    CHECK(tornFrames == 0);
+}